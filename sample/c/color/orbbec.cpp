@@ -202,7 +202,7 @@ inline void orbbec::draw_color()
     }
 
     // Get cv::Mat from ob_frame
-    color = ob_get_mat( color_frame );
+    ob_get_mat( color_frame, color );
 }
 
 // Show
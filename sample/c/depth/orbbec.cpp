@@ -204,8 +204,8 @@ inline void orbbec::draw_depth()
         return;
     }
 
-    // Get cv::Mat from ob_frame
-    depth = ob_get_mat( depth_frame );
+    // Get cv::Mat from ob_frame (Y16 is view of frame without copy)
+    depth = ob_get_mat( depth_frame, false );
 }
 
 // Show
@@ -223,12 +223,15 @@ inline void orbbec::show_depth()
     }
 
     // Scaling Depth
-    const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
-    depth.convertTo( depth, CV_8U, -255.0 / max_range, 255.0 );
+    if( depth_lut.empty() ){
+        const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
+        depth_lut = ob_create_depth_lut( max_range );
+    }
+    ob_visualize_depth( depth, depth_lut, depth_scaled );
 
     // Show Image
     const cv::String window_name = cv::format( "depth (orbbec %d)", device_index );
-    cv::imshow( window_name, depth );
+    cv::imshow( window_name, depth_scaled );
 }
 
 // Get Depth Range
@@ -0,0 +1,206 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+
+#include "triple_buffer.h"
+
+// Frame Handoff between Producer (delivery thread of SDK) and Consumer (render loop)
+// Producer publishes frame at fixed rate, and consumer converts latest frame (e.g. ob_get_mat) while producer keeps publishing.
+
+// Benchmark Result
+struct bench_result
+{
+    std::string name;
+    uint64_t published;
+    uint64_t consumed;
+    double publish_ns_average;
+    double publish_ns_max;
+    double publish_ns_p99;
+};
+
+// Mutex Handoff (same as swap of frame under frame_mutex, and conversion under same mutex)
+class mutex_handoff
+{
+private:
+    std::mutex frame_mutex;
+    uint64_t frame = 0;
+
+public:
+    void publish( const uint64_t value )
+    {
+        std::lock_guard<std::mutex> lock( frame_mutex );
+        frame = value;
+    }
+
+    template<typename Function>
+    bool consume( uint64_t& last, Function convert )
+    {
+        std::lock_guard<std::mutex> lock( frame_mutex );
+        if( frame == last ){
+            return false;
+        }
+        last = frame;
+        convert( frame );
+        return true;
+    }
+};
+
+// Triple Buffer Handoff (conversion reads consumer's buffer without lock)
+class triple_buffer_handoff
+{
+private:
+    triple_buffer<uint64_t> buffer;
+
+public:
+    void publish( const uint64_t value )
+    {
+        buffer.write_buffer() = value;
+        buffer.publish();
+    }
+
+    template<typename Function>
+    bool consume( uint64_t& last, Function convert )
+    {
+        if( !buffer.update() ){
+            return false;
+        }
+        last = buffer.read_buffer();
+        convert( buffer.read_buffer() );
+        return true;
+    }
+};
+
+// Busy Wait (simulate conversion, sleep is too coarse)
+void spin_for( const std::chrono::steady_clock::duration duration )
+{
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+    while( std::chrono::steady_clock::now() < end ){
+    }
+}
+
+// Run Benchmark
+template<typename Handoff>
+bench_result run( const std::string& name )
+{
+    constexpr std::chrono::microseconds publish_interval = std::chrono::microseconds( 100 ); // 10000 frames/sec (stress)
+    constexpr std::chrono::microseconds convert_time = std::chrono::microseconds( 2000 ); // conversion of frame on render loop
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 1000 );
+
+    Handoff handoff;
+    std::atomic<bool> is_running = true;
+    std::vector<uint64_t> latencies;
+    latencies.reserve( duration / publish_interval + 1 );
+
+    // Producer
+    std::thread producer = std::thread( [&](){
+        uint64_t value = 0;
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        while( is_running ){
+            while( std::chrono::steady_clock::now() < next ){
+            }
+            next += publish_interval;
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            handoff.publish( ++value );
+            latencies.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() );
+        }
+    } );
+
+    // Consumer
+    uint64_t consumed = 0;
+    uint64_t last = 0;
+    uint64_t previous = 0;
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+    while( std::chrono::steady_clock::now() < end ){
+        const bool is_consumed = handoff.consume( last, [&]( const uint64_t& frame ){
+            spin_for( convert_time );
+            if( frame != last ){
+                throw std::runtime_error( "[error] frame was modified during conversion!" );
+            }
+        } );
+        if( is_consumed ){
+            if( last <= previous ){
+                throw std::runtime_error( "[error] frame is not latest one!" );
+            }
+            previous = last;
+            consumed++;
+        }
+    }
+
+    is_running = false;
+    producer.join();
+
+    // Statistics of Publish Latency
+    bench_result result;
+    result.name = name;
+    result.published = latencies.size();
+    result.consumed = consumed;
+    uint64_t total = 0;
+    for( const uint64_t latency : latencies ){
+        total += latency;
+    }
+    result.publish_ns_average = !latencies.empty() ? static_cast<double>( total ) / latencies.size() : 0.0;
+    std::sort( latencies.begin(), latencies.end() );
+    result.publish_ns_max = !latencies.empty() ? static_cast<double>( latencies.back() ) : 0.0;
+    result.publish_ns_p99 = !latencies.empty() ? static_cast<double>( latencies[latencies.size() * 99 / 100] ) : 0.0;
+    return result;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"published\": " << result.published << ", ";
+        stream << "\"consumed\": " << result.consumed << ", ";
+        stream << "\"publish_ns_average\": " << result.publish_ns_average << ", ";
+        stream << "\"publish_ns_p99\": " << result.publish_ns_p99 << ", ";
+        stream << "\"publish_ns_max\": " << result.publish_ns_max;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        std::vector<bench_result> results;
+        results.push_back( run<mutex_handoff>( "mutex" ) );
+        results.push_back( run<triple_buffer_handoff>( "triple_buffer" ) );
+
+        for( const bench_result& result : results ){
+            std::cerr << result.name << " : published " << result.published << ", consumed " << result.consumed << ", publish " << result.publish_ns_average << " ns (p99 " << result.publish_ns_p99 << " ns, max " << result.publish_ns_max << " ns)" << std::endl;
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
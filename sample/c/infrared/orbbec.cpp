@@ -201,8 +201,8 @@ inline void orbbec::draw_infrared()
         return;
     }
 
-    // Get cv::Mat from ob_frame
-    infrared = ob_get_mat( infrared_frame );
+    // Get cv::Mat from ob_frame (Y16/Y8 is view of frame without copy)
+    infrared = ob_get_mat( infrared_frame, false );
 }
 
 // Show
@@ -220,9 +220,9 @@ inline void orbbec::show_infrared()
     }
 
     // Scaling Infrared
-    infrared.convertTo( infrared, CV_8U, 0.5 );
+    infrared.convertTo( infrared_scaled, CV_8U, 0.5 );
 
     // Show Image
     const cv::String window_name = cv::format( "infrared (orbbec %d)", device_index );
-    cv::imshow( window_name, infrared );
+    cv::imshow( window_name, infrared_scaled );
 }
@@ -22,6 +22,7 @@ private:
     ob_stream_profile* infrared_stream_profile = nullptr;
     ob_frame* infrared_frame = nullptr;
     cv::Mat infrared;
+    cv::Mat infrared_scaled;
 
 public:
     // Constructor
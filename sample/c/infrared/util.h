@@ -2,6 +2,10 @@
  This is utility to that provides converter to convert ob_frame to cv::Mat.
 
  cv::Mat mat = ob_get_mat( video_frame );
+ cv::Mat view = ob_get_mat( video_frame, false ); // no copy (view keeps frame alive)
+ ob_get_mat( video_frame, mat ); // reuse mat
+ ob_decode_mjpg( mjpg_frame, mat, 4 ); // 1/4 resolution
+ ob_visualize_depth( depth, ob_create_depth_lut( max_range ), visualize );
 
  Copyright (c) 2023 Tsukasa Sugiura <t.sugiura0204@gmail.com>
  Licensed under the MIT license.
@@ -29,25 +33,208 @@
 #define __UTIL__
 
 #include <vector>
+#include <iostream>
 #include <limits>
 
 #include <libobsensor/ObSensor.h>
 #include <opencv2/opencv.hpp>
 
-cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
+#include "color_kernel.h"
+#include "check_error.h"
+
+// Get cv::Mat type of the format that can be wrapped without conversion (-1 if conversion is required)
+int32_t ob_get_mat_type( const OBFrameType frame_type, const OBFormat format )
+{
+    switch( frame_type )
+    {
+        case OBFrameType::OB_FRAME_COLOR:
+        {
+            switch( format )
+            {
+                case OBFormat::OB_FORMAT_GRAY:
+                    return CV_8UC1;
+                case OBFormat::OB_FORMAT_BGR:
+                    return CV_8UC3;
+                default:
+                    return -1;
+            }
+        }
+        case OBFrameType::OB_FRAME_DEPTH:
+        {
+            switch( format )
+            {
+                case OBFormat::OB_FORMAT_Y16:
+                case OBFormat::OB_FORMAT_Y10:
+                case OBFormat::OB_FORMAT_Y11:
+                case OBFormat::OB_FORMAT_Y12:
+                case OBFormat::OB_FORMAT_Y14:
+                    return CV_16UC1;
+                case OBFormat::OB_FORMAT_Y8:
+                    return CV_8UC1;
+                default:
+                    return -1;
+            }
+        }
+        case OBFrameType::OB_FRAME_IR:
+        {
+            switch( format )
+            {
+                case OBFormat::OB_FORMAT_Y16:
+                    return CV_16UC1;
+                case OBFormat::OB_FORMAT_Y8:
+                    return CV_8UC1;
+                default:
+                    return -1;
+            }
+        }
+        default:
+        {
+            return -1;
+        }
+    }
+}
+
+// Allocator of cv::Mat that wraps frame memory without copy
+// cv::Mat holds reference of frame (ob_frame_add_ref), so frame memory stays valid for as long as cv::Mat (or its copies) lives.
+class ob_frame_allocator : public cv::MatAllocator
+{
+private:
+    // Data of cv::Mat that holds frame
+    struct frame_data : public cv::UMatData
+    {
+        ob_frame* frame;
+
+        frame_data( const cv::MatAllocator* allocator, ob_frame* frame )
+            : cv::UMatData( allocator ), frame( frame )
+        {
+            ob_error* error = NULL;
+            ob_frame_add_ref( frame, &error );
+            CHECK_ERROR( error );
+        }
+
+        ~frame_data()
+        {
+            // Destructor must not throw, error is reported as warning
+            ob_error* error = NULL;
+            ob_delete_frame( frame, &error );
+            if( ob_error_status( error ) != ob_status::OB_STATUS_OK ){
+                std::cout << "[warning] failed to release frame : " << ob_error_message( error ) << std::endl;
+                ob_delete_error( error );
+            }
+        }
+    };
+
+public:
+    // Get Instance
+    static const ob_frame_allocator* instance()
+    {
+        static const ob_frame_allocator allocator;
+        return &allocator;
+    }
+
+    // Wrap Frame Memory into cv::Mat
+    cv::Mat wrap( ob_frame* frame, const int32_t type ) const
+    {
+        // Get Size and Data of Frame (before cv::Mat is built)
+        ob_error* error = NULL;
+        const uint32_t width = ob_video_frame_width( frame, &error );
+        CHECK_ERROR( error );
+        const uint32_t height = ob_video_frame_height( frame, &error );
+        CHECK_ERROR( error );
+        void* frame_memory = ob_frame_data( frame, &error );
+        CHECK_ERROR( error );
+        if( frame_memory == nullptr ){
+            throw std::runtime_error( "[error] failed to get data of frame!" );
+        }
+
+        cv::Mat mat = cv::Mat( height, width, type, frame_memory );
+        frame_data* data = new frame_data( this, frame );
+        data->data = data->origdata = mat.data;
+        data->size = mat.total() * mat.elemSize();
+        data->flags = cv::UMatData::USER_ALLOCATED;
+        data->refcount = 1;
+
+        mat.u = data;
+        mat.allocator = this;
+        return mat;
+    }
+
+    // Is cv::Mat Wrapping Frame Memory
+    bool is_wrapped( const cv::Mat& mat ) const
+    {
+        return mat.u != nullptr && mat.u->currAllocator == this;
+    }
+
+    // Allocate (new buffers, e.g. cv::Mat::create() on wrapped cv::Mat, are allocated by default allocator)
+    cv::UMatData* allocate( int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usage ) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate( dims, sizes, type, data, step, flags, usage );
+    }
+
+    bool allocate( cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usage ) const override
+    {
+        return data != nullptr;
+    }
+
+    // Deallocate (release reference of frame)
+    void deallocate( cv::UMatData* data ) const override
+    {
+        delete static_cast<frame_data*>( data );
+    }
+};
+
+// Decode MJPG frame into caller-owned cv::Mat
+// scale (1, 2, 4 or 8) decodes at reduced resolution using DCT scaling of JPEG decoder (e.g. for preview).
+void ob_decode_mjpg( ob_frame* src, cv::Mat& dst, const int32_t scale = 1 )
+{
+    ob_error* error = NULL;
+    assert( ob_frame_format( src, &error ) == OBFormat::OB_FORMAT_MJPG );
+
+    const bool is_color = ob_frame_get_type( src, &error ) == OBFrameType::OB_FRAME_COLOR;
+    int32_t flags = cv::IMREAD_ANYCOLOR;
+    switch( scale )
+    {
+        case 1:
+            break;
+        case 2:
+            flags = is_color ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2;
+            break;
+        case 4:
+            flags = is_color ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4;
+            break;
+        case 8:
+            flags = is_color ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8;
+            break;
+        default:
+            throw std::runtime_error( "[error] failed to decode mjpg with this scale!" );
+    }
+
+    // Decode directly from frame memory through non-owning header (dst is reused while size and type match)
+    const cv::Mat buffer = cv::Mat( 1, static_cast<int32_t>( ob_frame_data_size( src, &error ) ), CV_8UC1, ob_frame_data( src, &error ) );
+    cv::imdecode( buffer, flags, &dst );
+}
+
+// Convert ob_frame to caller-owned cv::Mat
+// dst is reused while its size and type match, so streaming does not allocate after the first frame.
+// YUYV, UYVY, NV12, NV21, RGB and BGRA are converted by SIMD kernels of color_kernel.h (bit-exact with cv::cvtColor).
+void ob_get_mat( ob_frame* src, cv::Mat& dst )
 {
     ob_error* error = NULL;
 
     const uint32_t data_size = ob_frame_data_size( src, &error );
     assert( data_size != 0 );
 
-    cv::Mat mat;
+    // Do not write into frame memory wrapped by previous frame
+    if( ob_frame_allocator::instance()->is_wrapped( dst ) ){
+        dst.release();
+    }
+
     const uint32_t width = ob_video_frame_width( src, &error );
     const uint32_t height = ob_video_frame_height( src, &error );
+    void* data = ob_frame_data( src, &error );
 
     const OBFrameType frame_type = ob_frame_get_type( src, &error );
     const OBFormat format = ob_frame_format( src, &error );
-    void* data = ob_frame_data( src, &error );
 
     switch( frame_type )
     {
@@ -57,38 +244,32 @@ cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
             {
                 case OBFormat::OB_FORMAT_YUYV:
                 {
-                    cv::Mat yuyv = cv::Mat( height, width, CV_8UC2, data ).clone();
-                    cv::cvtColor( yuyv, mat, cv::COLOR_YUV2BGR_YUYV );
+                    color_kernel::convert( color_kernel::format::yuyv, data, width, height, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_YUY2: // not supported by femto mega
                 {
-                    cv::Mat yuy2 = cv::Mat( height, width, CV_8UC2, data ).clone();
-                    cv::cvtColor( yuy2, mat, cv::COLOR_YUV2BGR_YUY2 );
+                    color_kernel::convert( color_kernel::format::yuyv, data, width, height, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_UYVY: // not supported by femto mega
                 {
-                    cv::Mat uyvy = cv::Mat( height, width, CV_8UC2, data ).clone();
-                    cv::cvtColor( uyvy, mat, cv::COLOR_YUV2BGR_UYVY );
+                    color_kernel::convert( color_kernel::format::uyvy, data, width, height, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_NV12:
                 {
-                    cv::Mat nv12 = cv::Mat( height + height / 2, width, CV_8UC1, data ).clone();
-                    cv::cvtColor( nv12, mat, cv::COLOR_YUV2BGR_NV12 );
+                    color_kernel::convert( color_kernel::format::nv12, data, width, height, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_NV21: // not supported by femto mega
                 {
-                    cv::Mat nv21 = cv::Mat( height + height / 2, width, CV_8UC1, data ).clone();
-                    cv::cvtColor( nv21, mat, cv::COLOR_YUV2BGR_NV21 );
+                    color_kernel::convert( color_kernel::format::nv21, data, width, height, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_MJPG:
                 {
-                    std::vector<uint8_t> buffer( reinterpret_cast<uint8_t*>( data ), reinterpret_cast<uint8_t*>( data ) + data_size );
-                    mat = cv::imdecode( buffer, cv::IMREAD_ANYCOLOR );
+                    ob_decode_mjpg( src, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_H264:
@@ -99,7 +280,7 @@ cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
                 }
                 case OBFormat::OB_FORMAT_GRAY: // not supported by femto mega
                 {
-                    mat = cv::Mat( height, width, CV_8UC1, data ).clone();
+                    cv::Mat( height, width, CV_8UC1, data ).copyTo( dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_HEVC:
@@ -109,28 +290,22 @@ cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
                 }
                 case OBFormat::OB_FORMAT_I420: // not supported by femto mega
                 {
-                    cv::Mat i420 = cv::Mat( height, width, CV_8UC2, data ).clone();
-                    cv::cvtColor( i420, mat, cv::COLOR_YUV2BGR_I420 );
+                    cv::cvtColor( cv::Mat( height + height / 2, width, CV_8UC1, data ), dst, cv::COLOR_YUV2BGR_I420 );
                     break;
                 }
                 case OBFormat::OB_FORMAT_RGB:
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_8UC3, data ).clone()
-                                    : cv::Mat( height, width, CV_8UC3, data );
-                    cv::cvtColor( mat, mat, cv::COLOR_RGB2BGR );
+                    color_kernel::convert( color_kernel::format::rgb, data, width, height, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_BGR: // not supported by femto mega
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_8UC3, data ).clone()
-                                    : cv::Mat( height, width, CV_8UC3, data );
+                    cv::Mat( height, width, CV_8UC3, data ).copyTo( dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_BGRA:
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_8UC4, data ).clone()
-                                    : cv::Mat( height, width, CV_8UC4, data );
-                    cv::cvtColor( mat, mat, cv::COLOR_BGRA2BGR );
+                    color_kernel::convert( color_kernel::format::bgra, data, width, height, dst );
                     break;
                 }
                 default:
@@ -151,14 +326,12 @@ cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
                 case OBFormat::OB_FORMAT_Y12:
                 case OBFormat::OB_FORMAT_Y14:
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) ).clone()
-                                    : cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) );
+                    cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) ).copyTo( dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_Y8:
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_8UC1, data ).clone()
-                                    : cv::Mat( height, width, CV_8UC1, data );
+                    cv::Mat( height, width, CV_8UC1, data ).copyTo( dst );
                     break;
                 }
                 default:
@@ -176,20 +349,17 @@ cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
                 case OBFormat::OB_FORMAT_MJPG:
                 {
                     // NOTE: this is slower than other formats.
-                    std::vector<uint8_t> buffer( reinterpret_cast<uint8_t*>( data ), reinterpret_cast<uint8_t*>( data ) + data_size );
-                    mat = cv::imdecode( buffer, cv::IMREAD_ANYCOLOR );
+                    ob_decode_mjpg( src, dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_Y16:
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) ).clone()
-                                    : cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) );
+                    cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) ).copyTo( dst );
                     break;
                 }
                 case OBFormat::OB_FORMAT_Y8:
                 {
-                    mat = deep_copy ? cv::Mat( height, width, CV_8UC1, data ).clone()
-                                    : cv::Mat( height, width, CV_8UC1, data );
+                    cv::Mat( height, width, CV_8UC1, data ).copyTo( dst );
                     break;
                 }
                 default:
@@ -206,8 +376,88 @@ cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
             break;
         }
     }
+}
+
+// Convert ob_frame to cv::Mat
+// If deep_copy is false, formats that need no conversion (e.g. Y16, Y8, BGR) are returned as a view of the frame memory.
+// The view holds reference of frame until it is released. Writing into the view modifies the frame.
+cv::Mat ob_get_mat( ob_frame* src, bool deep_copy = true )
+{
+    ob_error* error = NULL;
+
+    const int32_t type = ob_get_mat_type( ob_frame_get_type( src, &error ), ob_frame_format( src, &error ) );
+    if( !deep_copy && type != -1 ){
+        return ob_frame_allocator::instance()->wrap( src, type );
+    }
 
+    cv::Mat mat;
+    ob_get_mat( src, mat );
     return mat;
 }
 
+// Create look-up table that maps depth (Y16) to 8-bit image for visualization
+// Invalid depth (0) is mapped to black. If colormap (cv::ColormapTypes) is specified, table is BGR.
+cv::Mat ob_create_depth_lut( const double max_range, const int32_t colormap = -1 )
+{
+    cv::Mat lut = cv::Mat( 1, std::numeric_limits<uint16_t>::max() + 1, CV_8UC1 );
+    uint8_t* table = lut.ptr<uint8_t>();
+    table[0] = 0;
+    for( int32_t i = 1; i < lut.cols; i++ ){
+        table[i] = cv::saturate_cast<uint8_t>( i * ( -255.0 / max_range ) + 255.0 );
+    }
+
+    if( colormap < 0 ){
+        return lut;
+    }
+
+    cv::Mat color_lut;
+    cv::applyColorMap( lut, color_lut, colormap );
+    color_lut.at<cv::Vec3b>( 0 ) = cv::Vec3b( 0, 0, 0 );
+    return color_lut;
+}
+
+// Look-up of depth rows (loop body is not allocated as std::function of lambda every frame)
+template<typename T>
+class ob_depth_lut_body : public cv::ParallelLoopBody
+{
+private:
+    const cv::Mat& depth;
+    const T* table;
+    cv::Mat& dst;
+
+public:
+    // Constructor
+    ob_depth_lut_body( const cv::Mat& depth, const cv::Mat& lut, cv::Mat& dst )
+        : depth( depth ), table( lut.ptr<T>() ), dst( dst )
+    {
+    }
+
+    // Look-Up Rows
+    void operator()( const cv::Range& range ) const override
+    {
+        for( int32_t y = range.start; y < range.end; y++ ){
+            const uint16_t* src = depth.ptr<uint16_t>( y );
+            T* row = dst.ptr<T>( y );
+            for( int32_t x = 0; x < depth.cols; x++ ){
+                row[x] = table[src[x]];
+            }
+        }
+    }
+};
+
+// Visualize depth (Y16) with look-up table into caller-owned cv::Mat
+void ob_visualize_depth( const cv::Mat& depth, const cv::Mat& lut, cv::Mat& dst )
+{
+    assert( depth.type() == CV_16UC1 );
+    assert( lut.total() == std::numeric_limits<uint16_t>::max() + 1 );
+
+    dst.create( depth.size(), lut.type() );
+    if( lut.type() == CV_8UC1 ){
+        cv::parallel_for_( cv::Range( 0, depth.rows ), ob_depth_lut_body<uint8_t>( depth, lut, dst ) );
+    }
+    else{
+        cv::parallel_for_( cv::Range( 0, depth.rows ), ob_depth_lut_body<cv::Vec3b>( depth, lut, dst ) );
+    }
+}
+
 #endif // __UTIL__
\ No newline at end of file
@@ -115,6 +115,19 @@ inline void orbbec::initialize_sensor()
     CHECK_ERROR( error );
 }
 
+// Publish Frame to Triple Buffer (Playback Callback)
+inline void publish_frame( triple_buffer<ob_frame*>& buffer, ob_frame* frame )
+{
+    ob_error* error = NULL;
+    ob_frame*& slot = buffer.write_buffer();
+    if( slot != nullptr ){
+        ob_delete_frame( slot, &error );
+        CHECK_ERROR( error );
+    }
+    slot = frame;
+    buffer.publish();
+}
+
 // Initialize Player
 void orbbec::initialize_player()
 {
@@ -156,25 +169,18 @@ void orbbec::initialize_player()
                 const ob_frame_type frame_type = ob_frame_get_type( frame, &error );
                 CHECK_ERROR( error );
 
-                std::unique_lock<std::mutex> lock( this_class->frame_mutex );
-
+                // Publish Frame (frame returned from consumer or not taken by consumer is released here)
                 switch( frame_type ){
                     case ob_frame_type::OB_FRAME_COLOR:
-                        if( this_class->color_frame != nullptr ){
-                            ob_delete_frame( this_class->color_frame, &error );
-                            CHECK_ERROR( error );
-                        }
-                        this_class->color_frame = frame;
+                        publish_frame( this_class->color_buffer, frame );
                         break;
                     case ob_frame_type::OB_FRAME_DEPTH:
-                        if( this_class->depth_frame != nullptr ){
-                            ob_delete_frame( this_class->depth_frame, &error );
-                            CHECK_ERROR( error );
-                        }
-                        this_class->depth_frame = frame;
+                        publish_frame( this_class->depth_buffer, frame );
                         break;
                     default:
                         std::cout << "[warning] unknown frame type! ( " << frame_type << " )"  << std::endl;
+                        ob_delete_frame( frame, &error );
+                        CHECK_ERROR( error );
                         break;
                 }
             }
@@ -201,6 +207,21 @@ void orbbec::finalize()
         CHECK_ERROR( error );
     }
 
+    // Delete Frames of Player
+    if( player != nullptr ){
+        const auto delete_frame = [&]( ob_frame*& frame ){
+            if( frame != nullptr ){
+                ob_delete_frame( frame, &error );
+                CHECK_ERROR( error );
+                frame = nullptr;
+            }
+        };
+        color_buffer.for_each( delete_frame );
+        depth_buffer.for_each( delete_frame );
+        color_frame = nullptr;
+        depth_frame = nullptr;
+    }
+
     // Delete Frame Set
     if( frameset != nullptr ){
         ob_delete_frame( frameset, &error );
@@ -297,6 +318,10 @@ inline void orbbec::update_frame()
 inline void orbbec::update_color()
 {
     if( player != nullptr ){
+        // Take Latest Color Frame from Playback Callback (keep previous one if nothing new)
+        if( color_buffer.update() ){
+            color_frame = color_buffer.read_buffer();
+        }
         return;
     }
 
@@ -312,7 +337,11 @@ inline void orbbec::update_color()
 // Update Depth
 inline void orbbec::update_depth()
 {
-    if( player != nullptr ) {
+    if( player != nullptr ){
+        // Take Latest Depth Frame from Playback Callback (keep previous one if nothing new)
+        if( depth_buffer.update() ){
+            depth_frame = depth_buffer.read_buffer();
+        }
         return;
     }
 
@@ -342,10 +371,8 @@ inline void orbbec::draw_color()
         return;
     }
 
-    std::unique_lock<std::mutex> lock( frame_mutex );
-
     // Get cv::Mat from ob_frame
-    color = ob_get_mat( color_frame );
+    ob_get_mat( color_frame, color );
 }
 
 // Draw Depth
@@ -355,10 +382,8 @@ inline void orbbec::draw_depth()
         return;
     }
 
-    std::unique_lock<std::mutex> lock( frame_mutex );
-
     // Get cv::Mat from ob_frame
-    depth = ob_get_mat( depth_frame );
+    ob_get_mat( depth_frame, depth );
 }
 
 // Show
@@ -393,13 +418,16 @@ inline void orbbec::show_depth()
     }
 
     // Scaling Depth
-    const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
-    depth.convertTo( depth, CV_8U, -255.0 / max_range, 255.0 );
+    if( depth_lut.empty() ){
+        const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
+        depth_lut = ob_create_depth_lut( max_range );
+    }
+    ob_visualize_depth( depth, depth_lut, depth_scaled );
 
     // Show Image
     const cv::String window_name = ( player == nullptr ) ? cv::format( "depth (orbbec %d)", device_index )
                                                          : cv::format( "depth (orbbec %s)", serial_number );
-    cv::imshow( window_name, depth );
+    cv::imshow( window_name, depth_scaled );
 }
 
 // Get Depth Range
@@ -1,11 +1,11 @@
 #ifndef __ORBBEC__
 #define __ORBBEC__
 
-#include <mutex>
-
 #include <libobsensor/ObSensor.h>
 #include <opencv2/opencv.hpp>
 
+#include "triple_buffer.h"
+
 class orbbec
 {
 private:
@@ -29,13 +29,16 @@ private:
     ob_stream_profile* depth_stream_profile = nullptr;
     ob_frame* depth_frame = nullptr;
     cv::Mat depth;
+    cv::Mat depth_scaled;
     std::tuple<double, double> depth_range = std::make_tuple<double, double>( 0.0, 0.0 );
+    cv::Mat depth_lut;
 
     // Player
     std::string bag_file = "../data.bag";
     std::string serial_number = "";
     ob_playback* player = nullptr;
-    std::mutex frame_mutex;
+    triple_buffer<ob_frame*> color_buffer; // hand off frames from playback callback without lock
+    triple_buffer<ob_frame*> depth_buffer;
     bool is_run = true;
 
 public:
@@ -263,41 +263,45 @@ inline void orbbec::draw_pointcloud()
         return;
     }
 
-    // Create Point Cloud for Open3D
+    // Resize Persistent Buffers of Open3D only if Number of Points is Changed
+    const auto resize_points = [&]( const size_t count ){
+        if( pointcloud->points_.size() != count ){
+            pointcloud->points_.resize( count );
+        }
+    };
+
+    // Create Point Cloud for Open3D (in place, drop invalid points)
     if( format == ob_format::OB_FORMAT_RGB_POINT ){
         const int32_t num_points = ob_frame_data_size( pointcloud_frame, &error ) / sizeof( ob_color_point );
         CHECK_ERROR( error );
 
-        ob_color_point* data = reinterpret_cast<ob_color_point*>( ob_frame_data( pointcloud_frame, &error ) );
+        const ob_color_point* data = reinterpret_cast<const ob_color_point*>( ob_frame_data( pointcloud_frame, &error ) );
         CHECK_ERROR( error );
 
-        std::vector<Eigen::Vector3d> points = std::vector<Eigen::Vector3d>( num_points );
-        std::vector<Eigen::Vector3d> colors = std::vector<Eigen::Vector3d>( num_points );
-
-        #pragma omp parallel for
-        for( int32_t i = 0; i < num_points; i++ ){
-            points[i] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
-            colors[i] = Eigen::Vector3d( data[i].r, data[i].g, data[i].b );
-        }
-
-        pointcloud->points_ = points;
-        pointcloud->colors_ = colors;
+        compactor.compact( num_points,
+            [&]( const int32_t i ){ return data[i].z != 0.0f; },
+            [&]( const size_t count ){
+                resize_points( count );
+                if( pointcloud->colors_.size() != count ){
+                    pointcloud->colors_.resize( count );
+                }
+            },
+            [&]( const int32_t i, const int32_t j ){
+                pointcloud->points_[j] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
+                pointcloud->colors_[j] = Eigen::Vector3d( data[i].r, data[i].g, data[i].b );
+            } );
     }
     else{
         const int32_t num_points = ob_frame_data_size( pointcloud_frame, &error ) / sizeof( ob_point );
         CHECK_ERROR( error );
 
-        ob_point* data = reinterpret_cast<ob_point*>( ob_frame_data( pointcloud_frame, &error ) );
+        const ob_point* data = reinterpret_cast<const ob_point*>( ob_frame_data( pointcloud_frame, &error ) );
         CHECK_ERROR( error );
 
-        std::vector<Eigen::Vector3d> points = std::vector<Eigen::Vector3d>( num_points );
-
-        #pragma omp parallel for
-        for( int32_t i = 0; i < num_points; i++ ){
-            points[i] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
-        }
-
-        pointcloud->points_ = points;
+        compactor.compact( num_points,
+            [&]( const int32_t i ){ return data[i].z != 0.0f; },
+            resize_points,
+            [&]( const int32_t i, const int32_t j ){ pointcloud->points_[j] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z ); } );
     }
 
     ob_delete_frame( pointcloud_frame, &error );
@@ -4,6 +4,8 @@
 #include <libobsensor/ObSensor.h>
 #include <open3d/Open3D.h>
 
+#include "point_compactor.h"
+
 class orbbec
 {
 private:
@@ -29,6 +31,7 @@ private:
     ob_filter* pointcloud_filter = nullptr;
     ob_frame* pointcloud_frame = nullptr;
     std::shared_ptr<open3d::geometry::PointCloud> pointcloud = nullptr;
+    point_compactor compactor; // drop invalid points while converting into pointcloud
     open3d::visualization::VisualizerWithKeyCallback visualizer;
     bool is_run = true;
 
@@ -0,0 +1,74 @@
+#ifndef __POINT_COMPACTOR__
+#define __POINT_COMPACTOR__
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+/*
+ Parallel compaction of points
+
+ Points are split into fixed size blocks. Valid points of each block are counted in parallel,
+ offset of each block is prefix sum of the counts, then valid points are written to final position in parallel.
+ Order of points is kept, so points can be written in place into persistent buffers (e.g. open3d::geometry::PointCloud::points_).
+
+ point_compactor compactor;
+ compactor.compact( num_points,
+     [&]( const int32_t i ){ return data[i].z != 0.0f; }, // is valid
+     [&]( const size_t count ){ points.resize( count ); }, // resize destination
+     [&]( const int32_t i, const int32_t j ){ points[j] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z ); } ); // write i-th point to j
+*/
+class point_compactor
+{
+private:
+    static constexpr int32_t block_size = 8192;
+    std::vector<int32_t> offsets; // offset of each block in destination (number of blocks + 1)
+
+public:
+    // Compact Valid Points
+    // Returns number of valid points.
+    template<typename IsValid, typename Resize, typename Write>
+    size_t compact( const int32_t num_points, IsValid is_valid, Resize resize, Write write )
+    {
+        const int32_t num_blocks = ( num_points + block_size - 1 ) / block_size;
+        offsets.resize( num_blocks + 1 );
+        offsets[0] = 0;
+
+        // Count Valid Points of Each Block
+        #pragma omp parallel for
+        for( int32_t block = 0; block < num_blocks; block++ ){
+            const int32_t begin = block * block_size;
+            const int32_t end = std::min( begin + block_size, num_points );
+            int32_t count = 0;
+            for( int32_t i = begin; i < end; i++ ){
+                count += is_valid( i ) ? 1 : 0;
+            }
+            offsets[block + 1] = count;
+        }
+
+        // Prefix Sum
+        for( int32_t block = 0; block < num_blocks; block++ ){
+            offsets[block + 1] += offsets[block];
+        }
+
+        const size_t count = static_cast<size_t>( offsets[num_blocks] );
+        resize( count );
+
+        // Write Valid Points
+        #pragma omp parallel for
+        for( int32_t block = 0; block < num_blocks; block++ ){
+            const int32_t begin = block * block_size;
+            const int32_t end = std::min( begin + block_size, num_points );
+            int32_t j = offsets[block];
+            for( int32_t i = begin; i < end; i++ ){
+                if( is_valid( i ) ){
+                    write( i, j++ );
+                }
+            }
+        }
+
+        return count;
+    }
+};
+
+#endif // __POINT_COMPACTOR__
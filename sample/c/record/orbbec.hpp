@@ -27,7 +27,9 @@ private:
     ob_stream_profile* depth_stream_profile = nullptr;
     ob_frame* depth_frame = nullptr;
     cv::Mat depth;
+    cv::Mat depth_scaled;
     std::tuple<double, double> depth_range = std::make_tuple<double, double>( 0.0, 0.0 );
+    cv::Mat depth_lut;
 
     // Recorder
     std::string bag_file = "data.bag";
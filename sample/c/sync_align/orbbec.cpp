@@ -248,7 +248,7 @@ inline void orbbec::draw_color()
     }
 
     // Get cv::Mat from ob_frame
-    color = ob_get_mat( color_frame );
+    ob_get_mat( color_frame, color );
 }
 
 // Draw Depth
@@ -259,7 +259,7 @@ inline void orbbec::draw_depth()
     }
 
     // Get cv::Mat from ob_frame
-    depth = ob_get_mat( depth_frame );
+    ob_get_mat( depth_frame, depth );
 }
 
 // Show
@@ -292,12 +292,15 @@ inline void orbbec::show_depth()
     }
 
     // Scaling Depth
-    const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
-    depth.convertTo( depth, CV_8U, -255.0 / max_range, 255.0 );
+    if( depth_lut.empty() ){
+        const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
+        depth_lut = ob_create_depth_lut( max_range );
+    }
+    ob_visualize_depth( depth, depth_lut, depth_scaled );
 
     // Show Image
     const cv::String window_name = cv::format( "depth (orbbec %d)", device_index );
-    cv::imshow( window_name, depth );
+    cv::imshow( window_name, depth_scaled );
 }
 
 // Get Depth Range
@@ -0,0 +1,229 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+
+#include "frame_source.h"
+#include "triple_buffer.h"
+
+// End-to-End Latency of Frame Acquisition (main loop vs polling thread vs callback)
+// main_loop : render loop waits for frame set itself (like original samples)
+// polling   : acquisition thread waits for frame set and hands it off to render loop (latest frame set in triple buffer)
+// callback  : producer of mock_source pushes frame set to triple buffer as soon as it is produced (like SDK callback)
+// Latency is measured from time frame was produced (system timestamp of frame [ms]) to time render loop takes it.
+
+// Acquisition Mode
+enum class acquisition_mode { main_loop, polling, callback };
+
+// Frame Packet
+struct frame_packet
+{
+    std::shared_ptr<ob::FrameSet> frameset = nullptr;
+    std::chrono::system_clock::time_point timestamp; // produced (system timestamp of frame)
+};
+
+// Benchmark Result
+struct bench_result
+{
+    acquisition_mode mode;
+    uint32_t fps;
+    int32_t render_interval; // [ms] (0 is busy loop)
+    uint64_t delivered;
+    uint64_t consumed;
+    uint64_t skipped;
+    double latency_ms_average;
+    double latency_ms_p99;
+    double latency_ms_max;
+};
+
+// To String
+std::string to_string( const acquisition_mode mode )
+{
+    switch( mode ){
+        case acquisition_mode::main_loop:
+            return "main_loop";
+        case acquisition_mode::polling:
+            return "polling";
+        case acquisition_mode::callback:
+            return "callback";
+        default:
+            return "unknown";
+    }
+}
+
+// Run Benchmark
+bench_result run( const acquisition_mode mode, const uint32_t fps, const int32_t render_interval )
+{
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 2000 );
+
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_BGRA, 1280, 720 };
+    mock_source source = mock_source( color_stream, mock_source::stream(), mock_source::stream(), fps );
+
+    // Push Frame (same as samples)
+    triple_buffer<frame_packet> latest_frame;
+    std::atomic<uint64_t> delivered = 0;
+    std::atomic<uint64_t> skipped = 0;
+    const auto push_frame = [&]( std::shared_ptr<ob::FrameSet> frameset ){
+        delivered++;
+
+        const std::shared_ptr<ob::Frame> frame = frameset->colorFrame();
+        latest_frame.write_buffer() = { frameset, std::chrono::system_clock::time_point( std::chrono::milliseconds( frame->systemTimeStamp() ) ) };
+        latest_frame.publish();
+
+        frame_packet& superseded = latest_frame.write_buffer();
+        if( superseded.frameset != nullptr ){
+            skipped++;
+        }
+        superseded = frame_packet();
+    };
+
+    // Start Acquisition
+    std::atomic<bool> is_acquire = true;
+    std::thread acquisition_thread;
+    if( mode == acquisition_mode::callback ){
+        // Frame sets are pushed on producer thread of source
+        source.start( push_frame );
+    }
+    else if( mode == acquisition_mode::main_loop ){
+        // Frame sets are waited on render loop
+        source.start();
+    }
+    else{
+        // Frame sets are polled on acquisition thread
+        source.start();
+        acquisition_thread = std::thread( [&](){
+            while( is_acquire ){
+                constexpr uint32_t timeout = 100;
+                std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+                if( frameset != nullptr ){
+                    push_frame( frameset );
+                }
+            }
+        } );
+    }
+
+    // Render Loop (takes latest frame set)
+    std::vector<double> latencies;
+    latencies.reserve( static_cast<size_t>( fps ) * 4 );
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + duration;
+    while( std::chrono::steady_clock::now() < end ){
+        if( mode == acquisition_mode::main_loop ){
+            constexpr uint32_t timeout = 100;
+            std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+            if( frameset != nullptr ){
+                push_frame( frameset );
+            }
+        }
+
+        if( latest_frame.update() ){
+            frame_packet& packet = latest_frame.read_buffer();
+            latencies.push_back( std::chrono::duration<double, std::milli>( std::chrono::system_clock::now() - packet.timestamp ).count() );
+            packet = frame_packet();
+        }
+
+        if( render_interval > 0 ){
+            std::this_thread::sleep_for( std::chrono::milliseconds( render_interval ) );
+        }
+        else{
+            std::this_thread::yield();
+        }
+    }
+
+    // Stop Acquisition
+    is_acquire = false;
+    if( acquisition_thread.joinable() ){
+        acquisition_thread.join();
+    }
+    source.stop();
+    latest_frame.for_each( []( frame_packet& packet ){ packet = frame_packet(); } );
+
+    if( latencies.empty() ){
+        throw std::runtime_error( "[error] no frame set was delivered (" + to_string( mode ) + ")!" );
+    }
+    if( *std::min_element( latencies.begin(), latencies.end() ) < 0.0 ){
+        throw std::runtime_error( "[error] frame set was taken before it was produced (" + to_string( mode ) + ")!" );
+    }
+
+    // Statistics of Latency
+    bench_result result;
+    result.mode = mode;
+    result.fps = fps;
+    result.render_interval = render_interval;
+    result.delivered = delivered;
+    result.consumed = latencies.size();
+    result.skipped = skipped;
+    double total = 0.0;
+    for( const double latency : latencies ){
+        total += latency;
+    }
+    result.latency_ms_average = total / latencies.size();
+    std::sort( latencies.begin(), latencies.end() );
+    result.latency_ms_p99 = latencies[latencies.size() * 99 / 100];
+    result.latency_ms_max = latencies.back();
+    return result;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"mode\": \"" << to_string( result.mode ) << "\", ";
+        stream << "\"fps\": " << result.fps << ", ";
+        stream << "\"render_interval_ms\": " << result.render_interval << ", ";
+        stream << "\"delivered\": " << result.delivered << ", ";
+        stream << "\"consumed\": " << result.consumed << ", ";
+        stream << "\"skipped\": " << result.skipped << ", ";
+        stream << "\"latency_ms_average\": " << result.latency_ms_average << ", ";
+        stream << "\"latency_ms_p99\": " << result.latency_ms_p99 << ", ";
+        stream << "\"latency_ms_max\": " << result.latency_ms_max;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        // Run Benchmark (render loop of samples waits 10 ms for key, busy loop shows latency of handoff itself)
+        std::vector<bench_result> results;
+        for( const uint32_t fps : { 30, 120 } ){
+            for( const int32_t render_interval : { 0, 10 } ){
+                for( const acquisition_mode mode : { acquisition_mode::main_loop, acquisition_mode::polling, acquisition_mode::callback } ){
+                    const bench_result result = run( mode, fps, render_interval );
+                    std::cerr << to_string( mode ) << " " << fps << " fps, render interval " << render_interval << " ms : consumed " << result.consumed << " of " << result.delivered
+                              << ", latency " << result.latency_ms_average << " ms (p99 " << result.latency_ms_p99 << " ms, max " << result.latency_ms_max << " ms)" << std::endl;
+                    results.push_back( result );
+                }
+            }
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef __TRIPLE_BUFFER__
+#define __TRIPLE_BUFFER__
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer (latest value) for single producer and single consumer
+// Producer writes into its own buffer and publishes it, consumer takes latest published buffer. Neither side waits for the other.
+// Published value that is overwritten before consumer takes it goes back to producer, so producer must release it before reuse.
+template<typename T>
+class triple_buffer
+{
+private:
+    static constexpr uint8_t index_mask = 0x3;
+    static constexpr uint8_t fresh_bit = 0x4; // middle buffer has value not taken by consumer yet
+
+    T buffers[3] = {};
+    uint8_t write_index = 0; // producer only
+    alignas( 64 ) uint8_t read_index = 1; // consumer only
+    alignas( 64 ) std::atomic<uint8_t> middle = 2; // index of middle buffer | fresh bit
+
+public:
+    // Buffer to Write (Producer Only)
+    T& write_buffer()
+    {
+        return buffers[write_index];
+    }
+
+    // Publish Written Buffer (Producer Only)
+    // Written buffer is exchanged with middle buffer, so write_buffer() returns buffer that is no longer referred by consumer.
+    void publish()
+    {
+        write_index = middle.exchange( write_index | fresh_bit, std::memory_order_acq_rel ) & index_mask;
+    }
+
+    // Take Latest Published Buffer (Consumer Only)
+    // Return false if nothing was published since last update, read_buffer() keeps previous value then.
+    bool update()
+    {
+        if( ( middle.load( std::memory_order_relaxed ) & fresh_bit ) == 0 ){
+            return false;
+        }
+        read_index = middle.exchange( read_index, std::memory_order_acq_rel ) & index_mask;
+        return true;
+    }
+
+    // Buffer to Read (Consumer Only)
+    T& read_buffer()
+    {
+        return buffers[read_index];
+    }
+
+    // Apply Function to All Buffers
+    // Producer and consumer must be stopped (e.g. to release remaining values).
+    template<typename Function>
+    void for_each( Function function )
+    {
+        for( T& buffer : buffers ){
+            function( buffer );
+        }
+    }
+};
+
+#endif // __TRIPLE_BUFFER__
@@ -0,0 +1,521 @@
+#ifndef __ALIGN__
+#define __ALIGN__
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "color_kernel.h"
+
+/*
+ Software alignment of depth and color (D2C and C2D) on CPU
+
+ Ray of each depth pixel (undistorted, and rotated into color camera coordinates) is precomputed into table when depth size changes,
+ so reprojection of pixel is 3 multiply-add and 1 division. Rows are reprojected in parallel (cv::parallel_for_),
+ projection of row is computed over contiguous float arrays by AVX2 kernel (chosen at runtime like color_kernel, scalar otherwise),
+ and depth is scattered with z-buffer. Distortion of color camera (Brown-Conrady, same model as OpenCV) is applied to projected points.
+ Footprint of depth pixel is approximated by undistorted size of pixel at center of depth image.
+
+ // D2C (depth in geometry of color image)
+ software_align aligner( pipeline->getCameraParam() );
+ aligner.align_depth_to_color( depth, color.size(), aligned_depth );
+
+ // C2D (color in geometry of depth image)
+ aligner.align_color_to_depth( depth, color, aligned_color );
+*/
+class software_align
+{
+public:
+    // Intrinsic of Camera (pinhole)
+    struct intrinsic
+    {
+        float fx;
+        float fy;
+        float cx;
+        float cy;
+        int32_t width;
+        int32_t height;
+    };
+
+    // Distortion of Camera (Brown-Conrady, rational radial k1-k6 and tangential p1, p2, zero is pinhole)
+    struct distortion
+    {
+        float k1;
+        float k2;
+        float k3;
+        float k4;
+        float k5;
+        float k6;
+        float p1;
+        float p2;
+    };
+
+private:
+    // Camera Parameters
+    intrinsic depth_intrinsic;
+    intrinsic color_intrinsic;
+    distortion depth_distortion;
+    distortion color_distortion;
+    float rotation[9]; // depth to color (row major)
+    float translation[3]; // depth to color [mm]
+    color_kernel::isa target = color_kernel::isa::scalar;
+
+    // Ray Table (rotated into color camera coordinates)
+    cv::Size ray_size;
+    std::vector<float> ray_x;
+    std::vector<float> ray_y;
+    std::vector<float> ray_z;
+    float half_pixel[3]; // rotated offset from center to corner of pixel ( +0.5 pixel in x and y )
+
+    // Z-Buffer
+    std::unique_ptr<std::atomic<uint16_t>[]> z_buffer = nullptr;
+    size_t z_buffer_size = 0;
+
+    static constexpr uint16_t z_far = 0xFFFF;
+
+public:
+    // Constructor
+    explicit software_align( const OBCameraParam& param )
+        : software_align( to_intrinsic( param.depthIntrinsic ), to_intrinsic( param.rgbIntrinsic ), param.transform.rot, param.transform.trans,
+                          to_distortion( param.depthDistortion ), to_distortion( param.rgbDistortion ) )
+    {
+    }
+
+    // Constructor
+    software_align( const intrinsic& depth_intrinsic, const intrinsic& color_intrinsic, const float rotation[9], const float translation[3],
+                    const distortion& depth_distortion = distortion{}, const distortion& color_distortion = distortion{} )
+        : depth_intrinsic( depth_intrinsic ), color_intrinsic( color_intrinsic ), depth_distortion( depth_distortion ), color_distortion( color_distortion )
+    {
+        if( depth_intrinsic.fx <= 0.0f || depth_intrinsic.fy <= 0.0f || color_intrinsic.fx <= 0.0f || color_intrinsic.fy <= 0.0f ){
+            throw std::runtime_error( "[error] invalid camera intrinsic!" );
+        }
+        std::copy( rotation, rotation + 9, this->rotation );
+        std::copy( translation, translation + 3, this->translation );
+        set_isa( color_kernel::get_isa() );
+    }
+
+    // Set Instruction Set of Projection (AVX2 or scalar)
+    void set_isa( const color_kernel::isa target )
+    {
+        if( !color_kernel::is_supported( target ) ){
+            throw std::runtime_error( "[error] instruction set is not supported by this cpu!" );
+        }
+        this->target = ( target == color_kernel::isa::avx2 ) ? target : color_kernel::isa::scalar;
+    }
+
+    // Instruction Set of Projection
+    color_kernel::isa get_isa() const
+    {
+        return target;
+    }
+
+    // Align Depth to Color (D2C)
+    // depth is CV_16UC1, dst is CV_16UC1 of color_size. Each depth pixel covers its footprint in color image, nearest depth wins.
+    void align_depth_to_color( const cv::Mat& depth, const cv::Size& color_size, cv::Mat& dst )
+    {
+        assert( depth.type() == CV_16UC1 );
+
+        update_ray_table( depth.size() );
+        const intrinsic color_scaled = scale( color_intrinsic, color_size );
+
+        // Clear Z-Buffer
+        const size_t pixels = static_cast<size_t>( color_size.area() );
+        if( z_buffer_size != pixels ){
+            z_buffer = std::make_unique<std::atomic<uint16_t>[]>( pixels );
+            z_buffer_size = pixels;
+        }
+        cv::parallel_for_( cv::Range( 0, color_size.height ), [&]( const cv::Range& range ){
+            for( size_t i = static_cast<size_t>( range.start ) * color_size.width; i < static_cast<size_t>( range.end ) * color_size.width; i++ ){
+                z_buffer[i].store( z_far, std::memory_order_relaxed );
+            }
+        } );
+
+        // Reproject Rows of Depth
+        cv::parallel_for_( cv::Range( 0, depth.rows ), [&]( const cv::Range& range ){
+            row_scratch& scratch = get_scratch( depth.cols );
+            const float* u0 = scratch.u0.data();
+            const float* v0 = scratch.v0.data();
+            const float* u1 = scratch.u1.data();
+            const float* v1 = scratch.v1.data();
+            const float* zc = scratch.zc.data();
+            for( int32_t y = range.start; y < range.end; y++ ){
+                const uint16_t* src = depth.ptr<uint16_t>( y );
+                project_row( src, y, color_scaled, scratch );
+
+                // Scatter Footprint with Z-Buffer
+                for( int32_t x = 0; x < depth.cols; x++ ){
+                    if( src[x] == 0 || zc[x] < 1.0f ){
+                        continue;
+                    }
+
+                    int32_t left = 0, right = 0, top = 0, bottom = 0;
+                    if( !get_footprint( u0[x], u1[x], color_size.width, left, right ) || !get_footprint( v0[x], v1[x], color_size.height, top, bottom ) ){
+                        continue;
+                    }
+
+                    const uint16_t z = static_cast<uint16_t>( std::min( zc[x] + 0.5f, static_cast<float>( z_far - 1 ) ) );
+                    for( int32_t v = top; v <= bottom; v++ ){
+                        std::atomic<uint16_t>* row = z_buffer.get() + static_cast<size_t>( v ) * color_size.width;
+                        for( int32_t u = left; u <= right; u++ ){
+                            store_min( row[u], z );
+                        }
+                    }
+                }
+            }
+        } );
+
+        // Resolve Z-Buffer
+        dst.create( color_size, CV_16UC1 );
+        cv::parallel_for_( cv::Range( 0, color_size.height ), [&]( const cv::Range& range ){
+            for( int32_t v = range.start; v < range.end; v++ ){
+                const std::atomic<uint16_t>* row = z_buffer.get() + static_cast<size_t>( v ) * color_size.width;
+                uint16_t* output = dst.ptr<uint16_t>( v );
+                for( int32_t u = 0; u < color_size.width; u++ ){
+                    const uint16_t z = row[u].load( std::memory_order_relaxed );
+                    output[u] = ( z == z_far ) ? 0 : z;
+                }
+            }
+        } );
+    }
+
+    // Align Color to Depth (C2D)
+    // dst has type of color and size of depth. Color is sampled at projection of center of each depth pixel (nearest), pixels without depth are zero.
+    // Occlusion is not tested, so background pixels hidden from color camera take color of occluder.
+    void align_color_to_depth( const cv::Mat& depth, const cv::Mat& color, cv::Mat& dst )
+    {
+        assert( depth.type() == CV_16UC1 );
+
+        update_ray_table( depth.size() );
+        const intrinsic color_scaled = scale( color_intrinsic, color.size() );
+        const size_t element_size = color.elemSize();
+
+        dst.create( depth.size(), color.type() );
+        cv::parallel_for_( cv::Range( 0, depth.rows ), [&]( const cv::Range& range ){
+            row_scratch& scratch = get_scratch( depth.cols );
+            const float* u0 = scratch.u0.data();
+            const float* v0 = scratch.v0.data();
+            const float* u1 = scratch.u1.data();
+            const float* v1 = scratch.v1.data();
+            const float* zc = scratch.zc.data();
+            for( int32_t y = range.start; y < range.end; y++ ){
+                const uint16_t* src = depth.ptr<uint16_t>( y );
+                project_row( src, y, color_scaled, scratch );
+
+                // Gather Color
+                uint8_t* output = dst.ptr<uint8_t>( y );
+                for( int32_t x = 0; x < depth.cols; x++ ){
+                    uint8_t* pixel = output + x * element_size;
+                    const int32_t u = static_cast<int32_t>( std::floor( ( u0[x] + u1[x] ) * 0.5f + 0.5f ) );
+                    const int32_t v = static_cast<int32_t>( std::floor( ( v0[x] + v1[x] ) * 0.5f + 0.5f ) );
+                    if( src[x] == 0 || zc[x] < 1.0f || u < 0 || color.cols <= u || v < 0 || color.rows <= v ){
+                        std::memset( pixel, 0, element_size );
+                        continue;
+                    }
+                    std::memcpy( pixel, color.ptr<uint8_t>( v ) + u * element_size, element_size );
+                }
+            }
+        } );
+    }
+
+private:
+    // Projected Corners of Row (per thread, reused across frames and rows)
+    struct row_scratch
+    {
+        std::vector<float> u0;
+        std::vector<float> v0;
+        std::vector<float> u1;
+        std::vector<float> v1;
+        std::vector<float> zc;
+    };
+
+    // Constants of Projection into Color Image
+    struct projection
+    {
+        float hx, hy, hz; // half pixel
+        float tx, ty, tz; // translation
+        float fx, fy, cx, cy; // intrinsic of color (scaled)
+        distortion color_distortion;
+        bool is_distorted;
+    };
+
+    // Get Scratch of Current Thread (worker threads of cv::parallel_for_ are kept alive, so buffers are allocated only once)
+    static row_scratch& get_scratch( const int32_t width )
+    {
+        thread_local row_scratch scratch;
+        const size_t size = static_cast<size_t>( width );
+        if( scratch.zc.size() != size ){
+            scratch.u0.resize( size );
+            scratch.v0.resize( size );
+            scratch.u1.resize( size );
+            scratch.v1.resize( size );
+            scratch.zc.resize( size );
+        }
+        return scratch;
+    }
+
+    // Update Ray Table for Depth Size
+    void update_ray_table( const cv::Size& depth_size )
+    {
+        if( ray_size == depth_size ){
+            return;
+        }
+
+        const intrinsic depth_scaled = scale( depth_intrinsic, depth_size );
+        const size_t pixels = static_cast<size_t>( depth_size.area() );
+        ray_x.resize( pixels );
+        ray_y.resize( pixels );
+        ray_z.resize( pixels );
+
+        // Ray through Center of Pixel (z = 1, undistorted), rotated into Color Camera Coordinates
+        const bool is_distorted = !is_zero( depth_distortion );
+        for( int32_t y = 0; y < depth_size.height; y++ ){
+            for( int32_t x = 0; x < depth_size.width; x++ ){
+                float nx = ( x - depth_scaled.cx ) / depth_scaled.fx;
+                float ny = ( y - depth_scaled.cy ) / depth_scaled.fy;
+                if( is_distorted ){
+                    undistort( depth_distortion, nx, ny );
+                }
+                const size_t i = static_cast<size_t>( y ) * depth_size.width + x;
+                ray_x[i] = rotation[0] * nx + rotation[1] * ny + rotation[2];
+                ray_y[i] = rotation[3] * nx + rotation[4] * ny + rotation[5];
+                ray_z[i] = rotation[6] * nx + rotation[7] * ny + rotation[8];
+            }
+        }
+
+        // Offset from Center to Corner of Pixel (undistorted size of pixel at principal point)
+        float hx = 0.5f / depth_scaled.fx;
+        float hy = 0.5f / depth_scaled.fy;
+        if( is_distorted ){
+            undistort( depth_distortion, hx, hy );
+        }
+        half_pixel[0] = rotation[0] * hx + rotation[1] * hy;
+        half_pixel[1] = rotation[3] * hx + rotation[4] * hy;
+        half_pixel[2] = rotation[6] * hx + rotation[7] * hy;
+
+        ray_size = depth_size;
+    }
+
+    // Project Corners of Depth Pixels in Row into Color Image
+    // (u0, v0) is top-left corner, (u1, v1) is bottom-right corner, zc is depth of center in color camera.
+    void project_row( const uint16_t* src, const int32_t y, const intrinsic& color_scaled, row_scratch& dst ) const
+    {
+        const size_t offset = static_cast<size_t>( y ) * ray_size.width;
+        const float* rx = ray_x.data() + offset;
+        const float* ry = ray_y.data() + offset;
+        const float* rz = ray_z.data() + offset;
+        const projection constants = {
+            half_pixel[0], half_pixel[1], half_pixel[2],
+            translation[0], translation[1], translation[2],
+            color_scaled.fx, color_scaled.fy, color_scaled.cx, color_scaled.cy,
+            color_distortion, !is_zero( color_distortion )
+        };
+
+        int32_t x = 0;
+        #if defined( COLOR_KERNEL_X86 )
+        if( target == color_kernel::isa::avx2 ){
+            x = project_row_avx2( constants, src, rx, ry, rz, ray_size.width, dst );
+        }
+        #endif
+        project_row_scalar( constants, src, rx, ry, rz, x, ray_size.width, dst );
+    }
+
+    // Project Row (Scalar, also projects remaining pixels of AVX2 kernel from x)
+    // Operations are in same order as AVX2 kernel, so both kernels give same result unless compiler contracts multiply-add.
+    static void project_row_scalar( const projection& p, const uint16_t* src, const float* rx, const float* ry, const float* rz, int32_t x, const int32_t width, row_scratch& dst )
+    {
+        for( ; x < width; x++ ){
+            const float z = static_cast<float>( src[x] );
+
+            const float x0 = z * ( rx[x] - p.hx ) + p.tx;
+            const float y0 = z * ( ry[x] - p.hy ) + p.ty;
+            const float z0 = z * ( rz[x] - p.hz ) + p.tz;
+            const float x1 = z * ( rx[x] + p.hx ) + p.tx;
+            const float y1 = z * ( ry[x] + p.hy ) + p.ty;
+            const float z1 = z * ( rz[x] + p.hz ) + p.tz;
+
+            // Invalid depth (z = 0) gives zc = tz, and is skipped by caller
+            const float inverse0 = 1.0f / std::max( z0, 1.0f );
+            const float inverse1 = 1.0f / std::max( z1, 1.0f );
+            float nx0 = x0 * inverse0, ny0 = y0 * inverse0;
+            float nx1 = x1 * inverse1, ny1 = y1 * inverse1;
+            if( p.is_distorted ){
+                distort( p.color_distortion, nx0, ny0 );
+                distort( p.color_distortion, nx1, ny1 );
+            }
+            dst.u0[x] = p.fx * nx0 + p.cx;
+            dst.v0[x] = p.fy * ny0 + p.cy;
+            dst.u1[x] = p.fx * nx1 + p.cx;
+            dst.v1[x] = p.fy * ny1 + p.cy;
+            dst.zc[x] = z * rz[x] + p.tz;
+        }
+    }
+
+    #if defined( COLOR_KERNEL_X86 )
+    // Distort Normalized Points (AVX2, 8 points)
+    COLOR_KERNEL_TARGET( "avx2" )
+    static void distort_avx2( const distortion& d, __m256& x, __m256& y )
+    {
+        const __m256 one = _mm256_set1_ps( 1.0f );
+        const __m256 two = _mm256_set1_ps( 2.0f );
+        const __m256 xx = _mm256_mul_ps( x, x );
+        const __m256 yy = _mm256_mul_ps( y, y );
+        const __m256 xy = _mm256_mul_ps( x, y );
+        const __m256 r2 = _mm256_add_ps( xx, yy );
+
+        __m256 numerator = _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( d.k3 ), r2 ), _mm256_set1_ps( d.k2 ) );
+        numerator = _mm256_add_ps( _mm256_mul_ps( numerator, r2 ), _mm256_set1_ps( d.k1 ) );
+        numerator = _mm256_add_ps( one, _mm256_mul_ps( numerator, r2 ) );
+        __m256 denominator = _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( d.k6 ), r2 ), _mm256_set1_ps( d.k5 ) );
+        denominator = _mm256_add_ps( _mm256_mul_ps( denominator, r2 ), _mm256_set1_ps( d.k4 ) );
+        denominator = _mm256_add_ps( one, _mm256_mul_ps( denominator, r2 ) );
+        const __m256 radial = _mm256_div_ps( numerator, denominator );
+
+        const __m256 p1 = _mm256_set1_ps( d.p1 );
+        const __m256 p2 = _mm256_set1_ps( d.p2 );
+        const __m256 dx = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( x, radial ), _mm256_mul_ps( _mm256_mul_ps( two, p1 ), xy ) ), _mm256_mul_ps( p2, _mm256_add_ps( r2, _mm256_mul_ps( two, xx ) ) ) );
+        const __m256 dy = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( y, radial ), _mm256_mul_ps( p1, _mm256_add_ps( r2, _mm256_mul_ps( two, yy ) ) ) ), _mm256_mul_ps( _mm256_mul_ps( two, p2 ), xy ) );
+        x = dx;
+        y = dy;
+    }
+
+    // Project Row (AVX2, 8 pixels per iteration, returns number of projected pixels)
+    COLOR_KERNEL_TARGET( "avx2" )
+    static int32_t project_row_avx2( const projection& p, const uint16_t* src, const float* rx, const float* ry, const float* rz, const int32_t width, row_scratch& dst )
+    {
+        const __m256 hx = _mm256_set1_ps( p.hx ), hy = _mm256_set1_ps( p.hy ), hz = _mm256_set1_ps( p.hz );
+        const __m256 tx = _mm256_set1_ps( p.tx ), ty = _mm256_set1_ps( p.ty ), tz = _mm256_set1_ps( p.tz );
+        const __m256 fx = _mm256_set1_ps( p.fx ), fy = _mm256_set1_ps( p.fy ), cx = _mm256_set1_ps( p.cx ), cy = _mm256_set1_ps( p.cy );
+        const __m256 one = _mm256_set1_ps( 1.0f );
+
+        int32_t x = 0;
+        for( ; x + 8 <= width; x += 8 ){
+            const __m256 z = _mm256_cvtepi32_ps( _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) ) ) );
+            const __m256 ray_x = _mm256_loadu_ps( rx + x );
+            const __m256 ray_y = _mm256_loadu_ps( ry + x );
+            const __m256 ray_z = _mm256_loadu_ps( rz + x );
+
+            const __m256 x0 = _mm256_add_ps( _mm256_mul_ps( z, _mm256_sub_ps( ray_x, hx ) ), tx );
+            const __m256 y0 = _mm256_add_ps( _mm256_mul_ps( z, _mm256_sub_ps( ray_y, hy ) ), ty );
+            const __m256 z0 = _mm256_add_ps( _mm256_mul_ps( z, _mm256_sub_ps( ray_z, hz ) ), tz );
+            const __m256 x1 = _mm256_add_ps( _mm256_mul_ps( z, _mm256_add_ps( ray_x, hx ) ), tx );
+            const __m256 y1 = _mm256_add_ps( _mm256_mul_ps( z, _mm256_add_ps( ray_y, hy ) ), ty );
+            const __m256 z1 = _mm256_add_ps( _mm256_mul_ps( z, _mm256_add_ps( ray_z, hz ) ), tz );
+
+            const __m256 inverse0 = _mm256_div_ps( one, _mm256_max_ps( z0, one ) );
+            const __m256 inverse1 = _mm256_div_ps( one, _mm256_max_ps( z1, one ) );
+            __m256 nx0 = _mm256_mul_ps( x0, inverse0 ), ny0 = _mm256_mul_ps( y0, inverse0 );
+            __m256 nx1 = _mm256_mul_ps( x1, inverse1 ), ny1 = _mm256_mul_ps( y1, inverse1 );
+            if( p.is_distorted ){
+                distort_avx2( p.color_distortion, nx0, ny0 );
+                distort_avx2( p.color_distortion, nx1, ny1 );
+            }
+            _mm256_storeu_ps( dst.u0.data() + x, _mm256_add_ps( _mm256_mul_ps( fx, nx0 ), cx ) );
+            _mm256_storeu_ps( dst.v0.data() + x, _mm256_add_ps( _mm256_mul_ps( fy, ny0 ), cy ) );
+            _mm256_storeu_ps( dst.u1.data() + x, _mm256_add_ps( _mm256_mul_ps( fx, nx1 ), cx ) );
+            _mm256_storeu_ps( dst.v1.data() + x, _mm256_add_ps( _mm256_mul_ps( fy, ny1 ), cy ) );
+            _mm256_storeu_ps( dst.zc.data() + x, _mm256_add_ps( _mm256_mul_ps( z, ray_z ), tz ) );
+        }
+        return x;
+    }
+    #endif
+
+    // Distort Normalized Point (Brown-Conrady)
+    static void distort( const distortion& d, float& x, float& y )
+    {
+        const float xx = x * x;
+        const float yy = y * y;
+        const float xy = x * y;
+        const float r2 = xx + yy;
+        const float radial = ( 1.0f + ( ( d.k3 * r2 + d.k2 ) * r2 + d.k1 ) * r2 ) / ( 1.0f + ( ( d.k6 * r2 + d.k5 ) * r2 + d.k4 ) * r2 );
+        const float dx = x * radial + 2.0f * d.p1 * xy + d.p2 * ( r2 + 2.0f * xx );
+        const float dy = y * radial + d.p1 * ( r2 + 2.0f * yy ) + 2.0f * d.p2 * xy;
+        x = dx;
+        y = dy;
+    }
+
+    // Undistort Normalized Point (fixed-point iteration, same as cv::undistortPoints)
+    static void undistort( const distortion& d, float& x, float& y )
+    {
+        constexpr int32_t iterations = 20;
+        const float xd = x;
+        const float yd = y;
+        for( int32_t i = 0; i < iterations; i++ ){
+            const float r2 = x * x + y * y;
+            const float inverse = ( 1.0f + ( ( d.k6 * r2 + d.k5 ) * r2 + d.k4 ) * r2 ) / ( 1.0f + ( ( d.k3 * r2 + d.k2 ) * r2 + d.k1 ) * r2 );
+            const float dx = 2.0f * d.p1 * x * y + d.p2 * ( r2 + 2.0f * x * x );
+            const float dy = d.p1 * ( r2 + 2.0f * y * y ) + 2.0f * d.p2 * x * y;
+            x = ( xd - dx ) * inverse;
+            y = ( yd - dy ) * inverse;
+        }
+    }
+
+    // Distortion is Zero (pinhole)
+    static bool is_zero( const distortion& d )
+    {
+        return d.k1 == 0.0f && d.k2 == 0.0f && d.k3 == 0.0f && d.k4 == 0.0f && d.k5 == 0.0f && d.k6 == 0.0f && d.p1 == 0.0f && d.p2 == 0.0f;
+    }
+
+    // Get Range of Pixel Centers Covered by Footprint [begin, end] (false if outside of image)
+    static bool get_footprint( float p0, float p1, const int32_t size, int32_t& begin, int32_t& end )
+    {
+        if( p1 < p0 ){
+            std::swap( p0, p1 );
+        }
+        if( !( p1 >= 0.0f && p0 < static_cast<float>( size ) ) ){
+            return false; // outside (or NaN)
+        }
+
+        begin = static_cast<int32_t>( std::ceil( p0 ) );
+        end = static_cast<int32_t>( std::ceil( p1 ) ) - 1;
+        if( end < begin ){
+            // Footprint smaller than pixel of color (downsampling), take nearest pixel
+            begin = end = static_cast<int32_t>( std::floor( ( p0 + p1 ) * 0.5f + 0.5f ) );
+        }
+        begin = std::max( begin, 0 );
+        end = std::min( end, size - 1 );
+        return begin <= end;
+    }
+
+    // Store Minimum Depth
+    static void store_min( std::atomic<uint16_t>& target, const uint16_t value )
+    {
+        uint16_t current = target.load( std::memory_order_relaxed );
+        while( value < current && !target.compare_exchange_weak( current, value, std::memory_order_relaxed ) ){
+        }
+    }
+
+    // Scale Intrinsic to Image Size (e.g. intrinsic of full resolution for binned depth mode)
+    static intrinsic scale( const intrinsic& source, const cv::Size& size )
+    {
+        if( source.width <= 0 || source.height <= 0 || ( source.width == size.width && source.height == size.height ) ){
+            return source;
+        }
+
+        const float sx = static_cast<float>( size.width ) / source.width;
+        const float sy = static_cast<float>( size.height ) / source.height;
+        return { source.fx * sx, source.fy * sy, ( source.cx + 0.5f ) * sx - 0.5f, ( source.cy + 0.5f ) * sy - 0.5f, size.width, size.height };
+    }
+
+    // Convert Intrinsic of SDK
+    static intrinsic to_intrinsic( const OBCameraIntrinsic& source )
+    {
+        return { source.fx, source.fy, source.cx, source.cy, source.width, source.height };
+    }
+
+    // Convert Distortion of SDK
+    static distortion to_distortion( const OBCameraDistortion& source )
+    {
+        return { source.k1, source.k2, source.k3, source.k4, source.k5, source.k6, source.p1, source.p2 };
+    }
+};
+
+#endif // __ALIGN__
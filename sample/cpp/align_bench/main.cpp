@@ -0,0 +1,350 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+#include "align.h"
+
+// Depth Mode
+struct depth_mode
+{
+    std::string name;
+    software_align::intrinsic intrinsic;
+    software_align::distortion depth_distortion;
+    software_align::distortion color_distortion;
+};
+
+// Benchmark Result
+struct bench_result
+{
+    std::string name;
+    uint32_t depth_width;
+    uint32_t depth_height;
+    std::string isa;
+    double d2c_ms;
+    double c2d_ms;
+    double d2c_ms_scalar;
+    double c2d_ms_scalar;
+    double isa_match; // ratio of pixels of D2C and C2D same as scalar kernel
+    double d2c_match; // ratio of pixels matched with reference (valid in both)
+    double d2c_coverage; // ratio of reference pixels filled by alignment
+    double c2d_match; // ratio of depth pixels that sampled color of same surface
+};
+
+// Synthetic Scene
+// Fronto-parallel rectangles in depth camera coordinates [mm], and infinite background wall.
+struct scene_plane
+{
+    float z;
+    float left;
+    float top;
+    float right;
+    float bottom;
+    cv::Vec4b color;
+};
+
+const std::vector<scene_plane> scene = {
+    {  800.0f,  250.0f, -100.0f,  450.0f, 100.0f, cv::Vec4b( 255,   0,   0, 255 ) },
+    { 1200.0f, -300.0f, -200.0f,  200.0f, 250.0f, cv::Vec4b(   0, 255,   0, 255 ) },
+    { 2500.0f, -1e6f,   -1e6f,    1e6f,   1e6f,   cv::Vec4b(   0,   0, 255, 255 ) }
+};
+
+// Extrinsic of Depth to Color (0.5 degree yaw, 32 mm baseline)
+const float yaw = 0.5f * static_cast<float>( CV_PI ) / 180.0f;
+const float rotation[9] = { std::cos( yaw ), 0.0f, std::sin( yaw ), 0.0f, 1.0f, 0.0f, -std::sin( yaw ), 0.0f, std::cos( yaw ) };
+const float translation[3] = { -32.0f, -1.5f, 1.0f };
+
+// Get Ray of Pixel (z = 1) through Lens Distortion
+// Distortion is inverted in double precision until it converges, independent of single precision table of software_align.
+void get_ray( const software_align::intrinsic& intrinsic, const software_align::distortion& d, const int32_t u, const int32_t v, float& rx, float& ry )
+{
+    const double xd = ( u - intrinsic.cx ) / static_cast<double>( intrinsic.fx );
+    const double yd = ( v - intrinsic.cy ) / static_cast<double>( intrinsic.fy );
+    double x = xd, y = yd;
+    for( int32_t i = 0; i < 100; i++ ){
+        const double r2 = x * x + y * y;
+        const double radial = ( 1.0 + ( ( d.k3 * r2 + d.k2 ) * r2 + d.k1 ) * r2 ) / ( 1.0 + ( ( d.k6 * r2 + d.k5 ) * r2 + d.k4 ) * r2 );
+        const double dx = 2.0 * d.p1 * x * y + d.p2 * ( r2 + 2.0 * x * x );
+        const double dy = d.p1 * ( r2 + 2.0 * y * y ) + 2.0 * d.p2 * x * y;
+        const double next_x = ( xd - dx ) / radial;
+        const double next_y = ( yd - dy ) / radial;
+        const bool is_converged = std::abs( next_x - x ) < 1e-12 && std::abs( next_y - y ) < 1e-12;
+        x = next_x;
+        y = next_y;
+        if( is_converged ){
+            break;
+        }
+    }
+    rx = static_cast<float>( x );
+    ry = static_cast<float>( y );
+}
+
+// Render Depth of Scene from Depth Camera
+cv::Mat render_depth( const software_align::intrinsic& intrinsic, const software_align::distortion& distortion, cv::Mat& surface )
+{
+    cv::Mat depth = cv::Mat::zeros( intrinsic.height, intrinsic.width, CV_16UC1 );
+    surface = cv::Mat::zeros( intrinsic.height, intrinsic.width, CV_8UC4 );
+    for( int32_t y = 0; y < intrinsic.height; y++ ){
+        for( int32_t x = 0; x < intrinsic.width; x++ ){
+            float nx = 0.0f, ny = 0.0f;
+            get_ray( intrinsic, distortion, x, y, nx, ny );
+            for( const scene_plane& plane : scene ){ // sorted by z
+                const float px = plane.z * nx;
+                const float py = plane.z * ny;
+                if( plane.left <= px && px <= plane.right && plane.top <= py && py <= plane.bottom ){
+                    depth.at<uint16_t>( y, x ) = static_cast<uint16_t>( plane.z );
+                    surface.at<cv::Vec4b>( y, x ) = plane.color;
+                    break;
+                }
+            }
+        }
+    }
+    return depth;
+}
+
+// Render Reference of Scene from Color Camera (ray casting)
+// depth is z in color camera [mm], color is surface color.
+void render_reference( const software_align::intrinsic& intrinsic, const software_align::distortion& distortion, cv::Mat& depth, cv::Mat& color )
+{
+    depth = cv::Mat::zeros( intrinsic.height, intrinsic.width, CV_16UC1 );
+    color = cv::Mat::zeros( intrinsic.height, intrinsic.width, CV_8UC4 );
+
+    // Origin of Color Camera in Depth Camera Coordinates ( -R^T t )
+    const float origin[3] = {
+        -( rotation[0] * translation[0] + rotation[3] * translation[1] + rotation[6] * translation[2] ),
+        -( rotation[1] * translation[0] + rotation[4] * translation[1] + rotation[7] * translation[2] ),
+        -( rotation[2] * translation[0] + rotation[5] * translation[1] + rotation[8] * translation[2] )
+    };
+
+    for( int32_t v = 0; v < intrinsic.height; v++ ){
+        for( int32_t u = 0; u < intrinsic.width; u++ ){
+            // Ray of Color Pixel in Depth Camera Coordinates ( R^T r )
+            float rx = 0.0f, ry = 0.0f;
+            get_ray( intrinsic, distortion, u, v, rx, ry );
+            const float direction[3] = {
+                rotation[0] * rx + rotation[3] * ry + rotation[6],
+                rotation[1] * rx + rotation[4] * ry + rotation[7],
+                rotation[2] * rx + rotation[5] * ry + rotation[8]
+            };
+
+            // Nearest Intersection (ray parameter is z in color camera because z of ray is 1)
+            float nearest = 0.0f;
+            for( const scene_plane& plane : scene ){
+                const float s = ( plane.z - origin[2] ) / direction[2];
+                const float px = origin[0] + s * direction[0];
+                const float py = origin[1] + s * direction[1];
+                if( s > 0.0f && ( nearest == 0.0f || s < nearest ) && plane.left <= px && px <= plane.right && plane.top <= py && py <= plane.bottom ){
+                    nearest = s;
+                    color.at<cv::Vec4b>( v, u ) = plane.color;
+                }
+            }
+            depth.at<uint16_t>( v, u ) = static_cast<uint16_t>( nearest + 0.5f );
+        }
+    }
+}
+
+// Measure Average Time of Function [ms]
+template<typename Function>
+double measure( Function function )
+{
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 500 );
+    function(); // warm up (ray table, buffers)
+
+    uint64_t iterations = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = start;
+    while( end - start < duration ){
+        function();
+        iterations++;
+        end = std::chrono::steady_clock::now();
+    }
+    return std::chrono::duration<double, std::milli>( end - start ).count() / iterations;
+}
+
+// To String
+std::string to_string( const color_kernel::isa isa )
+{
+    switch( isa ){
+        case color_kernel::isa::scalar:
+            return "scalar";
+        case color_kernel::isa::sse4_1:
+            return "sse4.1";
+        case color_kernel::isa::avx2:
+            return "avx2";
+        case color_kernel::isa::neon:
+            return "neon";
+        default:
+            return "unknown";
+    }
+}
+
+// Ratio of Same Pixels
+double get_same_ratio( const cv::Mat& a, const cv::Mat& b )
+{
+    const size_t row_size = a.cols * a.elemSize();
+    uint64_t same = 0;
+    for( int32_t y = 0; y < a.rows; y++ ){
+        const uint8_t* pa = a.ptr<uint8_t>( y );
+        const uint8_t* pb = b.ptr<uint8_t>( y );
+        for( size_t i = 0; i < row_size; i += a.elemSize() ){
+            same += ( std::memcmp( pa + i, pb + i, a.elemSize() ) == 0 );
+        }
+    }
+    return static_cast<double>( same ) / ( static_cast<double>( a.rows ) * a.cols );
+}
+
+// Run Benchmark of Depth Mode
+bench_result run( const depth_mode& mode, const software_align::intrinsic& color_intrinsic )
+{
+    software_align aligner( mode.intrinsic, color_intrinsic, rotation, translation, mode.depth_distortion, mode.color_distortion );
+
+    // Synthetic Scene
+    cv::Mat surface;
+    const cv::Mat depth = render_depth( mode.intrinsic, mode.depth_distortion, surface );
+    cv::Mat reference_depth, reference_color;
+    render_reference( color_intrinsic, mode.color_distortion, reference_depth, reference_color );
+    const cv::Size color_size( color_intrinsic.width, color_intrinsic.height );
+
+    bench_result result;
+    result.name = mode.name;
+    result.isa = to_string( aligner.get_isa() );
+    result.depth_width = depth.cols;
+    result.depth_height = depth.rows;
+
+    // Validate D2C
+    cv::Mat aligned_depth;
+    aligner.align_depth_to_color( depth, color_size, aligned_depth );
+    uint64_t reference_pixels = 0, valid_pixels = 0, matched_pixels = 0;
+    for( int32_t v = 0; v < aligned_depth.rows; v++ ){
+        for( int32_t u = 0; u < aligned_depth.cols; u++ ){
+            const uint16_t expected = reference_depth.at<uint16_t>( v, u );
+            const uint16_t actual = aligned_depth.at<uint16_t>( v, u );
+            reference_pixels += ( expected != 0 );
+            if( expected == 0 || actual == 0 ){
+                continue;
+            }
+            valid_pixels++;
+            matched_pixels += ( std::abs( static_cast<int32_t>( expected ) - static_cast<int32_t>( actual ) ) <= std::max( 2, expected / 200 ) );
+        }
+    }
+    result.d2c_match = valid_pixels != 0 ? static_cast<double>( matched_pixels ) / valid_pixels : 0.0;
+    result.d2c_coverage = reference_pixels != 0 ? static_cast<double>( valid_pixels ) / reference_pixels : 0.0;
+
+    // Validate C2D
+    cv::Mat aligned_color;
+    aligner.align_color_to_depth( depth, reference_color, aligned_color );
+    uint64_t sampled_pixels = 0, matched_colors = 0;
+    for( int32_t y = 0; y < aligned_color.rows; y++ ){
+        for( int32_t x = 0; x < aligned_color.cols; x++ ){
+            const cv::Vec4b sampled = aligned_color.at<cv::Vec4b>( y, x );
+            if( sampled[3] == 0 ){
+                continue; // outside of color image
+            }
+            sampled_pixels++;
+            matched_colors += ( sampled == surface.at<cv::Vec4b>( y, x ) );
+        }
+    }
+    result.c2d_match = sampled_pixels != 0 ? static_cast<double>( matched_colors ) / sampled_pixels : 0.0;
+
+    // Only silhouette edges of scene may differ (projection without lens distortion matches about 99.3% of D2C)
+    constexpr double d2c_threshold = 0.995;
+    constexpr double c2d_threshold = 0.97;
+    if( result.d2c_match < d2c_threshold || result.c2d_match < c2d_threshold ){
+        throw std::runtime_error( "[error] aligned result does not match reference! (" + mode.name + ")" );
+    }
+
+    // Measure
+    result.d2c_ms = measure( [&](){ aligner.align_depth_to_color( depth, color_size, aligned_depth ); } );
+    result.c2d_ms = measure( [&](){ aligner.align_color_to_depth( depth, reference_color, aligned_color ); } );
+
+    // Scalar Kernel (same result except rounding of contracted multiply-add, which may move edge of footprint)
+    const color_kernel::isa best = aligner.get_isa();
+    aligner.set_isa( color_kernel::isa::scalar );
+    cv::Mat scalar_depth, scalar_color;
+    aligner.align_depth_to_color( depth, color_size, scalar_depth );
+    aligner.align_color_to_depth( depth, reference_color, scalar_color );
+    result.isa_match = std::min( get_same_ratio( aligned_depth, scalar_depth ), get_same_ratio( aligned_color, scalar_color ) );
+    if( result.isa_match < 0.999 ){
+        throw std::runtime_error( "[error] result of " + result.isa + " kernel does not match scalar kernel! (" + mode.name + ")" );
+    }
+    result.d2c_ms_scalar = measure( [&](){ aligner.align_depth_to_color( depth, color_size, scalar_depth ); } );
+    result.c2d_ms_scalar = measure( [&](){ aligner.align_color_to_depth( depth, reference_color, scalar_color ); } );
+    aligner.set_isa( best );
+    return result;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"threads\": " << cv::getNumThreads() << ",\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"depth_width\": " << result.depth_width << ", ";
+        stream << "\"depth_height\": " << result.depth_height << ", ";
+        stream << "\"isa\": \"" << result.isa << "\", ";
+        stream << "\"d2c_ms\": " << result.d2c_ms << ", ";
+        stream << "\"c2d_ms\": " << result.c2d_ms << ", ";
+        stream << "\"d2c_ms_scalar\": " << result.d2c_ms_scalar << ", ";
+        stream << "\"c2d_ms_scalar\": " << result.c2d_ms_scalar << ", ";
+        stream << "\"isa_match\": " << result.isa_match << ", ";
+        stream << "\"d2c_match\": " << result.d2c_match << ", ";
+        stream << "\"d2c_coverage\": " << result.d2c_coverage << ", ";
+        stream << "\"c2d_match\": " << result.c2d_match;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        // Depth Modes (typical intrinsics of NFOV/WFOV, binned and unbinned, and with lens distortion of depth and color)
+        const software_align::distortion pinhole = {};
+        const software_align::distortion depth_distortion = { 0.08f, -0.03f, 0.005f, 0.0f, 0.0f, 0.0f, 0.0008f, -0.0004f };
+        const software_align::distortion color_distortion = { -0.06f, 0.02f, 0.0f, 0.0f, 0.0f, 0.0f, -0.0005f, 0.0003f };
+        const std::vector<depth_mode> modes = {
+            { "nfov_binned",     { 252.0f, 252.0f, 160.0f, 144.0f,  320,  288 }, pinhole, pinhole },
+            { "nfov_unbinned",   { 504.0f, 504.0f, 320.0f, 288.0f,  640,  576 }, pinhole, pinhole },
+            { "wfov_binned",     { 252.0f, 252.0f, 256.0f, 256.0f,  512,  512 }, pinhole, pinhole },
+            { "wfov_unbinned",   { 504.0f, 504.0f, 512.0f, 512.0f, 1024, 1024 }, pinhole, pinhole },
+            { "nfov_distortion", { 504.0f, 504.0f, 320.0f, 288.0f,  640,  576 }, depth_distortion, color_distortion }
+        };
+        const software_align::intrinsic color_intrinsic = { 605.0f, 605.0f, 640.0f, 360.0f, 1280, 720 };
+
+        std::vector<bench_result> results;
+        for( const depth_mode& mode : modes ){
+            results.push_back( run( mode, color_intrinsic ) );
+            const bench_result& result = results.back();
+            std::cerr << result.name << " : d2c " << result.d2c_ms << " ms, c2d " << result.c2d_ms << " ms (" << result.isa << "), d2c " << result.d2c_ms_scalar << " ms, c2d " << result.c2d_ms_scalar << " ms (scalar)"
+                      << " (match d2c " << result.d2c_match << ", c2d " << result.c2d_match << ", coverage " << result.d2c_coverage << ")" << std::endl;
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,570 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cmath>
+#include <thread>
+#include <memory>
+#include <algorithm>
+
+#include "frame_source.h"
+#include "chunk_file.h"
+#include "frame_prefetcher.h"
+#include "record_writer.h"
+
+// Benchmark Result
+struct bench_result
+{
+    std::string name;
+    uint64_t framesets;
+    uint64_t bytes;
+    double ns_per_frameset;
+    double mb_per_second;
+};
+
+// Codec Result
+struct codec_result
+{
+    std::string name;
+    uint64_t frames;
+    uint64_t raw_bytes;
+    uint64_t encoded_bytes;
+    double ratio;
+    double encode_mb_per_second;
+    double decode_mb_per_second;
+};
+
+// Frame Pacing Result
+struct pacing_result
+{
+    std::string name;
+    uint64_t frames;
+    double mean_interval_ms;
+    double max_interval_ms;
+    double jitter_ms; // standard deviation of interval
+    uint64_t late_frames; // interval exceeded 1.5 frame periods
+    uint64_t hits;
+    uint64_t misses;
+};
+
+// Writer Backpressure Result
+struct writer_result
+{
+    std::string policy;
+    uint32_t write_delay; // [ms] per batch
+    double write_fps; // throughput of simulated disk
+    double capture_fps;
+    uint64_t pushed;
+    uint64_t written;
+    uint64_t dropped;
+};
+
+// Hash of Data (FNV-1a) for Verification
+uint64_t get_hash( const void* data, const uint64_t size )
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>( data );
+    uint64_t hash = 14695981039346656037ull;
+    for( uint64_t i = 0; i < size; i++ ){
+        hash = ( hash ^ bytes[i] ) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Create Result
+bench_result create_result( const std::string& name, const uint64_t framesets, const uint64_t bytes, const std::chrono::steady_clock::duration duration )
+{
+    const double elapsed = std::chrono::duration<double, std::nano>( duration ).count();
+    bench_result result;
+    result.name = name;
+    result.framesets = framesets;
+    result.bytes = bytes;
+    result.ns_per_frameset = framesets != 0 ? elapsed / framesets : 0.0;
+    result.mb_per_second = elapsed > 0.0 ? ( bytes / ( 1024.0 * 1024.0 ) ) / ( elapsed * 1e-9 ) : 0.0;
+    return result;
+}
+
+// Read Frame Set and Verify Data
+uint64_t read_frameset( const chunk_reader& reader, const size_t index, const std::vector<std::vector<uint64_t>>& hashes, std::vector<chunk::frame>& frames )
+{
+    reader.read( index, frames );
+    if( frames.size() != hashes[index].size() ){
+        throw std::runtime_error( "[error] number of frames does not match!" );
+    }
+
+    uint64_t bytes = 0;
+    for( size_t i = 0; i < frames.size(); i++ ){
+        if( get_hash( frames[i].data, frames[i].header->data_size ) != hashes[index][i] ){
+            throw std::runtime_error( "[error] data of frame does not match!" );
+        }
+        bytes += frames[i].header->data_size;
+    }
+    return bytes;
+}
+
+// Run Depth Codec Benchmark
+codec_result run_codec( const std::string& name, const std::vector<cv::Mat>& depths )
+{
+    codec_result result;
+    result.name = name;
+    result.frames = depths.size();
+    result.raw_bytes = 0;
+    result.encoded_bytes = 0;
+
+    // Encode All Frames and Verify Round Trip (lossless)
+    std::vector<std::vector<uint8_t>> encoded_frames( depths.size() );
+    cv::Mat decoded;
+    for( size_t i = 0; i < depths.size(); i++ ){
+        rvl::encode( depths[i], encoded_frames[i] );
+        rvl::decode( encoded_frames[i].data(), encoded_frames[i].size(), decoded );
+        if( cv::norm( depths[i], decoded, cv::NORM_INF ) != 0.0 ){
+            throw std::runtime_error( "[error] decoded depth does not match!" );
+        }
+        result.raw_bytes += depths[i].total() * depths[i].elemSize();
+        result.encoded_bytes += encoded_frames[i].size();
+    }
+    result.ratio = result.encoded_bytes != 0 ? static_cast<double>( result.raw_bytes ) / result.encoded_bytes : 0.0;
+
+    // Measure Encode and Decode (throughput of raw depth)
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 500 );
+    std::vector<uint8_t> encoded;
+    for( const bool is_encode : { true, false } ){
+        uint64_t iterations = 0;
+        uint64_t bytes = 0;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point end = start;
+        while( end - start < duration ){
+            const size_t i = iterations % depths.size();
+            if( is_encode ){
+                rvl::encode( depths[i], encoded );
+            }
+            else{
+                rvl::decode( encoded_frames[i].data(), encoded_frames[i].size(), decoded );
+            }
+            bytes += depths[i].total() * depths[i].elemSize();
+            iterations++;
+            end = std::chrono::steady_clock::now();
+        }
+
+        const double mb_per_second = ( bytes / ( 1024.0 * 1024.0 ) ) / std::chrono::duration<double>( end - start ).count();
+        ( is_encode ? result.encode_mb_per_second : result.decode_mb_per_second ) = mb_per_second;
+    }
+
+    return result;
+}
+
+// Read Frame Set from Slow Storage and Decode
+// Storage is simulated with latency of 4 ms per frame set and spike of 60 ms every 15 frame sets.
+void read_slow( const chunk_reader& reader, const size_t index, std::vector<chunk::frame>& frames, prefetched_frameset& dst )
+{
+    constexpr std::chrono::milliseconds latency = std::chrono::milliseconds( 4 );
+    constexpr std::chrono::milliseconds spike = std::chrono::milliseconds( 60 );
+    constexpr size_t spike_interval = 15;
+    std::this_thread::sleep_for( ( index % spike_interval == spike_interval - 1 ) ? spike : latency );
+
+    reader.read( index, frames );
+    dst.timestamp = reader.timestamp( index );
+    for( const chunk::frame& frame : frames ){
+        const chunk::frame_header* header = frame.header;
+        if( header->frame_type == OBFrameType::OB_FRAME_COLOR ){
+            cv::Mat( header->height, header->width, CV_8UC2, const_cast<uint8_t*>( frame.data ) ).copyTo( dst.color );
+        }
+        else if( header->compression == static_cast<uint32_t>( chunk::compression::rvl ) ){
+            rvl::decode( frame.data, header->data_size, dst.depth );
+        }
+        else{
+            cv::Mat( header->height, header->width, CV_16UC1, const_cast<uint8_t*>( frame.data ) ).copyTo( dst.depth );
+        }
+    }
+}
+
+// Run Frame Pacing Benchmark
+// Frame sets are consumed at display rate, and intervals between frame sets becoming available are measured.
+pacing_result run_pacing( const std::string& name, const chunk_reader& reader, const bool use_prefetch )
+{
+    constexpr size_t frames = 120;
+    constexpr std::chrono::duration<double, std::milli> period = std::chrono::duration<double, std::milli>( 1000.0 / 60.0 );
+
+    std::vector<chunk::frame> chunk_frames;
+    std::unique_ptr<frame_prefetcher> prefetcher = nullptr;
+    if( use_prefetch ){
+        prefetcher = std::make_unique<frame_prefetcher>( [&]( const size_t index, prefetched_frameset& dst ){ read_slow( reader, index, chunk_frames, dst ); }, reader.size() );
+    }
+
+    prefetched_frameset frameset;
+    std::vector<double> intervals;
+    intervals.reserve( frames );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point previous = start;
+    for( size_t i = 0; i < std::min( frames, reader.size() ); i++ ){
+        // Wait until Display Timing
+        std::this_thread::sleep_until( start + std::chrono::duration_cast<std::chrono::steady_clock::duration>( period * static_cast<double>( i ) ) );
+
+        if( prefetcher != nullptr ){
+            if( !prefetcher->get( i, frameset ) ){
+                throw std::runtime_error( "[error] failed to get prefetched frame set!" );
+            }
+        }
+        else{
+            read_slow( reader, i, chunk_frames, frameset );
+        }
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if( i != 0 ){
+            intervals.push_back( std::chrono::duration<double, std::milli>( now - previous ).count() );
+        }
+        previous = now;
+    }
+
+    pacing_result result;
+    result.name = name;
+    result.frames = intervals.size() + 1;
+    result.hits = prefetcher != nullptr ? prefetcher->hit_count() : 0;
+    result.misses = prefetcher != nullptr ? prefetcher->miss_count() : 0;
+
+    double sum = 0.0;
+    double square_sum = 0.0;
+    result.max_interval_ms = 0.0;
+    result.late_frames = 0;
+    for( const double interval : intervals ){
+        sum += interval;
+        square_sum += interval * interval;
+        result.max_interval_ms = std::max( result.max_interval_ms, interval );
+        if( interval > period.count() * 1.5 ){
+            result.late_frames++;
+        }
+    }
+    result.mean_interval_ms = !intervals.empty() ? sum / intervals.size() : 0.0;
+    result.jitter_ms = !intervals.empty() ? std::sqrt( std::max( square_sum / intervals.size() - result.mean_interval_ms * result.mean_interval_ms, 0.0 ) ) : 0.0;
+    return result;
+}
+
+// To String
+std::string to_string( const record_writer::backpressure policy )
+{
+    switch( policy ){
+        case record_writer::backpressure::block:
+            return "block";
+        case record_writer::backpressure::drop_oldest:
+            return "drop_oldest";
+        case record_writer::backpressure::drop_newest:
+            return "drop_newest";
+        default:
+            return "unknown";
+    }
+}
+
+// Run Writer Backpressure Benchmark
+// Frame sets are captured at device rate and pushed to record_writer, and slow disk is simulated by delaying each batch.
+// block must not lose frame sets (capture stalls if disk is slower than device), drop policies must keep capture rate.
+writer_result run_writer( const record_writer::backpressure policy, const uint32_t write_delay )
+{
+    constexpr uint32_t fps = 30;
+    constexpr size_t capacity = 16;
+    constexpr size_t batch_size = 4;
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 3000 );
+
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_YUYV, 1280, 720 };
+    mock_source source = mock_source( color_stream, mock_source::stream(), mock_source::stream(), fps );
+
+    record_writer writer( [&]( const std::vector<std::shared_ptr<ob::FrameSet>>& batch ){
+        std::this_thread::sleep_for( std::chrono::milliseconds( write_delay ) );
+    }, capacity, batch_size, policy );
+
+    // Capture Loop (same as record sample)
+    uint64_t captured = 0;
+    source.start();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while( std::chrono::steady_clock::now() - start < duration ){
+        constexpr uint32_t timeout = 100;
+        std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+        if( frameset == nullptr ){
+            continue;
+        }
+        captured++;
+        writer.push( frameset );
+    }
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    source.stop();
+    writer.stop(); // write remaining frame sets
+
+    writer_result result;
+    result.policy = to_string( policy );
+    result.write_delay = write_delay;
+    result.write_fps = write_delay > 0 ? batch_size * 1000.0 / write_delay : 0.0;
+    result.capture_fps = captured / elapsed;
+    result.pushed = writer.num_pushed();
+    result.written = writer.num_written();
+    result.dropped = writer.num_dropped();
+
+    // Check Counts and Capture Rate
+    const std::string name = result.policy + " (write delay " + std::to_string( write_delay ) + " ms)";
+    if( result.pushed != captured || result.written + result.dropped != result.pushed || writer.num_failed() != 0 ){
+        throw std::runtime_error( "[error] frame sets are not accounted for by writer, " + name + "!" );
+    }
+    const bool is_slow_disk = write_delay > 0 && result.write_fps < fps;
+    if( policy == record_writer::backpressure::block ){
+        if( result.dropped != 0 ){
+            throw std::runtime_error( "[error] writer dropped frame sets with block policy, " + name + "!" );
+        }
+        if( is_slow_disk && result.capture_fps > fps * 0.9 ){
+            throw std::runtime_error( "[error] capture did not stall on slow disk with block policy, " + name + "!" );
+        }
+    }
+    else{
+        if( result.capture_fps < fps * 0.9 ){
+            throw std::runtime_error( "[error] capture rate dropped to " + std::to_string( result.capture_fps ) + " fps, " + name + "!" );
+        }
+        if( is_slow_disk && result.dropped == 0 ){
+            throw std::runtime_error( "[error] writer did not drop frame sets on slow disk, " + name + "!" );
+        }
+    }
+    return result;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results, const std::vector<codec_result>& codec_results, const std::vector<pacing_result>& pacing_results, const std::vector<writer_result>& writer_results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"framesets\": " << result.framesets << ", ";
+        stream << "\"bytes\": " << result.bytes << ", ";
+        stream << "\"ns_per_frameset\": " << result.ns_per_frameset << ", ";
+        stream << "\"mb_per_second\": " << result.mb_per_second;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ],\n";
+    stream << "  \"codec\": [\n";
+    for( size_t i = 0; i < codec_results.size(); i++ ){
+        const codec_result& result = codec_results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"threads\": " << cv::getNumThreads() << ", ";
+        stream << "\"frames\": " << result.frames << ", ";
+        stream << "\"raw_bytes\": " << result.raw_bytes << ", ";
+        stream << "\"encoded_bytes\": " << result.encoded_bytes << ", ";
+        stream << "\"ratio\": " << result.ratio << ", ";
+        stream << "\"encode_mb_per_second\": " << result.encode_mb_per_second << ", ";
+        stream << "\"decode_mb_per_second\": " << result.decode_mb_per_second;
+        stream << " }" << ( i + 1 < codec_results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ],\n";
+    stream << "  \"pacing\": [\n";
+    for( size_t i = 0; i < pacing_results.size(); i++ ){
+        const pacing_result& result = pacing_results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"frames\": " << result.frames << ", ";
+        stream << "\"mean_interval_ms\": " << result.mean_interval_ms << ", ";
+        stream << "\"max_interval_ms\": " << result.max_interval_ms << ", ";
+        stream << "\"jitter_ms\": " << result.jitter_ms << ", ";
+        stream << "\"late_frames\": " << result.late_frames << ", ";
+        stream << "\"hits\": " << result.hits << ", ";
+        stream << "\"misses\": " << result.misses;
+        stream << " }" << ( i + 1 < pacing_results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ],\n";
+    stream << "  \"writer\": [\n";
+    for( size_t i = 0; i < writer_results.size(); i++ ){
+        const writer_result& result = writer_results[i];
+        stream << "    { ";
+        stream << "\"policy\": \"" << result.policy << "\", ";
+        stream << "\"write_delay_ms\": " << result.write_delay << ", ";
+        stream << "\"write_fps\": " << result.write_fps << ", ";
+        stream << "\"capture_fps\": " << result.capture_fps << ", ";
+        stream << "\"pushed\": " << result.pushed << ", ";
+        stream << "\"written\": " << result.written << ", ";
+        stream << "\"dropped\": " << result.dropped;
+        stream << " }" << ( i + 1 < writer_results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        const std::string file_name = "chunk_bench.chunk";
+        constexpr uint32_t frameset_count = 300;
+        constexpr uint32_t seek_count = 1000;
+        constexpr uint32_t fps = 1000; // timestamps advance at least 1 ms per frame set
+
+        // Synthetic Streams (color 1280x720 YUYV, depth 640x576 Y16)
+        const mock_source::stream color_stream = { OBFormat::OB_FORMAT_YUYV, 1280, 720 };
+        const mock_source::stream depth_stream = { OBFormat::OB_FORMAT_Y16, 640, 576 };
+        mock_source source = mock_source( color_stream, depth_stream, mock_source::stream(), fps );
+
+        std::vector<bench_result> results;
+        std::vector<std::vector<uint64_t>> hashes;
+        std::vector<uint64_t> timestamps;
+
+        // Write
+        {
+            chunk_writer writer( file_name );
+            std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::duration::zero();
+            uint64_t bytes = 0;
+
+            source.start();
+            while( writer.size() < frameset_count ){
+                constexpr uint32_t timeout = 100;
+                std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+                if( frameset == nullptr ){
+                    continue;
+                }
+
+                // Keep hashes in same order as frames are written (color, depth)
+                const std::shared_ptr<ob::ColorFrame> color_frame = frameset->colorFrame();
+                const std::shared_ptr<ob::DepthFrame> depth_frame = frameset->depthFrame();
+                hashes.push_back( { get_hash( color_frame->data(), color_frame->dataSize() ), get_hash( depth_frame->data(), depth_frame->dataSize() ) } );
+                timestamps.push_back( color_frame->timeStamp() );
+                bytes += color_frame->dataSize() + depth_frame->dataSize();
+
+                const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                writer.write( frameset );
+                elapsed += std::chrono::steady_clock::now() - start;
+            }
+            source.stop();
+
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            writer.close();
+            elapsed += std::chrono::steady_clock::now() - start;
+            results.push_back( create_result( "write", frameset_count, bytes, elapsed ) );
+        }
+
+        // Open (map file and load index)
+        std::vector<cv::Mat> synthetic_depths;
+        std::vector<pacing_result> pacing_results;
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            const chunk_reader reader( file_name );
+            results.push_back( create_result( "open", reader.size(), 0, std::chrono::steady_clock::now() - start ) );
+            if( reader.size() != frameset_count ){
+                throw std::runtime_error( "[error] number of frame sets does not match!" );
+            }
+
+            // Sequential Read
+            // NOTE: file was just written, so pages are likely in page cache and this measures mapped memory access.
+            std::vector<chunk::frame> frames;
+            uint64_t bytes = 0;
+            start = std::chrono::steady_clock::now();
+            for( size_t i = 0; i < reader.size(); i++ ){
+                bytes += read_frameset( reader, i, hashes, frames );
+            }
+            results.push_back( create_result( "sequential_read", reader.size(), bytes, std::chrono::steady_clock::now() - start ) );
+
+            // Random Seek by Index
+            std::mt19937 random( 0 );
+            std::uniform_int_distribution<size_t> distribution( 0, reader.size() - 1 );
+            bytes = 0;
+            start = std::chrono::steady_clock::now();
+            for( uint32_t i = 0; i < seek_count; i++ ){
+                bytes += read_frameset( reader, distribution( random ), hashes, frames );
+            }
+            results.push_back( create_result( "seek_index", seek_count, bytes, std::chrono::steady_clock::now() - start ) );
+
+            // Random Seek by Timestamp
+            bytes = 0;
+            start = std::chrono::steady_clock::now();
+            for( uint32_t i = 0; i < seek_count; i++ ){
+                const size_t expected = distribution( random );
+                const size_t index = reader.find( timestamps[expected] );
+                if( index != expected ){
+                    throw std::runtime_error( "[error] frame set found by timestamp does not match!" );
+                }
+                bytes += read_frameset( reader, index, hashes, frames );
+            }
+            results.push_back( create_result( "seek_timestamp", seek_count, bytes, std::chrono::steady_clock::now() - start ) );
+
+            // Keep Synthetic Depth for Codec Benchmark
+            for( size_t i = 0; i < reader.size() && synthetic_depths.size() < 8; i++ ){
+                reader.read( i, frames );
+                const chunk::frame_header* header = frames[1].header;
+                synthetic_depths.push_back( cv::Mat( header->height, header->width, CV_16UC1, const_cast<uint8_t*>( frames[1].data ) ).clone() );
+            }
+
+            // Frame Pacing with Slow Storage (read on display thread, and read ahead by prefetcher)
+            pacing_results.push_back( run_pacing( "direct_slow_storage", reader, false ) );
+            pacing_results.push_back( run_pacing( "prefetch_slow_storage", reader, true ) );
+        }
+
+        // Depth Codec (synthetic depth, and depth of recorded chunk file if specified)
+        std::vector<codec_result> codec_results;
+        codec_results.push_back( run_codec( "rvl_synthetic", synthetic_depths ) );
+        if( argc > 2 ){
+            const chunk_reader recorded( argv[2] );
+            std::vector<cv::Mat> recorded_depths;
+            std::vector<chunk::frame> frames;
+            for( size_t i = 0; i < recorded.size() && recorded_depths.size() < 64; i++ ){
+                recorded.read( i, frames );
+                for( const chunk::frame& frame : frames ){
+                    if( frame.header->frame_type != OBFrameType::OB_FRAME_DEPTH || frame.header->format != OBFormat::OB_FORMAT_Y16 ){
+                        continue;
+                    }
+
+                    cv::Mat depth;
+                    if( frame.header->compression == static_cast<uint32_t>( chunk::compression::rvl ) ){
+                        rvl::decode( frame.data, frame.header->data_size, depth );
+                    }
+                    else{
+                        cv::Mat( frame.header->height, frame.header->width, CV_16UC1, const_cast<uint8_t*>( frame.data ) ).copyTo( depth );
+                    }
+                    recorded_depths.push_back( depth );
+                }
+            }
+            if( !recorded_depths.empty() ){
+                codec_results.push_back( run_codec( "rvl_recorded", recorded_depths ) );
+            }
+        }
+
+        // Writer Backpressure (fast disk, and slow disk that can write 10 fps)
+        std::vector<writer_result> writer_results;
+        for( const record_writer::backpressure policy : { record_writer::backpressure::block, record_writer::backpressure::drop_oldest, record_writer::backpressure::drop_newest } ){
+            for( const uint32_t write_delay : { 0, 400 } ){
+                writer_results.push_back( run_writer( policy, write_delay ) );
+            }
+        }
+
+        for( const bench_result& result : results ){
+            std::cerr << result.name << " : " << result.ns_per_frameset << " ns/frameset, " << result.mb_per_second << " MB/s" << std::endl;
+        }
+        for( const codec_result& result : codec_results ){
+            std::cerr << result.name << " : ratio " << result.ratio << ", encode " << result.encode_mb_per_second << " MB/s, decode " << result.decode_mb_per_second << " MB/s" << std::endl;
+        }
+        for( const pacing_result& result : pacing_results ){
+            std::cerr << result.name << " : interval " << result.mean_interval_ms << " ms (max " << result.max_interval_ms << " ms, jitter " << result.jitter_ms << " ms), late " << result.late_frames << " frames, hit " << result.hits << ", miss " << result.misses << std::endl;
+        }
+
+        for( const writer_result& result : writer_results ){
+            std::cerr << "writer " << result.policy << " (write delay " << result.write_delay << " ms) : capture " << result.capture_fps << " fps, pushed " << result.pushed
+                      << ", written " << result.written << ", dropped " << result.dropped << std::endl;
+        }
+
+        // Output JSON (stdout, or file if specified)
+        // usage: chunk_bench [output.json] [recorded.chunk]
+        const std::string json = to_json( results, codec_results, pacing_results, writer_results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+
+        std::remove( file_name.c_str() );
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,9 +1,25 @@
 #ifndef __ORBBEC__
 #define __ORBBEC__
 
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
 #include <libobsensor/ObSensor.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "ring_buffer.h"
+#include "triple_buffer.h"
+#include "stats.h"
+#include "frame_source.h"
+#include "video_decoder.h"
+
+namespace ob
+{
+    class frame_converter; // util.h
+}
+
 class orbbec
 {
 private:
@@ -16,10 +32,41 @@ private:
     std::shared_ptr<ob::Device > device = nullptr;
     std::shared_ptr<ob::Config> config = nullptr;
     std::shared_ptr<ob::FrameSet> frameset = nullptr;
+    std::shared_ptr<frame_source> source = nullptr;
+
+    // Mock
+    bool use_mock = false; // true: synthetic frames without device
+    uint32_t mock_fps = 30;
+
+    // Frame Queue
+    struct frame_packet
+    {
+        std::shared_ptr<ob::FrameSet> frameset = nullptr;
+        std::chrono::system_clock::time_point timestamp; // produced (system timestamp of frame)
+    };
+    enum class frame_policy { latest, all }; // latest frame wins, drop nothing
+    frame_policy policy = frame_policy::latest;
+    ring_buffer<frame_packet> frame_queue = ring_buffer<frame_packet>( 4 ); // all
+    triple_buffer<frame_packet> latest_frame; // latest (newest frame set replaces one not taken yet)
+
+    // Acquisition
+    bool use_callback = false; // true: frame sets are delivered by SDK callback, false: polling on acquisition thread
+    std::thread acquisition_thread;
+    std::atomic<bool> is_acquire = false;
+    std::atomic<bool> is_failed = false;
+    std::exception_ptr acquisition_error = nullptr; // thrown on acquisition thread, rethrown on main thread
+    std::atomic<uint64_t> acquired_frames = 0;
+    std::atomic<uint64_t> dropped_frames = 0; // queue full
+    std::atomic<uint64_t> skipped_frames = 0; // superseded by newer frame
+    latency_stats queue_stats; // from frame produced to taken by main loop
+    latency_stats draw_stats;
+    latency_stats show_stats;
 
     // Color
     std::shared_ptr<ob::VideoStreamProfile> color_stream_profile = nullptr;
     std::shared_ptr<ob::ColorFrame> color_frame = nullptr;
+    std::unique_ptr<video_decoder> color_decoder = nullptr; // H264/H265/HEVC (frames are submitted on acquisition side)
+    std::unique_ptr<ob::frame_converter> color_converter = nullptr; // other formats
     cv::Mat color;
 
 public:
@@ -48,9 +95,21 @@ private:
     // Initialize Sensor
     void initialize_sensor();
 
+    // Initialize Mock
+    void initialize_mock();
+
+    // Initialize Acquisition
+    void initialize_acquisition();
+
     // Finalize
     void finalize();
 
+    // Acquire Frame
+    void acquire_frame();
+
+    // Push Frame
+    void push_frame( std::shared_ptr<ob::FrameSet> acquired_frameset );
+
     // Update Frame
     void update_frame();
 
@@ -62,6 +121,9 @@ private:
 
     // Show Color
     void show_color();
+
+    // Show Statistics
+    void show_statistics();
 };
 
 #endif // __ORBBEC__
@@ -0,0 +1,45 @@
+#ifndef __STATS__
+#define __STATS__
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+
+// Latency statistics of pipeline stage (thread-safe)
+class latency_stats
+{
+private:
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> total = 0; // nanoseconds
+    std::atomic<uint64_t> maximum = 0; // nanoseconds
+
+public:
+    // Add Latency
+    void add( const std::chrono::steady_clock::duration duration )
+    {
+        const uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>( duration ).count();
+        count.fetch_add( 1, std::memory_order_relaxed );
+        total.fetch_add( latency, std::memory_order_relaxed );
+
+        uint64_t current = maximum.load( std::memory_order_relaxed );
+        while( latency > current && !maximum.compare_exchange_weak( current, latency, std::memory_order_relaxed ) ){
+        }
+    }
+
+    // To String
+    std::string to_string() const
+    {
+        const uint64_t samples = count.load( std::memory_order_relaxed );
+        const double average = samples != 0 ? total.load( std::memory_order_relaxed ) / static_cast<double>( samples ) : 0.0;
+
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision( 3 );
+        stream << samples << " samples, average " << average / 1e6 << " ms, max " << maximum.load( std::memory_order_relaxed ) / 1e6 << " ms";
+        return stream.str();
+    }
+};
+
+#endif // __STATS__
@@ -0,0 +1,309 @@
+#ifndef __VIDEO_DECODER__
+#define __VIDEO_DECODER__
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <cstring>
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "stats.h"
+
+#ifdef HAVE_FFMPEG
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+// Stateful decoder for H264/H265/HEVC stream
+// Codec context is kept across frames, because inter frames refer to previous frames.
+// Compressed frames are decoded on worker thread into pooled BGR buffers, the newest one is retrieved by consumer.
+class video_decoder
+{
+private:
+    // Input
+    std::deque<std::shared_ptr<ob::VideoFrame>> packets; // frames are held until decoded instead of copying compressed data
+    size_t capacity;
+    std::mutex packets_mutex;
+    std::condition_variable packets_condition;
+
+    // Output
+    std::vector<cv::Mat> pool;
+    cv::Mat decoded;
+    bool is_decoded = false;
+    std::mutex decoded_mutex;
+
+    // Worker
+    std::thread worker_thread;
+    bool is_running = false;
+    bool is_decoding = false; // worker is decoding popped frame
+    std::atomic<uint64_t> decoded_frames = 0;
+    std::atomic<uint64_t> overwritten_frames = 0; // decoded but superseded before retrieved
+    latency_stats decode_stats;
+
+    #ifdef HAVE_FFMPEG
+    // Codec
+    AVCodecContext* codec_context = nullptr;
+    AVPacket* packet = nullptr;
+    AVFrame* frame = nullptr;
+    SwsContext* sws_context = nullptr;
+    std::vector<uint8_t> buffer; // compressed data with padding required by decoder
+    #endif
+
+public:
+    // Constructor
+    // capacity is number of compressed frames waiting for decode, submit blocks while it is full.
+    explicit video_decoder( const OBFormat format, const size_t capacity = 8 )
+        : capacity( capacity )
+    {
+        #ifdef HAVE_FFMPEG
+        // Create Codec Context
+        AVCodecID codec_id = AV_CODEC_ID_NONE;
+        switch( format ){
+            case OBFormat::OB_FORMAT_H264:
+                codec_id = AV_CODEC_ID_H264;
+                break;
+            case OBFormat::OB_FORMAT_H265:
+            case OBFormat::OB_FORMAT_HEVC:
+                codec_id = AV_CODEC_ID_HEVC;
+                break;
+            default:
+                throw std::runtime_error( "[error] video decoder does not support this format!" );
+        }
+
+        const AVCodec* codec = avcodec_find_decoder( codec_id );
+        if( codec == nullptr ){
+            throw std::runtime_error( "[error] failed to find decoder!" );
+        }
+
+        codec_context = avcodec_alloc_context3( codec );
+        packet = av_packet_alloc();
+        frame = av_frame_alloc();
+        if( codec_context == nullptr || packet == nullptr || frame == nullptr ){
+            release();
+            throw std::runtime_error( "[error] failed to allocate decoder!" );
+        }
+
+        if( avcodec_open2( codec_context, codec, nullptr ) < 0 ){
+            release();
+            throw std::runtime_error( "[error] failed to open decoder!" );
+        }
+
+        // Start Worker Thread
+        is_running = true;
+        worker_thread = std::thread( [this](){ run(); } );
+        #else
+        throw std::runtime_error( "[error] video decoder requires ffmpeg (libavcodec, libswscale)!" );
+        #endif
+    }
+
+    // Destructor
+    ~video_decoder()
+    {
+        // Stop Worker Thread
+        {
+            std::lock_guard<std::mutex> lock( packets_mutex );
+            is_running = false;
+        }
+        packets_condition.notify_all();
+        if( worker_thread.joinable() ){
+            worker_thread.join();
+        }
+
+        #ifdef HAVE_FFMPEG
+        release();
+        #endif
+    }
+
+    video_decoder( const video_decoder& ) = delete;
+    video_decoder& operator=( const video_decoder& ) = delete;
+
+    // Submit Compressed Frame (Producer)
+    // frames must be submitted in stream order, no frame is dropped because it would break references of following frames.
+    void submit( std::shared_ptr<ob::VideoFrame> src )
+    {
+        std::unique_lock<std::mutex> lock( packets_mutex );
+        packets_condition.wait( lock, [this](){ return packets.size() < capacity || !is_running; } );
+        if( !is_running ){
+            return;
+        }
+        packets.push_back( src );
+        lock.unlock();
+        packets_condition.notify_all();
+    }
+
+    // Flush (Producer)
+    // Frames delayed in decoder are decoded, and returns after all submitted frames are published.
+    // Decoder is reset, so next submitted frame must be key frame.
+    void flush()
+    {
+        submit( nullptr ); // end of stream
+        std::unique_lock<std::mutex> lock( packets_mutex );
+        packets_condition.wait( lock, [this](){ return ( packets.empty() && !is_decoding ) || !is_running; } );
+    }
+
+    // Retrieve Newest Decoded Frame (Consumer)
+    // dst is swapped with pooled buffer, previous buffer of dst is returned to pool and reused for later frame.
+    // So do not keep other references to dst across retrieve.
+    bool retrieve( cv::Mat& dst )
+    {
+        std::lock_guard<std::mutex> lock( decoded_mutex );
+        if( !is_decoded ){
+            return false;
+        }
+
+        std::swap( dst, decoded );
+        if( !decoded.empty() ){
+            pool.push_back( decoded );
+            decoded.release();
+        }
+        is_decoded = false;
+        return true;
+    }
+
+    // Number of Decoded Frames
+    uint64_t num_decoded() const
+    {
+        return decoded_frames.load();
+    }
+
+    // Number of Decoded Frames that were Superseded before Retrieved
+    uint64_t num_overwritten() const
+    {
+        return overwritten_frames.load();
+    }
+
+    // Statistics
+    std::string to_string()
+    {
+        return std::to_string( decoded_frames.load() ) + " decoded, " + std::to_string( overwritten_frames.load() ) + " overwritten, " + decode_stats.to_string();
+    }
+
+private:
+    #ifdef HAVE_FFMPEG
+    // Worker Loop
+    void run()
+    {
+        while( true ){
+            // Pop Compressed Frame
+            std::shared_ptr<ob::VideoFrame> src = nullptr;
+            {
+                std::unique_lock<std::mutex> lock( packets_mutex );
+                packets_condition.wait( lock, [this](){ return !packets.empty() || !is_running; } );
+                if( !is_running ){
+                    return;
+                }
+                src = packets.front();
+                packets.pop_front();
+                is_decoding = true;
+            }
+            packets_condition.notify_all();
+
+            // Decode
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            decode( src, start );
+
+            {
+                std::lock_guard<std::mutex> lock( packets_mutex );
+                is_decoding = false;
+            }
+            packets_condition.notify_all();
+        }
+    }
+
+    // Decode Compressed Frame (nullptr drains frames delayed in decoder, and resets decoder)
+    void decode( std::shared_ptr<ob::VideoFrame> src, const std::chrono::steady_clock::time_point& start )
+    {
+        if( src == nullptr ){
+            if( avcodec_send_packet( codec_context, nullptr ) == 0 ){
+                while( avcodec_receive_frame( codec_context, frame ) == 0 ){
+                    convert( start );
+                    av_frame_unref( frame );
+                }
+            }
+            avcodec_flush_buffers( codec_context );
+            return;
+        }
+
+        // Send Packet and Receive Decoded Frames
+        const uint32_t data_size = src->dataSize();
+        buffer.resize( data_size + AV_INPUT_BUFFER_PADDING_SIZE );
+        std::memcpy( buffer.data(), src->data(), data_size );
+        std::memset( buffer.data() + data_size, 0, AV_INPUT_BUFFER_PADDING_SIZE );
+        packet->data = buffer.data();
+        packet->size = static_cast<int32_t>( data_size );
+        packet->pts = static_cast<int64_t>( src->timeStamp() );
+        if( avcodec_send_packet( codec_context, packet ) < 0 ){
+            std::cout << "[warning] failed to send packet to decoder!" << std::endl;
+            return;
+        }
+
+        while( avcodec_receive_frame( codec_context, frame ) == 0 ){
+            convert( start );
+            av_frame_unref( frame );
+        }
+    }
+
+    // Convert Decoded Frame to BGR
+    void convert( const std::chrono::steady_clock::time_point& start )
+    {
+        // Take Buffer from Pool
+        cv::Mat bgr;
+        {
+            std::lock_guard<std::mutex> lock( decoded_mutex );
+            if( !pool.empty() ){
+                bgr = pool.back();
+                pool.pop_back();
+            }
+        }
+        bgr.create( frame->height, frame->width, CV_8UC3 );
+
+        // Convert Pixel Format (YUV420P, etc.) to BGR
+        sws_context = sws_getCachedContext( sws_context, frame->width, frame->height, static_cast<AVPixelFormat>( frame->format ),
+                                            frame->width, frame->height, AV_PIX_FMT_BGR24, SWS_BILINEAR, nullptr, nullptr, nullptr );
+        if( sws_context == nullptr ){
+            std::cout << "[warning] failed to create scaler!" << std::endl;
+            return;
+        }
+        uint8_t* dst_data[4] = { bgr.data, nullptr, nullptr, nullptr };
+        int32_t dst_linesize[4] = { static_cast<int32_t>( bgr.step ), 0, 0, 0 };
+        sws_scale( sws_context, frame->data, frame->linesize, 0, frame->height, dst_data, dst_linesize );
+
+        // Publish Buffer (unretrieved buffer is returned to pool)
+        {
+            std::lock_guard<std::mutex> lock( decoded_mutex );
+            if( is_decoded ){
+                pool.push_back( decoded );
+                overwritten_frames++;
+            }
+            decoded = bgr;
+            is_decoded = true;
+        }
+        decoded_frames++;
+        decode_stats.add( std::chrono::steady_clock::now() - start );
+    }
+
+    // Release Codec
+    void release()
+    {
+        sws_freeContext( sws_context );
+        av_frame_free( &frame );
+        av_packet_free( &packet );
+        avcodec_free_context( &codec_context );
+    }
+    #endif
+};
+
+#endif // __VIDEO_DECODER__
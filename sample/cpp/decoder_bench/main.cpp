@@ -0,0 +1,298 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+
+#include "video_decoder.h"
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+// Decode Test and Benchmark of video_decoder (H264/HEVC)
+// Synthetic clip is encoded by libavcodec into elementary stream (Annex B), and each packet is wrapped into ob::VideoFrame like device.
+// Decoded frames are checked against source images (frame count, size and pixel content), and decode time is measured.
+
+// Benchmark Case
+struct bench_case
+{
+    OBFormat format;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Benchmark Result
+struct bench_result
+{
+    bench_case setting;
+    uint64_t frames;
+    uint64_t decoded;
+    uint64_t overwritten;
+    double psnr; // decoded last frame vs source [dB]
+    double ms_per_frame;
+};
+
+// To String
+std::string to_string( const OBFormat format )
+{
+    switch( format ){
+        case OBFormat::OB_FORMAT_H264:
+            return "H264";
+        case OBFormat::OB_FORMAT_HEVC:
+            return "HEVC";
+        default:
+            return "unknown";
+    }
+}
+
+// Create Source Images (moving gradient, every frame is different)
+std::vector<cv::Mat> create_images( const bench_case& setting, const uint32_t count )
+{
+    std::vector<cv::Mat> images;
+    for( uint32_t i = 0; i < count; i++ ){
+        cv::Mat bgr = cv::Mat( setting.height, setting.width, CV_8UC3 );
+        for( int32_t y = 0; y < bgr.rows; y++ ){
+            for( int32_t x = 0; x < bgr.cols; x++ ){
+                bgr.at<cv::Vec3b>( y, x ) = cv::Vec3b( ( x + i * 8 ) & 0xff, ( y + i * 4 ) & 0xff, ( ( x + y ) / 2 ) & 0xff );
+            }
+        }
+        cv::rectangle( bgr, cv::Rect( ( i * 16 ) % ( bgr.cols - 64 ), bgr.rows / 4, 64, 64 ), cv::Scalar( 255, 255, 255 ), cv::FILLED );
+        images.push_back( bgr );
+    }
+    return images;
+}
+
+// Encode Images into Elementary Stream (one packet per frame, no B-frames)
+std::vector<std::shared_ptr<std::vector<uint8_t>>> encode( const bench_case& setting, const std::vector<cv::Mat>& images )
+{
+    const AVCodec* codec = avcodec_find_encoder( setting.format == OBFormat::OB_FORMAT_H264 ? AV_CODEC_ID_H264 : AV_CODEC_ID_HEVC );
+    if( codec == nullptr ){
+        return {};
+    }
+
+    AVCodecContext* context = avcodec_alloc_context3( codec );
+    AVFrame* frame = av_frame_alloc();
+    AVPacket* packet = av_packet_alloc();
+    if( context == nullptr || frame == nullptr || packet == nullptr ){
+        throw std::runtime_error( "[error] failed to allocate encoder!" );
+    }
+
+    context->width = setting.width;
+    context->height = setting.height;
+    context->pix_fmt = AV_PIX_FMT_YUV420P;
+    context->time_base = AVRational{ 1, 30 };
+    context->framerate = AVRational{ 30, 1 };
+    context->gop_size = 10;
+    context->max_b_frames = 0;
+    context->bit_rate = static_cast<int64_t>( setting.width ) * setting.height * 8; // high quality
+    av_opt_set( context->priv_data, "tune", "zerolatency", 0 );
+    if( avcodec_open2( context, codec, nullptr ) < 0 ){
+        throw std::runtime_error( "[error] failed to open encoder!" );
+    }
+
+    frame->format = context->pix_fmt;
+    frame->width = context->width;
+    frame->height = context->height;
+    if( av_frame_get_buffer( frame, 0 ) < 0 ){
+        throw std::runtime_error( "[error] failed to allocate frame of encoder!" );
+    }
+
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> packets;
+    const auto receive = [&](){
+        while( avcodec_receive_packet( context, packet ) == 0 ){
+            packets.push_back( std::make_shared<std::vector<uint8_t>>( packet->data, packet->data + packet->size ) );
+            av_packet_unref( packet );
+        }
+    };
+
+    for( size_t i = 0; i < images.size(); i++ ){
+        // BGR to YUV420P (I420 planes copied with line size of frame)
+        cv::Mat i420;
+        cv::cvtColor( images[i], i420, cv::COLOR_BGR2YUV_I420 );
+        av_frame_make_writable( frame );
+        const uint8_t* plane = i420.ptr<uint8_t>();
+        for( int32_t p = 0; p < 3; p++ ){
+            const int32_t width = ( p == 0 ) ? frame->width : frame->width / 2;
+            const int32_t height = ( p == 0 ) ? frame->height : frame->height / 2;
+            for( int32_t y = 0; y < height; y++ ){
+                std::memcpy( frame->data[p] + y * frame->linesize[p], plane + y * width, width );
+            }
+            plane += width * height;
+        }
+        frame->pts = static_cast<int64_t>( i );
+
+        if( avcodec_send_frame( context, frame ) < 0 ){
+            throw std::runtime_error( "[error] failed to encode frame!" );
+        }
+        receive();
+    }
+
+    // Flush Encoder
+    avcodec_send_frame( context, nullptr );
+    receive();
+
+    av_packet_free( &packet );
+    av_frame_free( &frame );
+    avcodec_free_context( &context );
+    return packets;
+}
+
+// Wrap Packet into ob::VideoFrame (frame keeps packet alive)
+std::shared_ptr<ob::VideoFrame> wrap( const bench_case& setting, std::shared_ptr<std::vector<uint8_t>> data, const uint64_t timestamp )
+{
+    std::shared_ptr<std::vector<uint8_t>>* holder = new std::shared_ptr<std::vector<uint8_t>>( data );
+    std::shared_ptr<ob::Frame> frame = ob::FrameHelper::createFrameFromBuffer(
+        setting.format, setting.width, setting.height, data->data(), static_cast<uint32_t>( data->size() ),
+        []( void* buffer, void* context ){
+            delete reinterpret_cast<std::shared_ptr<std::vector<uint8_t>>*>( context );
+        },
+        holder
+    );
+    ob::FrameHelper::setFrameDeviceTimestamp( frame, timestamp );
+    return frame->as<ob::VideoFrame>();
+}
+
+// Run Decode Test of Benchmark Case (false if encoder is not available)
+bool run( const bench_case& setting, bench_result& result )
+{
+    constexpr uint32_t count = 30;
+    const std::vector<cv::Mat> images = create_images( setting, count );
+    const std::vector<std::shared_ptr<std::vector<uint8_t>>> packets = encode( setting, images );
+    if( packets.empty() ){
+        return false;
+    }
+    if( packets.size() != images.size() ){
+        throw std::runtime_error( "[error] encoder did not output one packet per frame (" + to_string( setting.format ) + ")!" );
+    }
+
+    std::vector<std::shared_ptr<ob::VideoFrame>> frames;
+    for( size_t i = 0; i < packets.size(); i++ ){
+        frames.push_back( wrap( setting, packets[i], i * 33 ) );
+    }
+
+    // Decode All Frames (small capacity, so submit blocks while worker decodes)
+    constexpr size_t capacity = 2;
+    video_decoder decoder( setting.format, capacity );
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for( const std::shared_ptr<ob::VideoFrame>& frame : frames ){
+        decoder.submit( frame );
+    }
+    decoder.flush();
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    // Check Frame Count (nothing retrieved until flush, so all but newest are overwritten in pool)
+    if( decoder.num_decoded() != frames.size() ){
+        throw std::runtime_error( "[error] decoded " + std::to_string( decoder.num_decoded() ) + " of " + std::to_string( frames.size() ) + " frames (" + to_string( setting.format ) + ")!" );
+    }
+    if( decoder.num_overwritten() != frames.size() - 1 ){
+        throw std::runtime_error( "[error] decoded frames were lost before retrieved (" + to_string( setting.format ) + ")!" );
+    }
+
+    // Check Size and Pixel Content of Newest Frame (lossy, so compared by PSNR, and must be closer to last image than first one)
+    cv::Mat decoded;
+    if( !decoder.retrieve( decoded ) ){
+        throw std::runtime_error( "[error] failed to retrieve decoded frame (" + to_string( setting.format ) + ")!" );
+    }
+    if( decoded.cols != static_cast<int32_t>( setting.width ) || decoded.rows != static_cast<int32_t>( setting.height ) || decoded.type() != CV_8UC3 ){
+        throw std::runtime_error( "[error] size of decoded frame is wrong (" + to_string( setting.format ) + ")!" );
+    }
+    const double psnr = cv::PSNR( decoded, images.back() );
+    if( psnr < 30.0 || psnr <= cv::PSNR( decoded, images.front() ) ){
+        throw std::runtime_error( "[error] decoded frame does not match source (" + to_string( setting.format ) + ", " + std::to_string( psnr ) + " dB)!" );
+    }
+
+    // Decoder is reset by flush, and stream decodes again from key frame
+    decoder.submit( frames.front() );
+    decoder.flush();
+    if( decoder.num_decoded() != frames.size() + 1 || !decoder.retrieve( decoded ) || cv::PSNR( decoded, images.front() ) < 30.0 ){
+        throw std::runtime_error( "[error] failed to decode after flush (" + to_string( setting.format ) + ")!" );
+    }
+
+    // Stop with Pending Frames (destructor must not wait for them)
+    {
+        video_decoder stopped( setting.format, capacity );
+        stopped.submit( frames[0] );
+        stopped.submit( frames[1] );
+    }
+
+    result.setting = setting;
+    result.frames = frames.size();
+    result.decoded = decoder.num_decoded();
+    result.overwritten = decoder.num_overwritten();
+    result.psnr = psnr;
+    result.ms_per_frame = std::chrono::duration<double, std::milli>( end - start ).count() / frames.size();
+    return true;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"format\": \"" << to_string( result.setting.format ) << "\", ";
+        stream << "\"width\": " << result.setting.width << ", ";
+        stream << "\"height\": " << result.setting.height << ", ";
+        stream << "\"frames\": " << result.frames << ", ";
+        stream << "\"decoded\": " << result.decoded << ", ";
+        stream << "\"overwritten\": " << result.overwritten << ", ";
+        stream << "\"psnr\": " << result.psnr << ", ";
+        stream << "\"ms_per_frame\": " << result.ms_per_frame;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        // Benchmark Cases (color resolutions of femto mega)
+        const std::vector<bench_case> cases = {
+            { OBFormat::OB_FORMAT_H264, 1280, 720 }, { OBFormat::OB_FORMAT_H264, 1920, 1080 },
+            { OBFormat::OB_FORMAT_HEVC, 1280, 720 }, { OBFormat::OB_FORMAT_HEVC, 1920, 1080 }
+        };
+
+        // Run Decode Test
+        std::vector<bench_result> results;
+        for( const bench_case& setting : cases ){
+            bench_result result;
+            if( !run( setting, result ) ){
+                std::cerr << "[warning] encoder of " << to_string( setting.format ) << " is not available, skipped." << std::endl;
+                continue;
+            }
+            std::cerr << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " : decoded " << result.decoded << " frames, "
+                      << result.ms_per_frame << " ms/frame, psnr " << result.psnr << " dB" << std::endl;
+            results.push_back( result );
+        }
+        if( results.empty() ){
+            throw std::runtime_error( "[error] no encoder of H264/HEVC is available!" );
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
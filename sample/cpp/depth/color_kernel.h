@@ -0,0 +1,581 @@
+#ifndef __COLOR_KERNEL__
+#define __COLOR_KERNEL__
+
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include <opencv2/opencv.hpp>
+
+#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __i386__ ) || defined( _M_IX86 )
+#define COLOR_KERNEL_X86
+#include <immintrin.h>
+#elif defined( __ARM_NEON ) || defined( __aarch64__ ) || defined( _M_ARM64 )
+#define COLOR_KERNEL_NEON
+#include <arm_neon.h>
+#endif
+
+// Instruction set of function compiled without global compiler flags (GCC and Clang, MSVC does not need it)
+#if defined( COLOR_KERNEL_X86 ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+#define COLOR_KERNEL_TARGET( name ) __attribute__( ( target( name ) ) )
+#else
+#define COLOR_KERNEL_TARGET( name )
+#endif
+
+/*
+ Color conversion kernels from frame memory to BGR
+
+ Converts YUYV, UYVY, NV12, NV21, RGB and BGRA (formats streamed by femto mega, and their variants) straight from frame memory into BGR.
+ Instruction set (SSE4.1, AVX2 or NEON) is chosen at runtime, and rows are converted in parallel.
+ YUV uses same BT.601 fixed-point arithmetic as cv::cvtColor, so result is bit-exact with cv::cvtColor for every instruction set.
+ AVX2 widens arithmetic of YUV, swizzles of RGB and BGRA are bound by memory and share SSE4.1 kernel.
+
+ color_kernel::convert( color_kernel::format::yuyv, frame->data(), width, height, mat ); // best instruction set of cpu
+ color_kernel::convert( color_kernel::format::nv12, frame->data(), width, height, mat, color_kernel::isa::scalar ); // specific instruction set
+*/
+namespace color_kernel
+{
+    // Instruction Set
+    enum class isa { scalar, sse4_1, avx2, neon };
+
+    // Source Format
+    enum class format { yuyv, uyvy, nv12, nv21, rgb, bgra };
+
+    // Fixed-Point Coefficients of BT.601 (same as cv::cvtColor)
+    constexpr int32_t shift = 20;
+    constexpr int32_t round = 1 << ( shift - 1 );
+    constexpr int32_t cy = 1220542;
+    constexpr int32_t cub = 2116026;
+    constexpr int32_t cug = -409993;
+    constexpr int32_t cvg = -852492;
+    constexpr int32_t cvr = 1673527;
+
+    // Convert YUV to BGR
+    inline void yuv_to_bgr( const int32_t y, const int32_t u, const int32_t v, uint8_t* bgr )
+    {
+        const int32_t luma = std::max( 0, y - 16 ) * cy + round;
+        bgr[0] = cv::saturate_cast<uint8_t>( ( luma + cub * ( u - 128 ) ) >> shift );
+        bgr[1] = cv::saturate_cast<uint8_t>( ( luma + cug * ( u - 128 ) + cvg * ( v - 128 ) ) >> shift );
+        bgr[2] = cv::saturate_cast<uint8_t>( ( luma + cvr * ( v - 128 ) ) >> shift );
+    }
+
+    // Scalar Kernels (also convert remaining pixels of SIMD kernels from x)
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    inline void yuv422_row_scalar( const uint8_t* src, uint8_t* dst, int32_t x, const int32_t width )
+    {
+        for( ; x < width; x += 2 ){
+            const uint8_t* pixels = src + x * 2;
+            yuv_to_bgr( pixels[y_offset], pixels[u_offset], pixels[v_offset], dst + x * 3 );
+            yuv_to_bgr( pixels[y_offset + 2], pixels[u_offset], pixels[v_offset], dst + x * 3 + 3 );
+        }
+    }
+
+    template<int32_t u_offset, int32_t v_offset>
+    inline void yuv420sp_row_scalar( const uint8_t* luma, const uint8_t* chroma, uint8_t* dst, int32_t x, const int32_t width )
+    {
+        for( ; x < width; x += 2 ){
+            const uint8_t* uv = chroma + x;
+            yuv_to_bgr( luma[x], uv[u_offset], uv[v_offset], dst + x * 3 );
+            yuv_to_bgr( luma[x + 1], uv[u_offset], uv[v_offset], dst + x * 3 + 3 );
+        }
+    }
+
+    inline void rgb_row_scalar( const uint8_t* src, uint8_t* dst, int32_t x, const int32_t width )
+    {
+        for( ; x < width; x++ ){
+            dst[x * 3 + 0] = src[x * 3 + 2];
+            dst[x * 3 + 1] = src[x * 3 + 1];
+            dst[x * 3 + 2] = src[x * 3 + 0];
+        }
+    }
+
+    inline void bgra_row_scalar( const uint8_t* src, uint8_t* dst, int32_t x, const int32_t width )
+    {
+        for( ; x < width; x++ ){
+            dst[x * 3 + 0] = src[x * 4 + 0];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+
+#if defined( COLOR_KERNEL_X86 )
+    // Store 16 Pixels of Planar B, G and R as Interleaved BGR (48 bytes)
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void store_bgr_sse( const __m128i b, const __m128i g, const __m128i r, uint8_t* dst )
+    {
+        const __m128i b0 = _mm_setr_epi8(  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5 );
+        const __m128i g0 = _mm_setr_epi8( -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1 );
+        const __m128i r0 = _mm_setr_epi8( -1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1 );
+        const __m128i b1 = _mm_setr_epi8( -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1 );
+        const __m128i g1 = _mm_setr_epi8(  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10 );
+        const __m128i r1 = _mm_setr_epi8( -1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1 );
+        const __m128i b2 = _mm_setr_epi8( -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1 );
+        const __m128i g2 = _mm_setr_epi8( -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1 );
+        const __m128i r2 = _mm_setr_epi8( 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15 );
+
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst +  0 ), _mm_or_si128( _mm_or_si128( _mm_shuffle_epi8( b, b0 ), _mm_shuffle_epi8( g, g0 ) ), _mm_shuffle_epi8( r, r0 ) ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 16 ), _mm_or_si128( _mm_or_si128( _mm_shuffle_epi8( b, b1 ), _mm_shuffle_epi8( g, g1 ) ), _mm_shuffle_epi8( r, r1 ) ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 32 ), _mm_or_si128( _mm_or_si128( _mm_shuffle_epi8( b, b2 ), _mm_shuffle_epi8( g, g2 ) ), _mm_shuffle_epi8( r, r2 ) ) );
+    }
+
+    // Convert 4 Pixels of YUV (int32) to B, G and R (int32)
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv_to_bgr_sse( const __m128i y, const __m128i u, const __m128i v, __m128i& b, __m128i& g, __m128i& r )
+    {
+        const __m128i luma = _mm_add_epi32( _mm_mullo_epi32( _mm_max_epi32( _mm_sub_epi32( y, _mm_set1_epi32( 16 ) ), _mm_setzero_si128() ), _mm_set1_epi32( cy ) ), _mm_set1_epi32( round ) );
+        const __m128i cu = _mm_sub_epi32( u, _mm_set1_epi32( 128 ) );
+        const __m128i cv = _mm_sub_epi32( v, _mm_set1_epi32( 128 ) );
+        b = _mm_srai_epi32( _mm_add_epi32( luma, _mm_mullo_epi32( cu, _mm_set1_epi32( cub ) ) ), shift );
+        g = _mm_srai_epi32( _mm_add_epi32( _mm_add_epi32( luma, _mm_mullo_epi32( cu, _mm_set1_epi32( cug ) ) ), _mm_mullo_epi32( cv, _mm_set1_epi32( cvg ) ) ), shift );
+        r = _mm_srai_epi32( _mm_add_epi32( luma, _mm_mullo_epi32( cv, _mm_set1_epi32( cvr ) ) ), shift );
+    }
+
+    // Convert 8 Pixels of YUV (uint16) to B, G and R (int16)
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv8_to_bgr_sse( const __m128i y, const __m128i u, const __m128i v, __m128i& b, __m128i& g, __m128i& r )
+    {
+        __m128i b_lo, g_lo, r_lo, b_hi, g_hi, r_hi;
+        yuv_to_bgr_sse( _mm_cvtepu16_epi32( y ), _mm_cvtepu16_epi32( u ), _mm_cvtepu16_epi32( v ), b_lo, g_lo, r_lo );
+        yuv_to_bgr_sse( _mm_cvtepu16_epi32( _mm_srli_si128( y, 8 ) ), _mm_cvtepu16_epi32( _mm_srli_si128( u, 8 ) ), _mm_cvtepu16_epi32( _mm_srli_si128( v, 8 ) ), b_hi, g_hi, r_hi );
+        b = _mm_packs_epi32( b_lo, b_hi );
+        g = _mm_packs_epi32( g_lo, g_hi );
+        r = _mm_packs_epi32( r_lo, r_hi );
+    }
+
+    // Convert 8 Pixels of YUV (uint16) to B, G and R (int16) with AVX2
+    COLOR_KERNEL_TARGET( "avx2" )
+    inline void yuv8_to_bgr_avx2( const __m128i y, const __m128i u, const __m128i v, __m128i& b, __m128i& g, __m128i& r )
+    {
+        const __m256i luma = _mm256_add_epi32( _mm256_mullo_epi32( _mm256_max_epi32( _mm256_sub_epi32( _mm256_cvtepu16_epi32( y ), _mm256_set1_epi32( 16 ) ), _mm256_setzero_si256() ), _mm256_set1_epi32( cy ) ), _mm256_set1_epi32( round ) );
+        const __m256i cu = _mm256_sub_epi32( _mm256_cvtepu16_epi32( u ), _mm256_set1_epi32( 128 ) );
+        const __m256i cv = _mm256_sub_epi32( _mm256_cvtepu16_epi32( v ), _mm256_set1_epi32( 128 ) );
+        const __m256i b32 = _mm256_srai_epi32( _mm256_add_epi32( luma, _mm256_mullo_epi32( cu, _mm256_set1_epi32( cub ) ) ), shift );
+        const __m256i g32 = _mm256_srai_epi32( _mm256_add_epi32( _mm256_add_epi32( luma, _mm256_mullo_epi32( cu, _mm256_set1_epi32( cug ) ) ), _mm256_mullo_epi32( cv, _mm256_set1_epi32( cvg ) ) ), shift );
+        const __m256i r32 = _mm256_srai_epi32( _mm256_add_epi32( luma, _mm256_mullo_epi32( cv, _mm256_set1_epi32( cvr ) ) ), shift );
+        b = _mm_packs_epi32( _mm256_castsi256_si128( b32 ), _mm256_extracti128_si256( b32, 1 ) );
+        g = _mm_packs_epi32( _mm256_castsi256_si128( g32 ), _mm256_extracti128_si256( g32, 1 ) );
+        r = _mm_packs_epi32( _mm256_castsi256_si128( r32 ), _mm256_extracti128_si256( r32, 1 ) );
+    }
+
+    // Convert 16 Pixels of YUV (uint16 of first 8 pixels and last 8 pixels) to BGR
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv16_to_bgr_sse( const __m128i y_lo, const __m128i u_lo, const __m128i v_lo, const __m128i y_hi, const __m128i u_hi, const __m128i v_hi, uint8_t* dst )
+    {
+        __m128i b_lo, g_lo, r_lo, b_hi, g_hi, r_hi;
+        yuv8_to_bgr_sse( y_lo, u_lo, v_lo, b_lo, g_lo, r_lo );
+        yuv8_to_bgr_sse( y_hi, u_hi, v_hi, b_hi, g_hi, r_hi );
+        store_bgr_sse( _mm_packus_epi16( b_lo, b_hi ), _mm_packus_epi16( g_lo, g_hi ), _mm_packus_epi16( r_lo, r_hi ), dst );
+    }
+
+    COLOR_KERNEL_TARGET( "avx2" )
+    inline void yuv16_to_bgr_avx2( const __m128i y_lo, const __m128i u_lo, const __m128i v_lo, const __m128i y_hi, const __m128i u_hi, const __m128i v_hi, uint8_t* dst )
+    {
+        __m128i b_lo, g_lo, r_lo, b_hi, g_hi, r_hi;
+        yuv8_to_bgr_avx2( y_lo, u_lo, v_lo, b_lo, g_lo, r_lo );
+        yuv8_to_bgr_avx2( y_hi, u_hi, v_hi, b_hi, g_hi, r_hi );
+        store_bgr_sse( _mm_packus_epi16( b_lo, b_hi ), _mm_packus_epi16( g_lo, g_hi ), _mm_packus_epi16( r_lo, r_hi ), dst );
+    }
+
+    // Shuffle Masks of Packed YUV 4:2:2 (Y, U and V of 8 pixels in 16 bytes, zero extended to uint16)
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv422_masks_sse( __m128i& y_mask, __m128i& u_mask, __m128i& v_mask )
+    {
+        y_mask = _mm_setr_epi8( y_offset, -1, y_offset + 2, -1, y_offset + 4, -1, y_offset + 6, -1, y_offset + 8, -1, y_offset + 10, -1, y_offset + 12, -1, y_offset + 14, -1 );
+        u_mask = _mm_setr_epi8( u_offset, -1, u_offset, -1, u_offset + 4, -1, u_offset + 4, -1, u_offset + 8, -1, u_offset + 8, -1, u_offset + 12, -1, u_offset + 12, -1 );
+        v_mask = _mm_setr_epi8( v_offset, -1, v_offset, -1, v_offset + 4, -1, v_offset + 4, -1, v_offset + 8, -1, v_offset + 8, -1, v_offset + 12, -1, v_offset + 12, -1 );
+    }
+
+    // Shuffle Masks of Semi-Planar YUV 4:2:0 (U and V of first and last 8 pixels in 16 bytes of interleaved chroma, zero extended to uint16)
+    template<int32_t u_offset, int32_t v_offset>
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv420sp_masks_sse( __m128i& u_lo_mask, __m128i& v_lo_mask, __m128i& u_hi_mask, __m128i& v_hi_mask )
+    {
+        u_lo_mask = _mm_setr_epi8( u_offset, -1, u_offset, -1, u_offset + 2, -1, u_offset + 2, -1, u_offset + 4, -1, u_offset + 4, -1, u_offset + 6, -1, u_offset + 6, -1 );
+        v_lo_mask = _mm_setr_epi8( v_offset, -1, v_offset, -1, v_offset + 2, -1, v_offset + 2, -1, v_offset + 4, -1, v_offset + 4, -1, v_offset + 6, -1, v_offset + 6, -1 );
+        u_hi_mask = _mm_setr_epi8( u_offset + 8, -1, u_offset + 8, -1, u_offset + 10, -1, u_offset + 10, -1, u_offset + 12, -1, u_offset + 12, -1, u_offset + 14, -1, u_offset + 14, -1 );
+        v_hi_mask = _mm_setr_epi8( v_offset + 8, -1, v_offset + 8, -1, v_offset + 10, -1, v_offset + 10, -1, v_offset + 12, -1, v_offset + 12, -1, v_offset + 14, -1, v_offset + 14, -1 );
+    }
+
+    // Packed YUV 4:2:2 (16 pixels per iteration)
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv422_row_sse( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        __m128i y_mask, u_mask, v_mask;
+        yuv422_masks_sse<y_offset, u_offset, v_offset>( y_mask, u_mask, v_mask );
+
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 2 ) );
+            const __m128i hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 2 + 16 ) );
+            yuv16_to_bgr_sse( _mm_shuffle_epi8( lo, y_mask ), _mm_shuffle_epi8( lo, u_mask ), _mm_shuffle_epi8( lo, v_mask ),
+                              _mm_shuffle_epi8( hi, y_mask ), _mm_shuffle_epi8( hi, u_mask ), _mm_shuffle_epi8( hi, v_mask ), dst + x * 3 );
+        }
+        yuv422_row_scalar<y_offset, u_offset, v_offset>( src, dst, x, width );
+    }
+
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    COLOR_KERNEL_TARGET( "avx2" )
+    inline void yuv422_row_avx2( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        __m128i y_mask, u_mask, v_mask;
+        yuv422_masks_sse<y_offset, u_offset, v_offset>( y_mask, u_mask, v_mask );
+
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 2 ) );
+            const __m128i hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 2 + 16 ) );
+            yuv16_to_bgr_avx2( _mm_shuffle_epi8( lo, y_mask ), _mm_shuffle_epi8( lo, u_mask ), _mm_shuffle_epi8( lo, v_mask ),
+                               _mm_shuffle_epi8( hi, y_mask ), _mm_shuffle_epi8( hi, u_mask ), _mm_shuffle_epi8( hi, v_mask ), dst + x * 3 );
+        }
+        yuv422_row_scalar<y_offset, u_offset, v_offset>( src, dst, x, width );
+    }
+
+    // Semi-Planar YUV 4:2:0 (16 pixels per iteration)
+    template<int32_t u_offset, int32_t v_offset>
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void yuv420sp_row_sse( const uint8_t* luma, const uint8_t* chroma, uint8_t* dst, const int32_t width )
+    {
+        __m128i u_lo_mask, v_lo_mask, u_hi_mask, v_hi_mask;
+        yuv420sp_masks_sse<u_offset, v_offset>( u_lo_mask, v_lo_mask, u_hi_mask, v_hi_mask );
+
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const __m128i y = _mm_loadu_si128( reinterpret_cast<const __m128i*>( luma + x ) );
+            const __m128i uv = _mm_loadu_si128( reinterpret_cast<const __m128i*>( chroma + x ) );
+            yuv16_to_bgr_sse( _mm_cvtepu8_epi16( y ), _mm_shuffle_epi8( uv, u_lo_mask ), _mm_shuffle_epi8( uv, v_lo_mask ),
+                              _mm_cvtepu8_epi16( _mm_srli_si128( y, 8 ) ), _mm_shuffle_epi8( uv, u_hi_mask ), _mm_shuffle_epi8( uv, v_hi_mask ), dst + x * 3 );
+        }
+        yuv420sp_row_scalar<u_offset, v_offset>( luma, chroma, dst, x, width );
+    }
+
+    template<int32_t u_offset, int32_t v_offset>
+    COLOR_KERNEL_TARGET( "avx2" )
+    inline void yuv420sp_row_avx2( const uint8_t* luma, const uint8_t* chroma, uint8_t* dst, const int32_t width )
+    {
+        __m128i u_lo_mask, v_lo_mask, u_hi_mask, v_hi_mask;
+        yuv420sp_masks_sse<u_offset, v_offset>( u_lo_mask, v_lo_mask, u_hi_mask, v_hi_mask );
+
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const __m128i y = _mm_loadu_si128( reinterpret_cast<const __m128i*>( luma + x ) );
+            const __m128i uv = _mm_loadu_si128( reinterpret_cast<const __m128i*>( chroma + x ) );
+            yuv16_to_bgr_avx2( _mm_cvtepu8_epi16( y ), _mm_shuffle_epi8( uv, u_lo_mask ), _mm_shuffle_epi8( uv, v_lo_mask ),
+                               _mm_cvtepu8_epi16( _mm_srli_si128( y, 8 ) ), _mm_shuffle_epi8( uv, u_hi_mask ), _mm_shuffle_epi8( uv, v_hi_mask ), dst + x * 3 );
+        }
+        yuv420sp_row_scalar<u_offset, v_offset>( luma, chroma, dst, x, width );
+    }
+
+    // RGB to BGR (5 pixels per iteration, 16th byte is overwritten by next iteration)
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void rgb_row_sse( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        const __m128i mask = _mm_setr_epi8( 2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15 );
+
+        int32_t x = 0;
+        for( ; x + 6 <= width; x += 5 ){
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 3 ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 3 ), _mm_shuffle_epi8( pixels, mask ) );
+        }
+        rgb_row_scalar( src, dst, x, width );
+    }
+
+    // BGRA to BGR (16 pixels per iteration)
+    COLOR_KERNEL_TARGET( "sse4.1" )
+    inline void bgra_row_sse( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        const __m128i mask = _mm_setr_epi8( 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const __m128i p0 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 +  0 ) ), mask );
+            const __m128i p1 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 + 16 ) ), mask );
+            const __m128i p2 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 + 32 ) ), mask );
+            const __m128i p3 = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 + 48 ) ), mask );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 3 +  0 ), _mm_or_si128( p0, _mm_slli_si128( p1, 12 ) ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 3 + 16 ), _mm_or_si128( _mm_srli_si128( p1, 4 ), _mm_slli_si128( p2, 8 ) ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 3 + 32 ), _mm_or_si128( _mm_srli_si128( p2, 8 ), _mm_slli_si128( p3, 4 ) ) );
+        }
+        bgra_row_scalar( src, dst, x, width );
+    }
+#endif
+
+#if defined( COLOR_KERNEL_NEON )
+    // Convert 4 Pixels of YUV (int32) to B, G and R (int32)
+    inline void yuv_to_bgr_neon( const int32x4_t y, const int32x4_t u, const int32x4_t v, int32x4_t& b, int32x4_t& g, int32x4_t& r )
+    {
+        const int32x4_t luma = vaddq_s32( vmulq_n_s32( vmaxq_s32( vsubq_s32( y, vdupq_n_s32( 16 ) ), vdupq_n_s32( 0 ) ), cy ), vdupq_n_s32( round ) );
+        const int32x4_t cu = vsubq_s32( u, vdupq_n_s32( 128 ) );
+        const int32x4_t cv = vsubq_s32( v, vdupq_n_s32( 128 ) );
+        b = vshrq_n_s32( vmlaq_n_s32( luma, cu, cub ), shift );
+        g = vshrq_n_s32( vmlaq_n_s32( vmlaq_n_s32( luma, cu, cug ), cv, cvg ), shift );
+        r = vshrq_n_s32( vmlaq_n_s32( luma, cv, cvr ), shift );
+    }
+
+    // Convert 8 Pixels of YUV (uint8) to B, G and R (uint8)
+    inline void yuv8_to_bgr_neon( const uint8x8_t y, const uint8x8_t u, const uint8x8_t v, uint8x8_t& b, uint8x8_t& g, uint8x8_t& r )
+    {
+        const int16x8_t y16 = vreinterpretq_s16_u16( vmovl_u8( y ) );
+        const int16x8_t u16 = vreinterpretq_s16_u16( vmovl_u8( u ) );
+        const int16x8_t v16 = vreinterpretq_s16_u16( vmovl_u8( v ) );
+
+        int32x4_t b_lo, g_lo, r_lo, b_hi, g_hi, r_hi;
+        yuv_to_bgr_neon( vmovl_s16( vget_low_s16( y16 ) ), vmovl_s16( vget_low_s16( u16 ) ), vmovl_s16( vget_low_s16( v16 ) ), b_lo, g_lo, r_lo );
+        yuv_to_bgr_neon( vmovl_s16( vget_high_s16( y16 ) ), vmovl_s16( vget_high_s16( u16 ) ), vmovl_s16( vget_high_s16( v16 ) ), b_hi, g_hi, r_hi );
+        b = vqmovun_s16( vcombine_s16( vmovn_s32( b_lo ), vmovn_s32( b_hi ) ) );
+        g = vqmovun_s16( vcombine_s16( vmovn_s32( g_lo ), vmovn_s32( g_hi ) ) );
+        r = vqmovun_s16( vcombine_s16( vmovn_s32( r_lo ), vmovn_s32( r_hi ) ) );
+    }
+
+    // Convert 16 Pixels from Y of Even and Odd Pixels and U and V of Pixel Pairs to BGR
+    inline void yuv16_to_bgr_neon( const uint8x8_t y_even, const uint8x8_t y_odd, const uint8x8_t u, const uint8x8_t v, uint8_t* dst )
+    {
+        uint8x8_t b_even, g_even, r_even, b_odd, g_odd, r_odd;
+        yuv8_to_bgr_neon( y_even, u, v, b_even, g_even, r_even );
+        yuv8_to_bgr_neon( y_odd, u, v, b_odd, g_odd, r_odd );
+
+        const uint8x8x2_t b = vzip_u8( b_even, b_odd );
+        const uint8x8x2_t g = vzip_u8( g_even, g_odd );
+        const uint8x8x2_t r = vzip_u8( r_even, r_odd );
+        uint8x16x3_t bgr;
+        bgr.val[0] = vcombine_u8( b.val[0], b.val[1] );
+        bgr.val[1] = vcombine_u8( g.val[0], g.val[1] );
+        bgr.val[2] = vcombine_u8( r.val[0], r.val[1] );
+        vst3q_u8( dst, bgr );
+    }
+
+    // Packed YUV 4:2:2 (16 pixels per iteration)
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    inline void yuv422_row_neon( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const uint8x8x4_t pixels = vld4_u8( src + x * 2 ); // byte 0, 1, 2 and 3 of 8 macro pixels
+            yuv16_to_bgr_neon( pixels.val[y_offset], pixels.val[y_offset + 2], pixels.val[u_offset], pixels.val[v_offset], dst + x * 3 );
+        }
+        yuv422_row_scalar<y_offset, u_offset, v_offset>( src, dst, x, width );
+    }
+
+    // Semi-Planar YUV 4:2:0 (16 pixels per iteration)
+    template<int32_t u_offset, int32_t v_offset>
+    inline void yuv420sp_row_neon( const uint8_t* luma, const uint8_t* chroma, uint8_t* dst, const int32_t width )
+    {
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const uint8x8x2_t y = vld2_u8( luma + x ); // even and odd pixels
+            const uint8x8x2_t uv = vld2_u8( chroma + x );
+            yuv16_to_bgr_neon( y.val[0], y.val[1], uv.val[u_offset], uv.val[v_offset], dst + x * 3 );
+        }
+        yuv420sp_row_scalar<u_offset, v_offset>( luma, chroma, dst, x, width );
+    }
+
+    // RGB to BGR (16 pixels per iteration)
+    inline void rgb_row_neon( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            uint8x16x3_t pixels = vld3q_u8( src + x * 3 );
+            const uint8x16_t red = pixels.val[0];
+            pixels.val[0] = pixels.val[2];
+            pixels.val[2] = red;
+            vst3q_u8( dst + x * 3, pixels );
+        }
+        rgb_row_scalar( src, dst, x, width );
+    }
+
+    // BGRA to BGR (16 pixels per iteration)
+    inline void bgra_row_neon( const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        int32_t x = 0;
+        for( ; x + 16 <= width; x += 16 ){
+            const uint8x16x4_t pixels = vld4q_u8( src + x * 4 );
+            uint8x16x3_t bgr;
+            bgr.val[0] = pixels.val[0];
+            bgr.val[1] = pixels.val[1];
+            bgr.val[2] = pixels.val[2];
+            vst3q_u8( dst + x * 3, bgr );
+        }
+        bgra_row_scalar( src, dst, x, width );
+    }
+#endif
+
+    // Is Instruction Set Supported by CPU (and compiled)
+    inline bool is_supported( const isa target )
+    {
+        switch( target ){
+            case isa::scalar:
+                return true;
+#if defined( COLOR_KERNEL_X86 )
+            case isa::sse4_1:
+                return cv::checkHardwareSupport( CV_CPU_SSE4_1 );
+            case isa::avx2:
+                return cv::checkHardwareSupport( CV_CPU_AVX2 );
+#endif
+#if defined( COLOR_KERNEL_NEON )
+            case isa::neon:
+                return true; // baseline of aarch64 and armv7 with neon
+#endif
+            default:
+                return false;
+        }
+    }
+
+    // Best Instruction Set of CPU (detected once)
+    inline isa get_isa()
+    {
+        static const isa best = [](){
+            for( const isa target : { isa::avx2, isa::sse4_1, isa::neon } ){
+                if( is_supported( target ) ){
+                    return target;
+                }
+            }
+            return isa::scalar;
+        }();
+        return best;
+    }
+
+    // Convert Row of Packed YUV 4:2:2
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    inline void yuv422_row( const isa target, const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        switch( target ){
+#if defined( COLOR_KERNEL_X86 )
+            case isa::avx2:
+                return yuv422_row_avx2<y_offset, u_offset, v_offset>( src, dst, width );
+            case isa::sse4_1:
+                return yuv422_row_sse<y_offset, u_offset, v_offset>( src, dst, width );
+#endif
+#if defined( COLOR_KERNEL_NEON )
+            case isa::neon:
+                return yuv422_row_neon<y_offset, u_offset, v_offset>( src, dst, width );
+#endif
+            default:
+                return yuv422_row_scalar<y_offset, u_offset, v_offset>( src, dst, 0, width );
+        }
+    }
+
+    // Convert Row of Semi-Planar YUV 4:2:0
+    template<int32_t u_offset, int32_t v_offset>
+    inline void yuv420sp_row( const isa target, const uint8_t* luma, const uint8_t* chroma, uint8_t* dst, const int32_t width )
+    {
+        switch( target ){
+#if defined( COLOR_KERNEL_X86 )
+            case isa::avx2:
+                return yuv420sp_row_avx2<u_offset, v_offset>( luma, chroma, dst, width );
+            case isa::sse4_1:
+                return yuv420sp_row_sse<u_offset, v_offset>( luma, chroma, dst, width );
+#endif
+#if defined( COLOR_KERNEL_NEON )
+            case isa::neon:
+                return yuv420sp_row_neon<u_offset, v_offset>( luma, chroma, dst, width );
+#endif
+            default:
+                return yuv420sp_row_scalar<u_offset, v_offset>( luma, chroma, dst, 0, width );
+        }
+    }
+
+    // Convert Row of RGB
+    inline void rgb_row( const isa target, const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        switch( target ){
+#if defined( COLOR_KERNEL_X86 )
+            case isa::avx2:
+            case isa::sse4_1:
+                return rgb_row_sse( src, dst, width );
+#endif
+#if defined( COLOR_KERNEL_NEON )
+            case isa::neon:
+                return rgb_row_neon( src, dst, width );
+#endif
+            default:
+                return rgb_row_scalar( src, dst, 0, width );
+        }
+    }
+
+    // Convert Row of BGRA
+    inline void bgra_row( const isa target, const uint8_t* src, uint8_t* dst, const int32_t width )
+    {
+        switch( target ){
+#if defined( COLOR_KERNEL_X86 )
+            case isa::avx2:
+            case isa::sse4_1:
+                return bgra_row_sse( src, dst, width );
+#endif
+#if defined( COLOR_KERNEL_NEON )
+            case isa::neon:
+                return bgra_row_neon( src, dst, width );
+#endif
+            default:
+                return bgra_row_scalar( src, dst, 0, width );
+        }
+    }
+
+    // Rows of Frame Converted in Parallel
+    // Body of cv::parallel_for_ (lambda is wrapped in std::function, which allocates for every frame)
+    class row_converter : public cv::ParallelLoopBody
+    {
+    private:
+        const format source;
+        const isa target;
+        const uint8_t* data;
+        const int32_t width;
+        const int32_t height;
+        cv::Mat& dst;
+
+    public:
+        // Constructor
+        row_converter( const format source, const isa target, const uint8_t* data, const int32_t width, const int32_t height, cv::Mat& dst )
+            : source( source ), target( target ), data( data ), width( width ), height( height ), dst( dst )
+        {
+        }
+
+        // Convert Rows
+        void operator()( const cv::Range& range ) const override
+        {
+            const size_t stride = static_cast<size_t>( width );
+            for( int32_t y = range.start; y < range.end; y++ ){
+                uint8_t* row = dst.ptr<uint8_t>( y );
+                switch( source ){
+                    case format::yuyv:
+                        yuv422_row<0, 1, 3>( target, data + y * stride * 2, row, width );
+                        break;
+                    case format::uyvy:
+                        yuv422_row<1, 0, 2>( target, data + y * stride * 2, row, width );
+                        break;
+                    case format::nv12:
+                        yuv420sp_row<0, 1>( target, data + y * stride, data + ( height + y / 2 ) * stride, row, width );
+                        break;
+                    case format::nv21:
+                        yuv420sp_row<1, 0>( target, data + y * stride, data + ( height + y / 2 ) * stride, row, width );
+                        break;
+                    case format::rgb:
+                        rgb_row( target, data + y * stride * 3, row, width );
+                        break;
+                    case format::bgra:
+                        bgra_row( target, data + y * stride * 4, row, width );
+                        break;
+                }
+            }
+        }
+    };
+
+    // Convert Frame Memory to BGR (dst is reused while its size and type match)
+    inline void convert( const format source, const void* src, const int32_t width, const int32_t height, cv::Mat& dst, const isa target = get_isa() )
+    {
+        if( !is_supported( target ) ){
+            throw std::runtime_error( "[error] instruction set is not supported by this cpu!" );
+        }
+
+        const bool is_yuv = ( source != format::rgb && source != format::bgra );
+        const bool is_420 = ( source == format::nv12 || source == format::nv21 );
+        if( ( is_yuv && width % 2 != 0 ) || ( is_420 && height % 2 != 0 ) ){
+            throw std::runtime_error( "[error] odd size of chroma subsampled format!" );
+        }
+
+        dst.create( height, width, CV_8UC3 );
+        cv::parallel_for_( cv::Range( 0, height ), row_converter( source, target, static_cast<const uint8_t*>( src ), width, height, dst ) );
+    }
+}
+
+#endif // __COLOR_KERNEL__
@@ -1,9 +1,19 @@
 #ifndef __ORBBEC__
 #define __ORBBEC__
 
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
 #include <libobsensor/ObSensor.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "ring_buffer.h"
+#include "triple_buffer.h"
+#include "stats.h"
+#include "frame_source.h"
+
 class orbbec
 {
 private:
@@ -16,12 +26,43 @@ private:
     std::shared_ptr<ob::Device > device = nullptr;
     std::shared_ptr<ob::Config> config = nullptr;
     std::shared_ptr<ob::FrameSet> frameset = nullptr;
+    std::shared_ptr<frame_source> source = nullptr;
+
+    // Mock
+    bool use_mock = false; // true: synthetic frames without device
+    uint32_t mock_fps = 30;
+
+    // Frame Queue
+    struct frame_packet
+    {
+        std::shared_ptr<ob::FrameSet> frameset = nullptr;
+        std::chrono::system_clock::time_point timestamp; // produced (system timestamp of frame)
+    };
+    enum class frame_policy { latest, all }; // latest frame wins, drop nothing
+    frame_policy policy = frame_policy::latest;
+    ring_buffer<frame_packet> frame_queue = ring_buffer<frame_packet>( 4 ); // all
+    triple_buffer<frame_packet> latest_frame; // latest (newest frame set replaces one not taken yet)
+
+    // Acquisition
+    bool use_callback = false; // true: frame sets are delivered by SDK callback, false: polling on acquisition thread
+    std::thread acquisition_thread;
+    std::atomic<bool> is_acquire = false;
+    std::atomic<bool> is_failed = false;
+    std::exception_ptr acquisition_error = nullptr; // thrown on acquisition thread, rethrown on main thread
+    std::atomic<uint64_t> acquired_frames = 0;
+    std::atomic<uint64_t> dropped_frames = 0; // queue full
+    std::atomic<uint64_t> skipped_frames = 0; // superseded by newer frame
+    latency_stats queue_stats; // from frame produced to taken by main loop
+    latency_stats draw_stats;
+    latency_stats show_stats;
 
     // Depth
     std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile = nullptr;
     std::shared_ptr<ob::DepthFrame> depth_frame = nullptr;
     cv::Mat depth;
+    cv::Mat depth_scaled;
     std::tuple<double, double> depth_range = std::make_tuple<double, double>( 0.0, 0.0 );
+    cv::Mat depth_lut;
 
 public:
     // Constructor
@@ -49,9 +90,21 @@ private:
     // Initialize Sensor
     void initialize_sensor();
 
+    // Initialize Mock
+    void initialize_mock();
+
+    // Initialize Acquisition
+    void initialize_acquisition();
+
     // Finalize
     void finalize();
 
+    // Acquire Frame
+    void acquire_frame();
+
+    // Push Frame
+    void push_frame( std::shared_ptr<ob::FrameSet> acquired_frameset );
+
     // Update Frame
     void update_frame();
 
@@ -66,6 +119,10 @@ private:
 
     // Get Depth Range
     std::tuple<double, double> get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile );
+    std::tuple<double, double> get_depth_range( const uint32_t width, const uint32_t height );
+
+    // Show Statistics
+    void show_statistics();
 };
 
 #endif // __ORBBEC__
@@ -0,0 +1,696 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include "util.h"
+#include "frame_source.h"
+
+// Heap Allocation Counter (operator new)
+std::atomic<uint64_t> heap_allocations = 0;
+
+void* operator new( std::size_t size )
+{
+    heap_allocations.fetch_add( 1, std::memory_order_relaxed );
+    void* pointer = std::malloc( size != 0 ? size : 1 );
+    if( pointer == nullptr ){
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete( void* pointer, std::size_t size ) noexcept
+{
+    std::free( pointer );
+}
+
+// cv::Mat Allocation Counter (cv::Mat buffers are not allocated by operator new)
+class counting_allocator : public cv::MatAllocator
+{
+public:
+    mutable std::atomic<uint64_t> allocations = 0;
+
+    cv::UMatData* allocate( int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usage ) const override
+    {
+        allocations.fetch_add( 1, std::memory_order_relaxed );
+        return cv::Mat::getStdAllocator()->allocate( dims, sizes, type, data, step, flags, usage );
+    }
+
+    bool allocate( cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usage ) const override
+    {
+        return cv::Mat::getStdAllocator()->allocate( data, flags, usage );
+    }
+
+    void deallocate( cv::UMatData* data ) const override
+    {
+        cv::Mat::getStdAllocator()->deallocate( data );
+    }
+};
+
+// Benchmark Case
+struct bench_case
+{
+    OBFrameType frame_type;
+    OBFormat format;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Conversion Mode
+enum class bench_mode { deep_copy, shallow_copy, reuse, converter, reduced, preview, convert_resize, cvt_color, kernel, convert_to, depth_lut, visualize_depth, visualize_colormap };
+
+// Benchmark Result
+struct bench_result
+{
+    bench_case setting;
+    bench_mode mode;
+    uint64_t iterations;
+    double ns_per_frame;
+    double mb_per_second;
+    double allocations_per_frame;
+    double copied_bytes_per_frame; // bytes of result outside of frame memory (0 if result is view of frame)
+    int32_t scale; // result is 1/scale size (preview and convert_resize)
+    double max_difference; // from convert-then-resize (preview), or from convertTo (visualize_depth)
+    color_kernel::isa isa; // instruction set of color kernel (kernel)
+};
+
+// To String
+std::string to_string( const OBFrameType frame_type )
+{
+    switch( frame_type ){
+        case OBFrameType::OB_FRAME_COLOR:
+            return "color";
+        case OBFrameType::OB_FRAME_DEPTH:
+            return "depth";
+        case OBFrameType::OB_FRAME_IR:
+            return "infrared";
+        default:
+            return "unknown";
+    }
+}
+
+std::string to_string( const OBFormat format )
+{
+    switch( format ){
+        case OBFormat::OB_FORMAT_YUYV:
+            return "YUYV";
+        case OBFormat::OB_FORMAT_YUY2:
+            return "YUY2";
+        case OBFormat::OB_FORMAT_UYVY:
+            return "UYVY";
+        case OBFormat::OB_FORMAT_NV12:
+            return "NV12";
+        case OBFormat::OB_FORMAT_NV21:
+            return "NV21";
+        case OBFormat::OB_FORMAT_I420:
+            return "I420";
+        case OBFormat::OB_FORMAT_MJPG:
+            return "MJPG";
+        case OBFormat::OB_FORMAT_GRAY:
+            return "GRAY";
+        case OBFormat::OB_FORMAT_RGB:
+            return "RGB";
+        case OBFormat::OB_FORMAT_BGR:
+            return "BGR";
+        case OBFormat::OB_FORMAT_BGRA:
+            return "BGRA";
+        case OBFormat::OB_FORMAT_Y16:
+            return "Y16";
+        case OBFormat::OB_FORMAT_Y14:
+            return "Y14";
+        case OBFormat::OB_FORMAT_Y12:
+            return "Y12";
+        case OBFormat::OB_FORMAT_Y11:
+            return "Y11";
+        case OBFormat::OB_FORMAT_Y10:
+            return "Y10";
+        case OBFormat::OB_FORMAT_Y8:
+            return "Y8";
+        default:
+            return "unknown";
+    }
+}
+
+std::string to_string( const bench_mode mode )
+{
+    switch( mode ){
+        case bench_mode::deep_copy:
+            return "deep_copy";
+        case bench_mode::shallow_copy:
+            return "shallow_copy";
+        case bench_mode::reuse:
+            return "reuse";
+        case bench_mode::converter:
+            return "converter";
+        case bench_mode::reduced:
+            return "reduced";
+        case bench_mode::preview:
+            return "preview";
+        case bench_mode::convert_resize:
+            return "convert_resize";
+        case bench_mode::cvt_color:
+            return "cvt_color";
+        case bench_mode::kernel:
+            return "kernel";
+        case bench_mode::convert_to:
+            return "convert_to";
+        case bench_mode::depth_lut:
+            return "depth_lut";
+        case bench_mode::visualize_depth:
+            return "visualize_depth";
+        case bench_mode::visualize_colormap:
+            return "visualize_colormap";
+        default:
+            return "unknown";
+    }
+}
+
+std::string to_string( const color_kernel::isa isa )
+{
+    switch( isa ){
+        case color_kernel::isa::scalar:
+            return "scalar";
+        case color_kernel::isa::sse4_1:
+            return "sse4_1";
+        case color_kernel::isa::avx2:
+            return "avx2";
+        case color_kernel::isa::neon:
+            return "neon";
+        default:
+            return "unknown";
+    }
+}
+
+std::string to_string( const color_kernel::format format )
+{
+    switch( format ){
+        case color_kernel::format::yuyv:
+            return "YUYV";
+        case color_kernel::format::uyvy:
+            return "UYVY";
+        case color_kernel::format::nv12:
+            return "NV12";
+        case color_kernel::format::nv21:
+            return "NV21";
+        case color_kernel::format::rgb:
+            return "RGB";
+        case color_kernel::format::bgra:
+            return "BGRA";
+        default:
+            return "unknown";
+    }
+}
+
+// Is Format Converted by Color Kernel
+bool is_kernel_format( const OBFormat format )
+{
+    return format == OBFormat::OB_FORMAT_YUYV || format == OBFormat::OB_FORMAT_YUY2 || format == OBFormat::OB_FORMAT_UYVY || format == OBFormat::OB_FORMAT_NV12 ||
+           format == OBFormat::OB_FORMAT_NV21 || format == OBFormat::OB_FORMAT_RGB || format == OBFormat::OB_FORMAT_BGRA;
+}
+
+// Format of Color Kernel
+color_kernel::format to_kernel_format( const OBFormat format )
+{
+    switch( format ){
+        case OBFormat::OB_FORMAT_YUYV:
+        case OBFormat::OB_FORMAT_YUY2:
+            return color_kernel::format::yuyv;
+        case OBFormat::OB_FORMAT_UYVY:
+            return color_kernel::format::uyvy;
+        case OBFormat::OB_FORMAT_NV12:
+            return color_kernel::format::nv12;
+        case OBFormat::OB_FORMAT_NV21:
+            return color_kernel::format::nv21;
+        case OBFormat::OB_FORMAT_RGB:
+            return color_kernel::format::rgb;
+        case OBFormat::OB_FORMAT_BGRA:
+            return color_kernel::format::bgra;
+        default:
+            throw std::runtime_error( "[error] format is not converted by color kernel!" );
+    }
+}
+
+// Convert Frame Memory to BGR by cv::cvtColor (reference of color kernel)
+void cvt_color( const color_kernel::format format, const void* data, const int32_t width, const int32_t height, cv::Mat& dst )
+{
+    uint8_t* src = reinterpret_cast<uint8_t*>( const_cast<void*>( data ) );
+    switch( format ){
+        case color_kernel::format::yuyv:
+            cv::cvtColor( cv::Mat( height, width, CV_8UC2, src ), dst, cv::COLOR_YUV2BGR_YUYV );
+            break;
+        case color_kernel::format::uyvy:
+            cv::cvtColor( cv::Mat( height, width, CV_8UC2, src ), dst, cv::COLOR_YUV2BGR_UYVY );
+            break;
+        case color_kernel::format::nv12:
+            cv::cvtColor( cv::Mat( height * 3 / 2, width, CV_8UC1, src ), dst, cv::COLOR_YUV2BGR_NV12 );
+            break;
+        case color_kernel::format::nv21:
+            cv::cvtColor( cv::Mat( height * 3 / 2, width, CV_8UC1, src ), dst, cv::COLOR_YUV2BGR_NV21 );
+            break;
+        case color_kernel::format::rgb:
+            cv::cvtColor( cv::Mat( height, width, CV_8UC3, src ), dst, cv::COLOR_RGB2BGR );
+            break;
+        case color_kernel::format::bgra:
+            cv::cvtColor( cv::Mat( height, width, CV_8UC4, src ), dst, cv::COLOR_BGRA2BGR );
+            break;
+    }
+}
+
+// Create Frames of Benchmark Case
+std::vector<std::shared_ptr<ob::VideoFrame>> create_frames( const bench_case& setting )
+{
+    const mock_source::stream stream = { setting.format, setting.width, setting.height };
+    const mock_source::stream disabled;
+    constexpr uint32_t fps = 1000000; // no pacing
+    mock_source source = mock_source( setting.frame_type == OBFrameType::OB_FRAME_COLOR ? stream : disabled,
+                                      setting.frame_type == OBFrameType::OB_FRAME_DEPTH ? stream : disabled,
+                                      setting.frame_type == OBFrameType::OB_FRAME_IR ? stream : disabled,
+                                      fps );
+    source.start();
+
+    std::vector<std::shared_ptr<ob::VideoFrame>> frames;
+    while( frames.size() < 8 ){
+        constexpr uint32_t timeout = 100;
+        std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+        if( frameset == nullptr ){
+            continue;
+        }
+
+        switch( setting.frame_type ){
+            case OBFrameType::OB_FRAME_COLOR:
+                frames.push_back( frameset->colorFrame() );
+                break;
+            case OBFrameType::OB_FRAME_DEPTH:
+                frames.push_back( frameset->depthFrame() );
+                break;
+            case OBFrameType::OB_FRAME_IR:
+                frames.push_back( frameset->irFrame() );
+                break;
+            default:
+                throw std::runtime_error( "[error] unknown frame type!" );
+        }
+    }
+
+    source.stop();
+    return frames;
+}
+
+// Run Benchmark Case
+bench_result run( const bench_case& setting, const bench_mode mode, const counting_allocator& allocator, const int32_t scale = 1, const color_kernel::isa isa = color_kernel::get_isa() )
+{
+    const std::vector<std::shared_ptr<ob::VideoFrame>> frames = create_frames( setting );
+
+    // Converter is created once for stream
+    const std::unique_ptr<ob::frame_converter> converter = ob::create_converter( setting.frame_type, setting.format, setting.width, setting.height );
+    const std::unique_ptr<ob::frame_converter> preview = ( mode == bench_mode::preview ) ? ob::create_preview_converter( setting.format, setting.width, setting.height, scale ) : nullptr;
+    const cv::Size target = cv::Size( setting.width / scale, setting.height / scale );
+
+    // Look-up table is created once for depth range (same range as samples)
+    constexpr double max_range = 5460.0;
+    const cv::Mat depth_lut = ( mode == bench_mode::visualize_depth ) ? ob::create_depth_lut( max_range ) :
+                              ( mode == bench_mode::visualize_colormap ) ? ob::create_depth_lut( max_range, cv::COLORMAP_JET ) : cv::Mat();
+
+    cv::Mat mat;
+    cv::Mat converted; // full resolution (convert_resize)
+    const auto convert = [&]( const std::shared_ptr<ob::VideoFrame>& frame ){
+        switch( mode ){
+            case bench_mode::deep_copy:
+                mat = ob::get_mat( frame, true );
+                break;
+            case bench_mode::shallow_copy:
+                mat = ob::get_mat( frame, false );
+                break;
+            case bench_mode::reuse:
+                ob::get_mat( frame, mat );
+                break;
+            case bench_mode::converter:
+                converter->convert( frame, mat );
+                break;
+            case bench_mode::reduced:
+                ob::decode_mjpg( frame, mat, 4 );
+                break;
+            case bench_mode::preview:
+                preview->convert( frame, mat );
+                break;
+            case bench_mode::convert_resize:
+                converter->convert( frame, converted );
+                cv::resize( converted, mat, target, 0.0, 0.0, cv::INTER_NEAREST );
+                break;
+            case bench_mode::cvt_color:
+                cvt_color( to_kernel_format( setting.format ), frame->data(), setting.width, setting.height, mat );
+                break;
+            case bench_mode::kernel:
+                color_kernel::convert( to_kernel_format( setting.format ), frame->data(), setting.width, setting.height, mat, isa );
+                break;
+            case bench_mode::convert_to:
+                ob::get_mat( frame, false ).convertTo( mat, CV_8U, -255.0 / max_range, 255.0 );
+                break;
+            case bench_mode::depth_lut:
+                mat = ob::create_depth_lut( max_range );
+                break;
+            case bench_mode::visualize_depth:
+            case bench_mode::visualize_colormap:
+                ob::visualize_depth( ob::get_mat( frame, false ), depth_lut, mat );
+                break;
+        }
+    };
+
+    // Warm Up (and count bytes of result that are not frame memory)
+    uint64_t copied_bytes = 0;
+    for( const std::shared_ptr<ob::VideoFrame>& frame : frames ){
+        convert( frame );
+        const uint8_t* begin = reinterpret_cast<const uint8_t*>( frame->data() );
+        const uint8_t* end = begin + frame->dataSize();
+        if( mat.data < begin || end <= mat.data ){
+            copied_bytes += mat.total() * mat.elemSize();
+        }
+    }
+
+    // Difference of Preview from Convert-then-Resize
+    double max_difference = 0.0;
+    if( mode == bench_mode::preview ){
+        cv::Mat reference;
+        converter->convert( frames.back(), converted );
+        cv::resize( converted, reference, target, 0.0, 0.0, cv::INTER_NEAREST );
+        max_difference = cv::norm( mat, reference, cv::NORM_INF );
+    }
+
+    // Difference of Look-Up Table from convertTo (except invalid depth, that is black in look-up table)
+    if( mode == bench_mode::visualize_depth ){
+        const cv::Mat depth = ob::get_mat( frames.back(), false );
+        cv::Mat reference;
+        depth.convertTo( reference, CV_8U, -255.0 / max_range, 255.0 );
+        reference.setTo( 0, depth == 0 );
+        max_difference = cv::norm( mat, reference, cv::NORM_INF );
+    }
+
+    // Measure
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 500 );
+    uint64_t iterations = 0;
+    uint64_t bytes = 0;
+
+    const uint64_t heap_start = heap_allocations.load();
+    const uint64_t mat_start = allocator.allocations.load();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = start;
+    while( end - start < duration ){
+        const std::shared_ptr<ob::VideoFrame>& frame = frames[iterations % frames.size()];
+        convert( frame );
+        bytes += frame->dataSize();
+        iterations++;
+        end = std::chrono::steady_clock::now();
+    }
+    const uint64_t allocations = ( heap_allocations.load() - heap_start ) + ( allocator.allocations.load() - mat_start );
+
+    const double elapsed = std::chrono::duration<double, std::nano>( end - start ).count();
+    bench_result result;
+    result.setting = setting;
+    result.mode = mode;
+    result.iterations = iterations;
+    result.ns_per_frame = elapsed / iterations;
+    result.mb_per_second = ( bytes / ( 1024.0 * 1024.0 ) ) / ( elapsed * 1e-9 );
+    result.allocations_per_frame = static_cast<double>( allocations ) / iterations;
+    result.copied_bytes_per_frame = static_cast<double>( copied_bytes ) / frames.size();
+    result.scale = scale;
+    result.max_difference = max_difference;
+    result.isa = isa;
+    return result;
+}
+
+// Validate View of Frame (pass-through formats)
+// View must not copy, and must keep frame alive after all other references are released.
+void validate_view( const bench_case& setting )
+{
+    std::vector<std::shared_ptr<ob::VideoFrame>> frames = create_frames( setting );
+    const int32_t type = ob::get_mat_type( setting.frame_type, setting.format );
+    if( type == -1 ){
+        return;
+    }
+
+    const cv::Mat expected = cv::Mat( setting.height, setting.width, type, frames.front()->data() ).clone();
+    cv::Mat view = ob::get_mat( frames.front(), false );
+    if( view.data != frames.front()->data() ){
+        throw std::runtime_error( "[error] view of frame is copied!" );
+    }
+
+    const std::weak_ptr<ob::VideoFrame> frame = frames.front();
+    frames.clear();
+    if( frame.expired() || cv::norm( view, expected, cv::NORM_INF ) != 0.0 ){
+        throw std::runtime_error( "[error] view does not keep frame alive!" );
+    }
+
+    // Copy of View Shares Frame
+    cv::Mat copy = view;
+    view.release();
+    if( frame.expired() || cv::norm( copy, expected, cv::NORM_INF ) != 0.0 ){
+        throw std::runtime_error( "[error] copy of view does not keep frame alive!" );
+    }
+
+    copy.release();
+    if( !frame.expired() ){
+        throw std::runtime_error( "[error] view does not release frame!" );
+    }
+}
+
+// Validate Color Kernels (bit-exact with cv::cvtColor for every supported instruction set)
+// Random frames of widths that are not multiple of SIMD width and few rows cover remaining pixels of SIMD kernels and parallel rows.
+// Odd sizes are converted for RGB and BGRA, and must be rejected for chroma subsampled formats (odd width of 4:2:2 and 4:2:0, odd height of 4:2:0).
+void validate_kernel()
+{
+    const std::vector<cv::Size> resolutions = { cv::Size( 1280, 720 ), cv::Size( 38, 6 ), cv::Size( 50, 4 ), cv::Size( 16, 2 ), cv::Size( 6, 2 ), cv::Size( 2, 2 ),
+                                                cv::Size( 37, 6 ), cv::Size( 15, 2 ), cv::Size( 38, 3 ), cv::Size( 1, 1 ) };
+    const std::vector<color_kernel::format> formats = { color_kernel::format::yuyv, color_kernel::format::uyvy, color_kernel::format::nv12,
+                                                        color_kernel::format::nv21, color_kernel::format::rgb, color_kernel::format::bgra };
+    const std::vector<color_kernel::isa> isas = { color_kernel::isa::scalar, color_kernel::isa::sse4_1, color_kernel::isa::avx2, color_kernel::isa::neon };
+
+    cv::RNG rng( 0 );
+    for( const cv::Size& resolution : resolutions ){
+        // Largest frame of formats (BGRA), other formats use front of it
+        cv::Mat data( 1, resolution.width * resolution.height * 4, CV_8UC1 );
+        rng.fill( data, cv::RNG::UNIFORM, 0, 256 );
+
+        for( const color_kernel::format format : formats ){
+            // Odd Size of Chroma Subsampled Format
+            const bool is_yuv = ( format != color_kernel::format::rgb && format != color_kernel::format::bgra );
+            const bool is_420 = ( format == color_kernel::format::nv12 || format == color_kernel::format::nv21 );
+            if( ( is_yuv && resolution.width % 2 != 0 ) || ( is_420 && resolution.height % 2 != 0 ) ){
+                for( const color_kernel::isa isa : isas ){
+                    if( !color_kernel::is_supported( isa ) ){
+                        continue;
+                    }
+
+                    bool is_rejected = false;
+                    try{
+                        cv::Mat actual;
+                        color_kernel::convert( format, data.data, resolution.width, resolution.height, actual, isa );
+                    }
+                    catch( const std::runtime_error& error ){
+                        is_rejected = std::string( error.what() ) == "[error] odd size of chroma subsampled format!";
+                    }
+                    if( !is_rejected ){
+                        throw std::runtime_error( "[error] color kernel (" + to_string( isa ) + ") does not reject odd size (" + to_string( format ) + " " +
+                                                  std::to_string( resolution.width ) + "x" + std::to_string( resolution.height ) + ")!" );
+                    }
+                }
+                continue;
+            }
+
+            cv::Mat expected;
+            cvt_color( format, data.data, resolution.width, resolution.height, expected );
+
+            for( const color_kernel::isa isa : isas ){
+                if( !color_kernel::is_supported( isa ) ){
+                    continue;
+                }
+
+                cv::Mat actual;
+                color_kernel::convert( format, data.data, resolution.width, resolution.height, actual, isa );
+                if( actual.size() != expected.size() || cv::norm( actual, expected, cv::NORM_INF ) != 0.0 ){
+                    throw std::runtime_error( "[error] color kernel (" + to_string( isa ) + ") differs from cv::cvtColor (" + to_string( format ) + " " +
+                                              std::to_string( resolution.width ) + "x" + std::to_string( resolution.height ) + ")!" );
+                }
+            }
+        }
+    }
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"opencv\": \"" << CV_VERSION << "\",\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"frame_type\": \"" << to_string( result.setting.frame_type ) << "\", ";
+        stream << "\"format\": \"" << to_string( result.setting.format ) << "\", ";
+        stream << "\"width\": " << result.setting.width << ", ";
+        stream << "\"height\": " << result.setting.height << ", ";
+        stream << "\"mode\": \"" << to_string( result.mode ) << "\", ";
+        stream << "\"iterations\": " << result.iterations << ", ";
+        stream << "\"ns_per_frame\": " << result.ns_per_frame << ", ";
+        stream << "\"mb_per_second\": " << result.mb_per_second << ", ";
+        stream << "\"allocations_per_frame\": " << result.allocations_per_frame << ", ";
+        stream << "\"copied_bytes_per_frame\": " << result.copied_bytes_per_frame << ", ";
+        stream << "\"scale\": " << result.scale << ", ";
+        stream << "\"max_difference\": " << result.max_difference << ", ";
+        stream << "\"isa\": \"" << to_string( result.isa ) << "\"";
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        // Count cv::Mat Allocations
+        static counting_allocator allocator;
+        cv::Mat::setDefaultAllocator( &allocator );
+
+        // Benchmark Cases (all formats converted by ob::get_mat at resolutions of femto mega)
+        // Small resolutions are not supported by femto mega, but show per-frame overhead of dispatch (get_mat vs converter).
+        // Formats not supported by femto mega (e.g. YUY2, NV21, I420, GRAY, Y10-Y14 and MJPG of infrared) cover other paths of get_mat.
+        std::vector<bench_case> cases;
+        const std::vector<cv::Size> color_resolutions = { cv::Size( 160, 120 ), cv::Size( 320, 240 ), cv::Size( 1280, 720 ), cv::Size( 1920, 1080 ), cv::Size( 3840, 2160 ) };
+        const std::vector<OBFormat> color_formats = { OBFormat::OB_FORMAT_YUYV, OBFormat::OB_FORMAT_YUY2, OBFormat::OB_FORMAT_UYVY, OBFormat::OB_FORMAT_NV12,
+                                                      OBFormat::OB_FORMAT_NV21, OBFormat::OB_FORMAT_I420, OBFormat::OB_FORMAT_MJPG, OBFormat::OB_FORMAT_GRAY,
+                                                      OBFormat::OB_FORMAT_RGB, OBFormat::OB_FORMAT_BGR, OBFormat::OB_FORMAT_BGRA };
+        for( const OBFormat format : color_formats ){
+            for( const cv::Size& resolution : color_resolutions ){
+                cases.push_back( { OBFrameType::OB_FRAME_COLOR, format, static_cast<uint32_t>( resolution.width ), static_cast<uint32_t>( resolution.height ) } );
+            }
+        }
+
+        const std::vector<cv::Size> depth_resolutions = { cv::Size( 320, 288 ), cv::Size( 512, 512 ), cv::Size( 640, 576 ), cv::Size( 1024, 1024 ) };
+        const std::vector<OBFormat> depth_formats = { OBFormat::OB_FORMAT_Y16, OBFormat::OB_FORMAT_Y14, OBFormat::OB_FORMAT_Y12, OBFormat::OB_FORMAT_Y11,
+                                                      OBFormat::OB_FORMAT_Y10, OBFormat::OB_FORMAT_Y8 };
+        for( const OBFormat format : depth_formats ){
+            for( const cv::Size& resolution : depth_resolutions ){
+                cases.push_back( { OBFrameType::OB_FRAME_DEPTH, format, static_cast<uint32_t>( resolution.width ), static_cast<uint32_t>( resolution.height ) } );
+            }
+        }
+        for( const OBFormat format : { OBFormat::OB_FORMAT_Y16, OBFormat::OB_FORMAT_Y8, OBFormat::OB_FORMAT_MJPG } ){
+            for( const cv::Size& resolution : depth_resolutions ){
+                cases.push_back( { OBFrameType::OB_FRAME_IR, format, static_cast<uint32_t>( resolution.width ), static_cast<uint32_t>( resolution.height ) } );
+            }
+        }
+
+        // Color Kernels must be Bit-Exact with cv::cvtColor
+        validate_kernel();
+
+        // Run Benchmark
+        std::vector<bench_result> results;
+        for( const bench_case& setting : cases ){
+            validate_view( setting );
+            for( const bench_mode mode : { bench_mode::deep_copy, bench_mode::shallow_copy, bench_mode::reuse, bench_mode::converter } ){
+                const bench_result result = run( setting, mode, allocator );
+                std::cerr << to_string( setting.frame_type ) << " " << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " " << to_string( mode )
+                          << " : " << result.ns_per_frame << " ns/frame, " << result.copied_bytes_per_frame << " bytes copied/frame" << std::endl;
+                results.push_back( result );
+
+                // Caller-Owned Destination must not Allocate after Warm Up (synthetic YUYV, NV12 and BGRA)
+                const bool is_zero_allocation = ( setting.frame_type == OBFrameType::OB_FRAME_COLOR ) &&
+                                                ( setting.format == OBFormat::OB_FORMAT_YUYV || setting.format == OBFormat::OB_FORMAT_NV12 || setting.format == OBFormat::OB_FORMAT_BGRA );
+                if( mode == bench_mode::reuse && is_zero_allocation && result.allocations_per_frame != 0.0 ){
+                    throw std::runtime_error( "[error] get_mat allocates " + std::to_string( result.allocations_per_frame ) + " times per frame after warm up (" + to_string( setting.format ) + ")!" );
+                }
+            }
+
+            // Color Kernel of each Instruction Set vs cv::cvtColor
+            if( setting.frame_type == OBFrameType::OB_FRAME_COLOR && is_kernel_format( setting.format ) ){
+                const bench_result reference = run( setting, bench_mode::cvt_color, allocator );
+                std::cerr << to_string( setting.frame_type ) << " " << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " " << to_string( bench_mode::cvt_color )
+                          << " : " << reference.ns_per_frame << " ns/frame" << std::endl;
+                results.push_back( reference );
+
+                for( const color_kernel::isa isa : { color_kernel::isa::scalar, color_kernel::isa::sse4_1, color_kernel::isa::avx2, color_kernel::isa::neon } ){
+                    if( !color_kernel::is_supported( isa ) ){
+                        continue;
+                    }
+
+                    const bench_result result = run( setting, bench_mode::kernel, allocator, 1, isa );
+                    std::cerr << to_string( setting.frame_type ) << " " << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " " << to_string( bench_mode::kernel ) << " " << to_string( isa )
+                              << " : " << result.ns_per_frame << " ns/frame (" << reference.ns_per_frame / result.ns_per_frame << "x of cv::cvtColor)" << std::endl;
+                    results.push_back( result );
+                }
+            }
+
+            // Depth Visualization (look-up table vs convertTo every frame, and cost of creating look-up table)
+            // Look-up table is indexed by 16-bit depth, so Y8 is not visualized.
+            if( setting.frame_type == OBFrameType::OB_FRAME_DEPTH && ob::get_mat_type( setting.frame_type, setting.format ) == CV_16UC1 ){
+                for( const bench_mode mode : { bench_mode::convert_to, bench_mode::depth_lut, bench_mode::visualize_depth, bench_mode::visualize_colormap } ){
+                    const bench_result result = run( setting, mode, allocator );
+                    std::cerr << to_string( setting.frame_type ) << " " << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " " << to_string( mode )
+                              << " : " << result.ns_per_frame << " ns/frame, " << result.mb_per_second << " MB/s, max difference " << result.max_difference << std::endl;
+                    results.push_back( result );
+
+                    // Look-up table must match convertTo (except rounding, convertTo scales in float)
+                    if( mode == bench_mode::visualize_depth && result.max_difference > 1.0 ){
+                        throw std::runtime_error( "[error] depth visualized by look-up table differs from convertTo!" );
+                    }
+                }
+            }
+
+            // MJPG decoded at 1/4 resolution for preview
+            if( setting.format == OBFormat::OB_FORMAT_MJPG ){
+                const bench_result result = run( setting, bench_mode::reduced, allocator );
+                std::cerr << to_string( setting.frame_type ) << " " << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " " << to_string( bench_mode::reduced )
+                          << " : " << result.ns_per_frame << " ns/frame" << std::endl;
+                results.push_back( result );
+            }
+
+            // Preview of Color (converted and downscaled in one pass vs converted then resized)
+            if( setting.frame_type == OBFrameType::OB_FRAME_COLOR ){
+                for( const int32_t scale : { 2, 4 } ){
+                    for( const bench_mode mode : { bench_mode::preview, bench_mode::convert_resize } ){
+                        const bench_result result = run( setting, mode, allocator, scale );
+                        std::cerr << to_string( setting.frame_type ) << " " << to_string( setting.format ) << " " << setting.width << "x" << setting.height << " " << to_string( mode ) << " 1/" << scale
+                                  << " : " << result.ns_per_frame << " ns/frame, " << result.allocations_per_frame << " allocations/frame, max difference " << result.max_difference << std::endl;
+                        results.push_back( result );
+
+                        // Preview must match convert-then-resize except MJPG (decoded by DCT scaling)
+                        if( mode == bench_mode::preview && setting.format != OBFormat::OB_FORMAT_MJPG && result.max_difference > 1.0 ){
+                            throw std::runtime_error( "[error] preview differs from convert-then-resize!" );
+                        }
+
+                        // Preview converted in one pass must not Allocate after Warm Up (formats except MJPG, I420 and GRAY that are converted then resized)
+                        const bool is_zero_allocation = setting.format != OBFormat::OB_FORMAT_MJPG && setting.format != OBFormat::OB_FORMAT_I420 && setting.format != OBFormat::OB_FORMAT_GRAY;
+                        if( mode == bench_mode::preview && is_zero_allocation && result.allocations_per_frame != 0.0 ){
+                            throw std::runtime_error( "[error] preview allocates " + std::to_string( result.allocations_per_frame ) + " times per frame after warm up (" + to_string( setting.format ) + ")!" );
+                        }
+                    }
+                }
+            }
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
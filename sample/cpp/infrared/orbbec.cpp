@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <chrono>
+#include <iostream>
 
 // Constructor
 orbbec::orbbec()
@@ -20,8 +21,17 @@ orbbec::~orbbec()
 // Initialize
 void orbbec::initialize()
 {
-    // Initialize Sensor
-    initialize_sensor();
+    if( use_mock ){
+        // Initialize Mock
+        initialize_mock();
+    }
+    else{
+        // Initialize Sensor
+        initialize_sensor();
+    }
+
+    // Initialize Acquisition
+    initialize_acquisition();
 }
 
 // Initialize Sensor
@@ -58,15 +68,65 @@ inline void orbbec::initialize_sensor()
     config = std::make_shared<ob::Config>();
     config->enableStream( infrared_stream_profile );
 
-    // Start Pipeline
-    pipeline->start( config );
+    // Create Frame Source
+    source = std::make_shared<pipeline_source>( pipeline, config );
+}
+
+// Initialize Mock
+void orbbec::initialize_mock()
+{
+    // Create Mock Source
+    const mock_source::stream infrared_stream = { OBFormat::OB_FORMAT_Y16, 320, 288 };
+    source = std::make_shared<mock_source>( mock_source::stream(), mock_source::stream(), infrared_stream, mock_fps );
+}
+
+// Initialize Acquisition
+void orbbec::initialize_acquisition()
+{
+    // Start Frame Source
+    is_acquire = true;
+    if( use_callback ){
+        // Frame sets are pushed to queue directly on source thread without polling
+        source->start( [&]( std::shared_ptr<ob::FrameSet> acquired_frameset ){
+            push_frame( acquired_frameset );
+        } );
+        return;
+    }
+    source->start();
+
+    // Start Acquisition Thread
+    acquisition_thread = std::thread( [&](){
+        // Errors are forwarded to main thread (exception must not escape thread)
+        try{
+            while( is_acquire ){
+                acquire_frame();
+            }
+        }
+        catch( const ob::Error& error ){
+            acquisition_error = std::make_exception_ptr( std::runtime_error( std::string( "[error] " ) + error.getMessage() ) );
+            is_failed.store( true, std::memory_order_release );
+        }
+        catch( ... ){
+            acquisition_error = std::current_exception();
+            is_failed.store( true, std::memory_order_release );
+        }
+    } );
 }
 
 // Finalize
 void orbbec::finalize()
 {
-    // Stop Pipeline
-    pipeline->stop();
+    // Stop Acquisition Thread
+    is_acquire = false;
+    if( acquisition_thread.joinable() ){
+        acquisition_thread.join();
+    }
+
+    // Stop Frame Source
+    source->stop();
+
+    // Show Statistics
+    show_statistics();
 }
 
 // Run
@@ -77,11 +137,17 @@ void orbbec::run()
         // Update
         update();
 
-        // Draw
-        draw();
+        if( frameset != nullptr ){
+            // Draw
+            const std::chrono::steady_clock::time_point draw_start = std::chrono::steady_clock::now();
+            draw();
+            draw_stats.add( std::chrono::steady_clock::now() - draw_start );
 
-        // Show
-        show();
+            // Show
+            const std::chrono::steady_clock::time_point show_start = std::chrono::steady_clock::now();
+            show();
+            show_stats.add( std::chrono::steady_clock::now() - show_start );
+        }
 
         // Wait Key
         constexpr int32_t delay = 10;
@@ -102,12 +168,80 @@ void orbbec::update()
     update_infrared();
 }
 
+// Acquire Frame
+inline void orbbec::acquire_frame()
+{
+    // Get Frame Set
+    constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
+    std::shared_ptr<ob::FrameSet> acquired_frameset = source->wait_for_frames( timeout );
+    if( acquired_frameset == nullptr ){
+        return;
+    }
+
+    // Push Frame
+    push_frame( acquired_frameset );
+}
+
+// Push Frame
+inline void orbbec::push_frame( std::shared_ptr<ob::FrameSet> acquired_frameset )
+{
+    acquired_frames++;
+
+    // Stamp Frame Set with Time It was Produced (system timestamp of frame [ms]), so latency includes delivery by SDK
+    const std::shared_ptr<ob::Frame> frame = acquired_frameset->irFrame();
+    const std::chrono::system_clock::time_point timestamp = ( frame != nullptr ) ? std::chrono::system_clock::time_point( std::chrono::milliseconds( frame->systemTimeStamp() ) ) : std::chrono::system_clock::now();
+    frame_packet packet = { acquired_frameset, timestamp };
+
+    if( policy == frame_policy::latest ){
+        // Publish Frame Set (replaces frame set that is not taken yet, so newest frame set always survives)
+        latest_frame.write_buffer() = std::move( packet );
+        latest_frame.publish();
+
+        // Release Superseded Frame Set (consumer clears frame set it has taken)
+        frame_packet& superseded = latest_frame.write_buffer();
+        if( superseded.frameset != nullptr ){
+            skipped_frames++;
+        }
+        superseded = frame_packet();
+        return;
+    }
+
+    // Push Frame Set to Queue (wait until queue has space)
+    while( !frame_queue.push( std::move( packet ) ) ){
+        if( !is_acquire ){
+            dropped_frames++;
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
 // Update Frame
 inline void orbbec::update_frame()
 {
+    // Rethrow Error of Acquisition Thread
+    if( is_failed.load( std::memory_order_acquire ) ){
+        std::rethrow_exception( acquisition_error );
+    }
+
     // Get Frame Set
-    constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
-    frameset = pipeline->waitForFrames( timeout );
+    frame_packet packet;
+    if( policy == frame_policy::latest ){
+        // Take Latest Frame Set
+        if( latest_frame.update() ){
+            packet = std::move( latest_frame.read_buffer() );
+            latest_frame.read_buffer() = frame_packet();
+        }
+    }
+    else{
+        // Process All Frames in Order
+        frame_queue.pop( packet );
+    }
+    frameset = packet.frameset;
+
+    if( frameset != nullptr ){
+        queue_stats.add( std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::system_clock::now() - packet.timestamp ) );
+    }
 }
 
 // Update Infrared
@@ -135,8 +269,8 @@ inline void orbbec::draw_infrared()
         return;
     }
 
-    // Get cv::Mat from ob::VideoFrame
-    infrared = ob::get_mat( infrared_frame );
+    // Get cv::Mat from ob::VideoFrame (Y16/Y8 is view of frame without copy)
+    infrared = ob::get_mat( infrared_frame, false );
 }
 
 // Show
@@ -154,9 +288,18 @@ inline void orbbec::show_infrared()
     }
 
     // Scaling Infrared
-    infrared.convertTo( infrared, CV_8U, 0.5 );
+    infrared.convertTo( infrared_scaled, CV_8U, 0.5 );
 
     // Show Image
     const cv::String window_name = cv::format( "infrared (orbbec %d)", device_index );
-    cv::imshow( window_name, infrared );
+    cv::imshow( window_name, infrared_scaled );
+}
+
+// Show Statistics
+void orbbec::show_statistics()
+{
+    std::cout << "[info] acquired " << acquired_frames << " frames, dropped " << dropped_frames << " frames, skipped " << skipped_frames << " frames" << std::endl;
+    std::cout << "[info] queue : " << queue_stats.to_string() << std::endl;
+    std::cout << "[info] draw  : " << draw_stats.to_string() << std::endl;
+    std::cout << "[info] show  : " << show_stats.to_string() << std::endl;
 }
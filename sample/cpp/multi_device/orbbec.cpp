@@ -0,0 +1,254 @@
+#include "orbbec.hpp"
+#include "util.h"
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+// Constructor
+orbbec::orbbec()
+{
+    // Initialize
+    initialize();
+}
+
+orbbec::~orbbec()
+{
+    // Finalize
+    finalize();
+}
+
+// Initialize
+void orbbec::initialize()
+{
+    if( use_mock ){
+        // Initialize Mock
+        initialize_mock();
+    }
+    else{
+        // Initialize Sensor
+        initialize_sensor();
+    }
+
+    // Start Acquisition of All Devices
+    views.resize( manager.size() );
+    manager.start();
+}
+
+// Initialize Sensor
+inline void orbbec::initialize_sensor()
+{
+    // Open All Connected Devices with Same Stream Profiles
+    manager.open_devices( context, []( std::shared_ptr<ob::Pipeline> pipeline ){
+        // Get Stream Profile
+        std::shared_ptr<ob::VideoStreamProfile> color_stream_profile = nullptr;
+        const std::shared_ptr<ob::StreamProfileList> color_stream_profile_list = pipeline->getStreamProfileList( OBSensorType::OB_SENSOR_COLOR );
+        try{
+            color_stream_profile = color_stream_profile_list->getVideoStreamProfile( 1280, 720, OBFormat::OB_FORMAT_BGRA, 30 );
+        }
+        catch( ob::Error& e ){
+            color_stream_profile = std::const_pointer_cast<ob::StreamProfile>( color_stream_profile_list->getProfile( 0 ) )->as<ob::VideoStreamProfile>(); // default
+        }
+
+        std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile = nullptr;
+        const std::shared_ptr<ob::StreamProfileList> depth_stream_profile_list = pipeline->getStreamProfileList( OBSensorType::OB_SENSOR_DEPTH );
+        try{
+            depth_stream_profile = depth_stream_profile_list->getVideoStreamProfile( 320, 288, OBFormat::OB_FORMAT_Y16, 30 );
+        }
+        catch( ob::Error& e ){
+            depth_stream_profile = std::const_pointer_cast<ob::StreamProfile>( depth_stream_profile_list->getProfile( 0 ) )->as<ob::VideoStreamProfile>(); // default
+        }
+
+        // Set Stream Profile
+        std::shared_ptr<ob::Config> config = std::make_shared<ob::Config>();
+        config->enableStream( color_stream_profile );
+        config->enableStream( depth_stream_profile );
+        return config;
+    } );
+
+    std::cout << "[info] opened " << manager.size() << " devices" << std::endl;
+}
+
+// Initialize Mock
+void orbbec::initialize_mock()
+{
+    // Open Mock Devices
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_BGRA, 1280, 720 };
+    const mock_source::stream depth_stream = { OBFormat::OB_FORMAT_Y16, 320, 288 };
+    manager.open_mock( mock_devices, color_stream, depth_stream, mock_source::stream(), mock_fps );
+}
+
+// Finalize
+void orbbec::finalize()
+{
+    // Stop Acquisition of All Devices
+    manager.stop();
+
+    // Show Statistics
+    show_statistics();
+}
+
+// Run
+void orbbec::run()
+{
+    // Main Loop
+    while( true ){
+        // Update
+        update();
+
+        // Draw
+        const std::chrono::steady_clock::time_point draw_start = std::chrono::steady_clock::now();
+        draw();
+        draw_stats.add( std::chrono::steady_clock::now() - draw_start );
+
+        // Show
+        const std::chrono::steady_clock::time_point show_start = std::chrono::steady_clock::now();
+        show();
+        show_stats.add( std::chrono::steady_clock::now() - show_start );
+
+        // Wait Key
+        constexpr int32_t delay = 10;
+        const int32_t key = cv::waitKey( delay );
+        if( key == 'q' ){
+            break;
+        }
+    }
+}
+
+// Update
+void orbbec::update()
+{
+    // Update Frame
+    update_frame();
+}
+
+// Update Frame
+inline void orbbec::update_frame()
+{
+    // Get Frame Sets of All Devices in Timestamp Order
+    // Each device keeps newest frames, older frame sets are superseded.
+    constexpr uint32_t timeout = 0;
+    while( manager.wait_for_frameset( merged, timeout ) ){
+        device_view& view = views[merged.device_index];
+        view.color_frame = merged.frameset->colorFrame();
+        view.depth_frame = merged.frameset->depthFrame();
+        view.is_updated = true;
+        updated_framesets++;
+    }
+}
+
+// Draw
+void orbbec::draw()
+{
+    for( device_view& view : views ){
+        if( !view.is_updated ){
+            continue;
+        }
+
+        // Draw Color
+        draw_color( view );
+
+        // Draw Depth
+        draw_depth( view );
+    }
+}
+
+// Draw Color
+inline void orbbec::draw_color( device_view& view )
+{
+    if( view.color_frame == nullptr ){
+        return;
+    }
+
+    // Get cv::Mat from ob::VideoFrame
+    ob::get_mat( view.color_frame, view.color );
+}
+
+// Draw Depth
+inline void orbbec::draw_depth( device_view& view )
+{
+    if( view.depth_frame == nullptr ){
+        return;
+    }
+
+    // Get cv::Mat from ob::VideoFrame
+    ob::get_mat( view.depth_frame, view.depth );
+}
+
+// Show
+void orbbec::show()
+{
+    for( uint32_t i = 0; i < views.size(); i++ ){
+        device_view& view = views[i];
+        if( !view.is_updated ){
+            continue;
+        }
+
+        // Show Color
+        show_color( view, i );
+
+        // Show Depth
+        show_depth( view, i );
+
+        view.is_updated = false;
+    }
+}
+
+// Show Color
+inline void orbbec::show_color( const device_view& view, const uint32_t device_index )
+{
+    if( view.color.empty() ){
+        return;
+    }
+
+    // Show Image
+    const cv::String window_name = cv::format( "color (%s)", manager.name( device_index ).c_str() );
+    cv::imshow( window_name, view.color );
+}
+
+// Show Depth
+inline void orbbec::show_depth( device_view& view, const uint32_t device_index )
+{
+    if( view.depth.empty() ){
+        return;
+    }
+
+    // Scaling Depth
+    if( view.depth_lut.empty() ){
+        const double max_range = std::get<1>( get_depth_range( view.depth.cols, view.depth.rows ) );
+        view.depth_lut = ob::create_depth_lut( max_range );
+    }
+    ob::visualize_depth( view.depth, view.depth_lut, view.depth_scaled );
+
+    // Show Image
+    const cv::String window_name = cv::format( "depth (%s)", manager.name( device_index ).c_str() );
+    cv::imshow( window_name, view.depth_scaled );
+}
+
+// Get Depth Range
+inline std::tuple<double, double> orbbec::get_depth_range( const uint32_t width, const uint32_t height )
+{
+    if( width == 320 && height == 288 ){
+        return std::make_tuple( 500.0, 5460.0 );
+    }
+    if( width == 512 && height == 512 ){
+        return std::make_tuple( 250.0, 2880.0 );
+    }
+    if( width == 640 && height == 576 ){
+        return std::make_tuple( 500.0, 3860.0 );
+    }
+    if( width == 1024 && height == 1024 ){
+        return std::make_tuple( 250.0, 2210.0 );
+    }
+
+    throw std::runtime_error( "[error] unknown depth format!" );
+}
+
+// Show Statistics
+void orbbec::show_statistics()
+{
+    std::cout << "[info] " << manager.size() << " devices, updated " << updated_framesets << " frame sets" << std::endl;
+    std::cout << "[info] " << manager.to_string() << std::endl;
+    std::cout << "[info] draw  : " << draw_stats.to_string() << std::endl;
+    std::cout << "[info] show  : " << show_stats.to_string() << std::endl;
+}
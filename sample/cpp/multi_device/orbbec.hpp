@@ -0,0 +1,99 @@
+#ifndef __ORBBEC__
+#define __ORBBEC__
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "stats.h"
+#include "frame_source.h"
+#include "device_manager.h"
+
+class orbbec
+{
+private:
+    // Orbbec
+    ob::Context context;
+    device_manager manager;
+    device_frameset merged;
+    uint64_t updated_framesets = 0;
+
+    // Mock
+    bool use_mock = false; // true: synthetic frames without device
+    uint32_t mock_devices = 4; // number of mock devices for measuring scaling
+    uint32_t mock_fps = 30;
+
+    // View of Each Device
+    struct device_view
+    {
+        std::shared_ptr<ob::ColorFrame> color_frame = nullptr;
+        std::shared_ptr<ob::DepthFrame> depth_frame = nullptr;
+        cv::Mat color;
+        cv::Mat depth;
+        cv::Mat depth_scaled;
+        cv::Mat depth_lut;
+        bool is_updated = false;
+    };
+    std::vector<device_view> views;
+    latency_stats draw_stats;
+    latency_stats show_stats;
+
+public:
+    // Constructor
+    orbbec();
+
+    // Destructor
+    ~orbbec();
+
+    // Run
+    void run();
+
+    // Update
+    void update();
+
+    // Draw
+    void draw();
+
+    // Show
+    void show();
+
+private:
+    // Initialize
+    void initialize();
+
+    // Initialize Sensor
+    void initialize_sensor();
+
+    // Initialize Mock
+    void initialize_mock();
+
+    // Finalize
+    void finalize();
+
+    // Update Frame
+    void update_frame();
+
+    // Draw Color
+    void draw_color( device_view& view );
+
+    // Draw Depth
+    void draw_depth( device_view& view );
+
+    // Show Color
+    void show_color( const device_view& view, const uint32_t device_index );
+
+    // Show Depth
+    void show_depth( device_view& view, const uint32_t device_index );
+
+    // Get Depth Range
+    std::tuple<double, double> get_depth_range( const uint32_t width, const uint32_t height );
+
+    // Show Statistics
+    void show_statistics();
+};
+
+#endif // __ORBBEC__
@@ -0,0 +1,379 @@
+#ifndef __DEVICE_MANAGER__
+#define __DEVICE_MANAGER__
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <queue>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined( __linux__ )
+#include <pthread.h>
+#endif
+
+#include <libobsensor/ObSensor.hpp>
+
+#include "ring_buffer.h"
+#include "frame_source.h"
+
+// Frame set with device that acquired it
+struct device_frameset
+{
+    uint32_t device_index = 0;
+    uint64_t timestamp = 0; // system timestamp [ms]
+    std::shared_ptr<ob::FrameSet> frameset = nullptr;
+};
+
+// Manager of multiple devices
+// Each device is acquired on its own worker thread pinned to CPU core, and frame sets are merged in timestamp order.
+// If acquisition of device fails, only that device is marked failed and merged without it, error is rethrown when all devices failed.
+class device_manager
+{
+public:
+    // Create Config for Pipeline of Device
+    using configure = std::function<std::shared_ptr<ob::Config>( std::shared_ptr<ob::Pipeline> )>;
+
+private:
+    // Device
+    struct device_context
+    {
+        std::string name;
+        std::shared_ptr<ob::Device> device = nullptr;
+        std::shared_ptr<ob::Pipeline> pipeline = nullptr;
+        std::shared_ptr<frame_source> source = nullptr;
+        std::thread acquisition_thread;
+        ring_buffer<device_frameset> frame_queue = ring_buffer<device_frameset>( 8 );
+        std::atomic<uint64_t> acquired_frames = 0;
+        std::atomic<uint64_t> dropped_frames = 0; // queue full
+        uint64_t merged_frames = 0;
+        uint32_t pending_frames = 0; // waiting in merge queue
+
+        // Error of Acquisition Thread (error is written before is_failed is set)
+        std::exception_ptr acquisition_error = nullptr;
+        std::atomic<bool> is_failed = false;
+        bool is_reported = false; // consumer only
+    };
+    std::vector<std::unique_ptr<device_context>> devices;
+    std::atomic<bool> is_acquire = false;
+    bool use_pinning = true;
+
+    // Merge
+    struct later
+    {
+        bool operator()( const device_frameset& a, const device_frameset& b ) const
+        {
+            return a.timestamp > b.timestamp;
+        }
+    };
+    std::priority_queue<device_frameset, std::vector<device_frameset>, later> merge_queue;
+    uint64_t reorder_window; // [ms]
+    uint64_t newest_timestamp = 0;
+    uint64_t merged_timestamp = 0;
+    uint64_t late_frames = 0; // older than already merged frame set
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+    // Constructor
+    // reorder_window is how long frame set waits for older frame sets of other devices.
+    explicit device_manager( const uint64_t reorder_window = 50, const bool use_pinning = true )
+        : use_pinning( use_pinning ), reorder_window( reorder_window )
+    {
+    }
+
+    // Destructor
+    ~device_manager()
+    {
+        stop();
+    }
+
+    // Open Connected Devices
+    void open_devices( ob::Context& context, configure configure_pipeline )
+    {
+        const std::shared_ptr<ob::DeviceList> device_list = context.queryDeviceList();
+        if( device_list->deviceCount() == 0 ){
+            throw std::runtime_error( "[error] failed to found devices!" );
+        }
+
+        for( uint32_t i = 0; i < device_list->deviceCount(); i++ ){
+            std::unique_ptr<device_context> opened = std::make_unique<device_context>();
+            opened->device = device_list->getDevice( i );
+            opened->name = opened->device->getDeviceInfo()->serialNumber();
+            opened->pipeline = std::make_shared<ob::Pipeline>( opened->device );
+            opened->source = std::make_shared<pipeline_source>( opened->pipeline, configure_pipeline( opened->pipeline ) );
+            devices.push_back( std::move( opened ) );
+        }
+    }
+
+    // Open Mock Devices
+    void open_mock( const uint32_t count, const mock_source::stream& color, const mock_source::stream& depth, const mock_source::stream& infrared, const uint32_t fps = 30 )
+    {
+        for( uint32_t i = 0; i < count; i++ ){
+            open_source( "mock " + std::to_string( i ), std::make_shared<mock_source>( color, depth, infrared, fps ) );
+        }
+    }
+
+    // Open Frame Source as Device
+    void open_source( const std::string& name, std::shared_ptr<frame_source> source )
+    {
+        std::unique_ptr<device_context> opened = std::make_unique<device_context>();
+        opened->name = name;
+        opened->source = source;
+        devices.push_back( std::move( opened ) );
+    }
+
+    // Number of Devices
+    size_t size() const
+    {
+        return devices.size();
+    }
+
+    // Name of Device (serial number)
+    const std::string& name( const uint32_t device_index ) const
+    {
+        return devices[device_index]->name;
+    }
+
+    // Pipeline of Device (nullptr if mock)
+    std::shared_ptr<ob::Pipeline> pipeline( const uint32_t device_index ) const
+    {
+        return devices[device_index]->pipeline;
+    }
+
+    // Acquisition of Device Failed
+    bool is_failed( const uint32_t device_index ) const
+    {
+        return devices[device_index]->is_failed.load( std::memory_order_acquire );
+    }
+
+    // Number of Frame Sets Dropped by Full Queues
+    uint64_t num_dropped() const
+    {
+        uint64_t dropped_frames = 0;
+        for( const std::unique_ptr<device_context>& context : devices ){
+            dropped_frames += context->dropped_frames;
+        }
+        return dropped_frames;
+    }
+
+    // Number of Frame Sets Older than Already Merged Frame Set
+    uint64_t num_late() const
+    {
+        return late_frames;
+    }
+
+    // Start Acquisition
+    void start()
+    {
+        is_acquire = true;
+        start_time = std::chrono::steady_clock::now();
+
+        const uint32_t cores = std::max( std::thread::hardware_concurrency(), 1u );
+        for( uint32_t i = 0; i < devices.size(); i++ ){
+            device_context* context = devices[i].get();
+            context->source->start();
+            context->acquisition_thread = std::thread( [this, context, i](){
+                try{
+                    while( is_acquire ){
+                        acquire_frame( context, i );
+                    }
+                }
+                catch( const ob::Error& error ){
+                    context->acquisition_error = std::make_exception_ptr( std::runtime_error( "[error] " + context->name + " : " + error.getMessage() ) );
+                    context->is_failed.store( true, std::memory_order_release );
+                }
+                catch( ... ){
+                    context->acquisition_error = std::current_exception();
+                    context->is_failed.store( true, std::memory_order_release );
+                }
+            } );
+
+            // Pin Acquisition Thread to CPU Core (round robin)
+            if( use_pinning ){
+                pin_thread( context->acquisition_thread, i % cores );
+            }
+        }
+    }
+
+    // Stop Acquisition
+    void stop()
+    {
+        if( !is_acquire ){
+            return;
+        }
+
+        is_acquire = false;
+        for( std::unique_ptr<device_context>& context : devices ){
+            if( context->acquisition_thread.joinable() ){
+                context->acquisition_thread.join();
+            }
+            context->source->stop();
+        }
+    }
+
+    // Wait for Merged Frame Set (Consumer Only)
+    // Frame sets are returned in timestamp order across devices, false if timeout.
+    // Error of acquisition is rethrown when all devices failed.
+    bool wait_for_frameset( device_frameset& dst, const uint32_t timeout )
+    {
+        const std::chrono::steady_clock::time_point timeout_time = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout );
+        while( true ){
+            // Check Failed Devices
+            check_failed();
+
+            // Collect Frame Sets of All Devices
+            for( std::unique_ptr<device_context>& context : devices ){
+                device_frameset collected;
+                while( context->frame_queue.pop( collected ) ){
+                    if( collected.timestamp < merged_timestamp ){
+                        late_frames++;
+                        continue;
+                    }
+                    newest_timestamp = std::max( newest_timestamp, collected.timestamp );
+                    context->pending_frames++;
+                    merge_queue.push( std::move( collected ) );
+                }
+            }
+
+            // Pop Oldest Frame Set if No Device can Deliver Older One
+            if( !merge_queue.empty() && is_ready() ){
+                dst = merge_queue.top();
+                merge_queue.pop();
+
+                device_context* context = devices[dst.device_index].get();
+                context->pending_frames--;
+                context->merged_frames++;
+                merged_timestamp = dst.timestamp;
+                return true;
+            }
+
+            if( std::chrono::steady_clock::now() >= timeout_time ){
+                return false;
+            }
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+    }
+
+    // To String
+    std::string to_string() const
+    {
+        const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+
+        std::ostringstream stream;
+        uint64_t merged_frames = 0;
+        for( const std::unique_ptr<device_context>& context : devices ){
+            stream << context->name << " : acquired " << context->acquired_frames << " frames, dropped " << context->dropped_frames << " frames, merged " << context->merged_frames << " frames";
+            stream << ( context->is_failed.load( std::memory_order_acquire ) ? " (failed)\n" : "\n" );
+            merged_frames += context->merged_frames;
+        }
+        stream << "merged " << merged_frames << " frames (" << ( elapsed > 0.0 ? merged_frames / elapsed : 0.0 ) << " fps), late " << late_frames << " frames";
+        return stream.str();
+    }
+
+private:
+    // Acquire Frame of Device (Worker Thread)
+    static void acquire_frame( device_context* context, const uint32_t device_index )
+    {
+        constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
+        std::shared_ptr<ob::FrameSet> frameset = context->source->wait_for_frames( timeout );
+        if( frameset == nullptr ){
+            return;
+        }
+
+        context->acquired_frames++;
+        device_frameset packet = { device_index, get_timestamp( frameset ), frameset };
+        if( !context->frame_queue.push( std::move( packet ) ) ){
+            context->dropped_frames++;
+        }
+    }
+
+    // Oldest frame set is ready when every device has pending frame set, or it is older than reorder window
+    bool is_ready() const
+    {
+        if( merge_queue.top().timestamp + reorder_window <= newest_timestamp ){
+            return true;
+        }
+
+        for( const std::unique_ptr<device_context>& context : devices ){
+            if( context->pending_frames == 0 && !context->is_reported ){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Check Failed Devices
+    // Failed device is reported once and no longer waited for, error of first device is rethrown when all devices failed.
+    void check_failed()
+    {
+        uint32_t failed_devices = 0;
+        for( std::unique_ptr<device_context>& context : devices ){
+            if( !context->is_failed.load( std::memory_order_acquire ) ){
+                continue;
+            }
+            failed_devices++;
+
+            if( !context->is_reported ){
+                context->is_reported = true;
+                try{
+                    std::rethrow_exception( context->acquisition_error );
+                }
+                catch( const std::exception& error ){
+                    std::cout << "[warning] acquisition of " << context->name << " failed, merged without it! " << error.what() << std::endl;
+                }
+                catch( ... ){
+                    std::cout << "[warning] acquisition of " << context->name << " failed, merged without it!" << std::endl;
+                }
+            }
+        }
+
+        if( !devices.empty() && failed_devices == devices.size() ){
+            std::rethrow_exception( devices.front()->acquisition_error );
+        }
+    }
+
+    // Get Timestamp of Frame Set
+    // Host system timestamp is used, because device timestamps of devices are not comparable without hardware sync.
+    static uint64_t get_timestamp( std::shared_ptr<ob::FrameSet> frameset )
+    {
+        std::shared_ptr<ob::Frame> frame = frameset->depthFrame();
+        if( frame == nullptr ){
+            frame = frameset->colorFrame();
+        }
+        if( frame == nullptr ){
+            frame = frameset->irFrame();
+        }
+        return frame != nullptr ? frame->systemTimeStamp() : 0;
+    }
+
+    // Pin Thread to CPU Core
+    static void pin_thread( std::thread& thread, const uint32_t core )
+    {
+        #if defined( _WIN32 )
+        if( SetThreadAffinityMask( thread.native_handle(), static_cast<DWORD_PTR>( 1 ) << core ) == 0 ){
+            std::cout << "[warning] failed to pin thread to core " << core << "!" << std::endl;
+        }
+        #elif defined( __linux__ )
+        cpu_set_t cpu_set;
+        CPU_ZERO( &cpu_set );
+        CPU_SET( core, &cpu_set );
+        if( pthread_setaffinity_np( thread.native_handle(), sizeof( cpu_set_t ), &cpu_set ) != 0 ){
+            std::cout << "[warning] failed to pin thread to core " << core << "!" << std::endl;
+        }
+        #endif
+    }
+};
+
+#endif // __DEVICE_MANAGER__
@@ -0,0 +1,457 @@
+#ifndef __FRAME_SOURCE__
+#define __FRAME_SOURCE__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+// Source of frame sets (device pipeline or synthetic frames)
+class frame_source
+{
+public:
+    using callback = std::function<void( std::shared_ptr<ob::FrameSet> )>;
+
+    // Destructor
+    virtual ~frame_source() = default;
+
+    // Start
+    // If callback is specified, frame sets are delivered to callback on source thread instead of wait_for_frames().
+    virtual void start( callback frameset_callback = nullptr ) = 0;
+
+    // Stop
+    virtual void stop() = 0;
+
+    // Wait for Frames (nullptr if timeout)
+    virtual std::shared_ptr<ob::FrameSet> wait_for_frames( const uint32_t timeout ) = 0;
+};
+
+// Frame source of device pipeline
+class pipeline_source : public frame_source
+{
+private:
+    std::shared_ptr<ob::Pipeline> pipeline = nullptr;
+    std::shared_ptr<ob::Config> config = nullptr;
+
+public:
+    // Constructor
+    pipeline_source( std::shared_ptr<ob::Pipeline> pipeline, std::shared_ptr<ob::Config> config )
+        : pipeline( pipeline ), config( config )
+    {
+    }
+
+    // Start
+    void start( callback frameset_callback = nullptr ) override
+    {
+        if( frameset_callback != nullptr ){
+            pipeline->start( config, frameset_callback );
+        }
+        else{
+            pipeline->start( config );
+        }
+    }
+
+    // Stop
+    void stop() override
+    {
+        pipeline->stop();
+    }
+
+    // Wait for Frames
+    std::shared_ptr<ob::FrameSet> wait_for_frames( const uint32_t timeout ) override
+    {
+        return pipeline->waitForFrames( timeout );
+    }
+};
+
+// Frame source that generates deterministic synthetic frames without device
+// Frame sets are produced on producer thread at fixed rate whether consumer takes them or not (like device).
+// Producer calls callback as soon as frame set is produced, or keeps newest frame set for wait_for_frames().
+class mock_source : public frame_source
+{
+public:
+    // Stream Setting (disabled if format is OB_FORMAT_UNKNOWN)
+    struct stream
+    {
+        OBFormat format = OBFormat::OB_FORMAT_UNKNOWN;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+private:
+    static constexpr uint32_t pattern_count = 8;
+    std::vector<std::pair<OBFrameType, stream>> streams;
+    std::vector<std::vector<std::shared_ptr<std::vector<uint8_t>>>> patterns; // [stream][pattern]
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point start_time;
+    int64_t frame_index = 0;
+    std::thread producer_thread;
+    std::atomic<bool> is_run = false;
+
+    // Frame Set Waiting for wait_for_frames() (replaced by newer frame set, like device)
+    std::shared_ptr<ob::FrameSet> pending = nullptr;
+    std::mutex pending_mutex;
+    std::condition_variable pending_condition;
+
+public:
+    // Constructor
+    mock_source( const stream& color, const stream& depth, const stream& infrared, const uint32_t fps = 30 )
+    {
+        interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>( 1.0 / fps ) );
+
+        const std::vector<std::pair<OBFrameType, stream>> settings = {
+            { OBFrameType::OB_FRAME_COLOR, color },
+            { OBFrameType::OB_FRAME_DEPTH, depth },
+            { OBFrameType::OB_FRAME_IR, infrared }
+        };
+
+        // Generate Patterns in Advance
+        for( const std::pair<OBFrameType, stream>& setting : settings ){
+            if( setting.second.format == OBFormat::OB_FORMAT_UNKNOWN ){
+                continue;
+            }
+
+            std::vector<std::shared_ptr<std::vector<uint8_t>>> stream_patterns;
+            for( uint32_t i = 0; i < pattern_count; i++ ){
+                stream_patterns.push_back( generate_pattern( setting.first, setting.second, i ) );
+            }
+
+            streams.push_back( setting );
+            patterns.push_back( stream_patterns );
+        }
+    }
+
+    // Destructor
+    ~mock_source()
+    {
+        stop();
+    }
+
+    // Start
+    void start( callback frameset_callback = nullptr ) override
+    {
+        start_time = std::chrono::steady_clock::now();
+        frame_index = 0;
+        is_run = true;
+
+        // Produce Frame Sets on Producer Thread
+        producer_thread = std::thread( [this, frameset_callback](){
+            while( is_run ){
+                std::shared_ptr<ob::FrameSet> frameset = produce();
+                if( frameset == nullptr ){
+                    continue;
+                }
+
+                // Deliver Frame Set to Callback at Time It was Produced (like SDK)
+                if( frameset_callback != nullptr ){
+                    frameset_callback( frameset );
+                    continue;
+                }
+
+                // Keep Newest Frame Set for wait_for_frames()
+                {
+                    std::lock_guard<std::mutex> lock( pending_mutex );
+                    pending = frameset;
+                }
+                pending_condition.notify_all();
+            }
+        } );
+    }
+
+    // Stop
+    void stop() override
+    {
+        {
+            std::lock_guard<std::mutex> lock( pending_mutex );
+            is_run = false;
+        }
+        pending_condition.notify_all();
+        if( producer_thread.joinable() ){
+            producer_thread.join();
+        }
+
+        std::lock_guard<std::mutex> lock( pending_mutex );
+        pending = nullptr;
+    }
+
+    // Wait for Frames
+    std::shared_ptr<ob::FrameSet> wait_for_frames( const uint32_t timeout ) override
+    {
+        std::unique_lock<std::mutex> lock( pending_mutex );
+        if( !pending_condition.wait_for( lock, std::chrono::milliseconds( timeout ), [this](){ return pending != nullptr || !is_run; } ) ){
+            return nullptr;
+        }
+
+        std::shared_ptr<ob::FrameSet> frameset = pending;
+        pending = nullptr;
+        return frameset;
+    }
+
+private:
+    // Produce Next Frame Set (producer thread, nullptr if stopped)
+    std::shared_ptr<ob::FrameSet> produce()
+    {
+        // Skip Frames that were Due while Producer was Busy (like device)
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const int64_t current_index = ( now - start_time ) / interval;
+        if( current_index > frame_index ){
+            frame_index = current_index;
+        }
+
+        // Wait until Next Frame (in short steps to respond to stop)
+        const std::chrono::steady_clock::time_point frame_time = start_time + interval * frame_index;
+        while( std::chrono::steady_clock::now() < frame_time ){
+            if( !is_run ){
+                return nullptr;
+            }
+            std::this_thread::sleep_until( std::min( frame_time, std::chrono::steady_clock::now() + std::chrono::milliseconds( 10 ) ) );
+        }
+
+        // Create Frame Set
+        const uint64_t device_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>( interval * frame_index ).count();
+        const uint64_t system_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+
+        std::shared_ptr<ob::FrameSet> frameset = ob::FrameHelper::createFrameSet();
+        for( size_t i = 0; i < streams.size(); i++ ){
+            std::shared_ptr<ob::Frame> frame = create_frame( streams[i].first, streams[i].second, patterns[i][frame_index % pattern_count] );
+            ob::FrameHelper::setFrameDeviceTimestamp( frame, device_timestamp );
+            ob::FrameHelper::setFrameSystemTimestamp( frame, system_timestamp );
+            ob::FrameHelper::pushFrame( frameset, streams[i].first, frame );
+        }
+        frame_index++;
+
+        return frameset;
+    }
+
+    // Create Frame from Pattern
+    static std::shared_ptr<ob::Frame> create_frame( const OBFrameType frame_type, const stream& setting, std::shared_ptr<std::vector<uint8_t>> pattern )
+    {
+        if( setting.format == OBFormat::OB_FORMAT_MJPG && frame_type != OBFrameType::OB_FRAME_COLOR ){
+            // Compressed infrared frame is copied into frame of its frame type (frame type of wrapped buffer is deduced from format)
+            // Frame is allocated as raw 8-bit frame, decoder ignores bytes after end of image.
+            std::shared_ptr<ob::Frame> frame = ob::FrameHelper::createFrame( frame_type, setting.format, setting.width, setting.height, get_stride( setting ) );
+            if( frame->dataSize() < pattern->size() ){
+                throw std::runtime_error( "[error] size of mock pattern exceeds frame size!" );
+            }
+            std::memcpy( frame->data(), pattern->data(), pattern->size() );
+            return frame;
+        }
+
+        if( setting.format == OBFormat::OB_FORMAT_MJPG || is_planar( setting.format ) ){
+            // Compressed frame and planar frame (data size is not stride x height) wrap pattern that is kept alive until frame is destroyed
+            if( setting.format != OBFormat::OB_FORMAT_MJPG && pattern->size() != get_data_size( setting ) ){
+                throw std::runtime_error( "[error] size of mock pattern does not match frame size!" );
+            }
+            std::shared_ptr<std::vector<uint8_t>>* holder = new std::shared_ptr<std::vector<uint8_t>>( pattern );
+            return ob::FrameHelper::createFrameFromBuffer(
+                setting.format, setting.width, setting.height, pattern->data(), static_cast<uint32_t>( pattern->size() ),
+                []( void* buffer, void* context ){
+                    delete reinterpret_cast<std::shared_ptr<std::vector<uint8_t>>*>( context );
+                },
+                holder
+            );
+        }
+
+        // Copy pattern into frame allocated by SDK (like device)
+        std::shared_ptr<ob::Frame> frame = ob::FrameHelper::createFrame( frame_type, setting.format, setting.width, setting.height, get_stride( setting ) );
+        if( frame->dataSize() != pattern->size() || pattern->size() != get_data_size( setting ) ){
+            throw std::runtime_error( "[error] size of mock pattern does not match frame size!" );
+        }
+        std::memcpy( frame->data(), pattern->data(), pattern->size() );
+        return frame;
+    }
+
+    // Planar YUV 4:2:0 (Y plane followed by chroma planes of half resolution)
+    static bool is_planar( const OBFormat format )
+    {
+        return format == OBFormat::OB_FORMAT_NV12 || format == OBFormat::OB_FORMAT_NV21 || format == OBFormat::OB_FORMAT_I420;
+    }
+
+    // Get Data Size (Bytes of Frame)
+    static size_t get_data_size( const stream& setting )
+    {
+        if( is_planar( setting.format ) ){
+            return static_cast<size_t>( setting.width ) * setting.height * 3 / 2;
+        }
+        return static_cast<size_t>( get_stride( setting ) ) * setting.height;
+    }
+
+    // Get Stride (Bytes of Row, Y plane of planar format)
+    static uint32_t get_stride( const stream& setting )
+    {
+        switch( setting.format ){
+            case OBFormat::OB_FORMAT_YUYV:
+            case OBFormat::OB_FORMAT_YUY2:
+            case OBFormat::OB_FORMAT_UYVY:
+            case OBFormat::OB_FORMAT_Y16:
+            case OBFormat::OB_FORMAT_Y10:
+            case OBFormat::OB_FORMAT_Y11:
+            case OBFormat::OB_FORMAT_Y12:
+            case OBFormat::OB_FORMAT_Y14:
+                return setting.width * 2;
+            case OBFormat::OB_FORMAT_RGB:
+            case OBFormat::OB_FORMAT_BGR:
+                return setting.width * 3;
+            case OBFormat::OB_FORMAT_BGRA:
+                return setting.width * 4;
+            default:
+                return setting.width;
+        }
+    }
+
+    // Generate Deterministic Pattern
+    static std::shared_ptr<std::vector<uint8_t>> generate_pattern( const OBFrameType frame_type, const stream& setting, const uint32_t index )
+    {
+        const int32_t width = setting.width;
+        const int32_t height = setting.height;
+        const int32_t offset = index * 8;
+
+        cv::Mat mat;
+        if( frame_type == OBFrameType::OB_FRAME_DEPTH ){
+            // Depth ramp (500-5000 mm) with invalid (zero) holes
+            mat = cv::Mat( height, width, CV_16UC1 );
+            for( int32_t y = 0; y < height; y++ ){
+                for( int32_t x = 0; x < width; x++ ){
+                    const bool is_invalid = ( ( x / 16 + y / 16 + index ) % 7 ) == 0;
+                    mat.at<uint16_t>( y, x ) = is_invalid ? 0 : static_cast<uint16_t>( 500 + ( ( x + y + offset ) * 7 ) % 4500 );
+                }
+            }
+
+            // Depth of fewer bits is clamped to range of format (Y8 is scaled to 8 bits, Y14 and Y16 keep range)
+            switch( setting.format ){
+                case OBFormat::OB_FORMAT_Y8:
+                    mat.convertTo( mat, CV_8U, 255.0 / 5000.0 );
+                    break;
+                case OBFormat::OB_FORMAT_Y10:
+                    mat = cv::min( mat, ( 1 << 10 ) - 1 );
+                    break;
+                case OBFormat::OB_FORMAT_Y11:
+                    mat = cv::min( mat, ( 1 << 11 ) - 1 );
+                    break;
+                case OBFormat::OB_FORMAT_Y12:
+                    mat = cv::min( mat, ( 1 << 12 ) - 1 );
+                    break;
+                default:
+                    break;
+            }
+        }
+        else if( frame_type == OBFrameType::OB_FRAME_IR ){
+            // Infrared ramp
+            mat = cv::Mat( height, width, CV_16UC1 );
+            for( int32_t y = 0; y < height; y++ ){
+                for( int32_t x = 0; x < width; x++ ){
+                    mat.at<uint16_t>( y, x ) = static_cast<uint16_t>( ( ( x + y + offset ) * 4 ) & 0x3ff );
+                }
+            }
+            if( setting.format == OBFormat::OB_FORMAT_Y8 || setting.format == OBFormat::OB_FORMAT_MJPG ){
+                mat.convertTo( mat, CV_8U, 0.25 );
+            }
+            if( setting.format == OBFormat::OB_FORMAT_MJPG ){
+                std::shared_ptr<std::vector<uint8_t>> buffer = std::make_shared<std::vector<uint8_t>>();
+                cv::imencode( ".jpg", mat, *buffer );
+                return buffer;
+            }
+        }
+        else{
+            // Color gradient
+            cv::Mat bgr = cv::Mat( height, width, CV_8UC3 );
+            for( int32_t y = 0; y < height; y++ ){
+                for( int32_t x = 0; x < width; x++ ){
+                    bgr.at<cv::Vec3b>( y, x ) = cv::Vec3b( ( x + offset ) & 0xff, ( y + offset ) & 0xff, ( ( x + y ) / 2 ) & 0xff );
+                }
+            }
+
+            switch( setting.format ){
+                case OBFormat::OB_FORMAT_BGR:
+                {
+                    mat = bgr;
+                    break;
+                }
+                case OBFormat::OB_FORMAT_RGB:
+                {
+                    cv::cvtColor( bgr, mat, cv::COLOR_BGR2RGB );
+                    break;
+                }
+                case OBFormat::OB_FORMAT_BGRA:
+                {
+                    cv::cvtColor( bgr, mat, cv::COLOR_BGR2BGRA );
+                    break;
+                }
+                case OBFormat::OB_FORMAT_GRAY:
+                {
+                    cv::cvtColor( bgr, mat, cv::COLOR_BGR2GRAY );
+                    break;
+                }
+                case OBFormat::OB_FORMAT_I420:
+                {
+                    cv::cvtColor( bgr, mat, cv::COLOR_BGR2YUV_I420 );
+                    break;
+                }
+                case OBFormat::OB_FORMAT_NV12:
+                case OBFormat::OB_FORMAT_NV21:
+                {
+                    // I420 (Y, U, V planes) to NV12/NV21 (Y plane, interleaved UV/VU plane)
+                    cv::Mat i420;
+                    cv::cvtColor( bgr, i420, cv::COLOR_BGR2YUV_I420 );
+                    mat = i420.clone();
+                    const int32_t chroma_size = ( width / 2 ) * ( height / 2 );
+                    const uint8_t* u = i420.ptr<uint8_t>() + width * height;
+                    const uint8_t* v = u + chroma_size;
+                    uint8_t* uv = mat.ptr<uint8_t>() + width * height;
+                    const bool is_nv12 = setting.format == OBFormat::OB_FORMAT_NV12;
+                    for( int32_t i = 0; i < chroma_size; i++ ){
+                        uv[i * 2 + 0] = is_nv12 ? u[i] : v[i];
+                        uv[i * 2 + 1] = is_nv12 ? v[i] : u[i];
+                    }
+                    break;
+                }
+                case OBFormat::OB_FORMAT_YUYV:
+                case OBFormat::OB_FORMAT_YUY2:
+                case OBFormat::OB_FORMAT_UYVY:
+                {
+                    // YUV 4:4:4 to packed YUV 4:2:2
+                    cv::Mat yuv;
+                    cv::cvtColor( bgr, yuv, cv::COLOR_BGR2YUV );
+                    mat = cv::Mat( height, width, CV_8UC2 );
+                    const bool is_yuyv = setting.format != OBFormat::OB_FORMAT_UYVY;
+                    for( int32_t y = 0; y < height; y++ ){
+                        const cv::Vec3b* src = yuv.ptr<cv::Vec3b>( y );
+                        uint8_t* dst = mat.ptr<uint8_t>( y );
+                        for( int32_t x = 0; x + 1 < width; x += 2 ){
+                            const uint8_t u = static_cast<uint8_t>( ( src[x][1] + src[x + 1][1] + 1 ) / 2 );
+                            const uint8_t v = static_cast<uint8_t>( ( src[x][2] + src[x + 1][2] + 1 ) / 2 );
+                            dst[x * 2 + 0] = is_yuyv ? src[x][0] : u;
+                            dst[x * 2 + 1] = is_yuyv ? u : src[x][0];
+                            dst[x * 2 + 2] = is_yuyv ? src[x + 1][0] : v;
+                            dst[x * 2 + 3] = is_yuyv ? v : src[x + 1][0];
+                        }
+                    }
+                    break;
+                }
+                case OBFormat::OB_FORMAT_MJPG:
+                {
+                    std::shared_ptr<std::vector<uint8_t>> buffer = std::make_shared<std::vector<uint8_t>>();
+                    cv::imencode( ".jpg", bgr, *buffer );
+                    return buffer;
+                }
+                default:
+                {
+                    throw std::runtime_error( "[error] mock source does not support this format!" );
+                }
+            }
+        }
+
+        return std::make_shared<std::vector<uint8_t>>( mat.datastart, mat.dataend );
+    }
+};
+
+#endif // __FRAME_SOURCE__
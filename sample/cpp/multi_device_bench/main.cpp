@@ -0,0 +1,240 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+
+#include "device_manager.h"
+
+// Scaling of device_manager over Number of Mock Devices
+// Each mock device produces frame sets on its own thread, and frame sets are merged in timestamp order on main thread.
+// Merge rate and latency (from time frame set was produced to time it was merged) are measured for each number of devices.
+// Failure of acquisition is injected to check that only failed device is dropped from merge, and error is rethrown when all devices failed.
+
+// Benchmark Result
+struct bench_result
+{
+    std::string name;
+    uint32_t devices;
+    uint32_t failed_devices;
+    uint32_t fps;
+    double merged_fps;
+    double expected_fps; // fps of devices that did not fail
+    uint64_t dropped;
+    uint64_t late;
+    double latency_ms_average;
+    double latency_ms_p99;
+    double latency_ms_max;
+};
+
+// Frame Source that Fails after Number of Frame Sets (like disconnected device)
+class failing_source : public frame_source
+{
+private:
+    mock_source source;
+    uint32_t remaining_frames;
+
+public:
+    // Constructor
+    failing_source( const mock_source::stream& color, const mock_source::stream& depth, const uint32_t fps, const uint32_t frames )
+        : source( color, depth, mock_source::stream(), fps ), remaining_frames( frames )
+    {
+    }
+
+    // Start
+    void start( callback frameset_callback = nullptr ) override
+    {
+        source.start( frameset_callback );
+    }
+
+    // Stop
+    void stop() override
+    {
+        source.stop();
+    }
+
+    // Wait for Frames
+    std::shared_ptr<ob::FrameSet> wait_for_frames( const uint32_t timeout ) override
+    {
+        if( remaining_frames == 0 ){
+            throw std::runtime_error( "[error] device was disconnected!" );
+        }
+        std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+        if( frameset != nullptr ){
+            remaining_frames--;
+        }
+        return frameset;
+    }
+};
+
+// Run Benchmark
+// First failing_devices devices fail after 1 second (warm up), and merge rate is measured after that.
+bench_result run( const std::string& name, const uint32_t devices, const uint32_t failing_devices, const uint32_t fps )
+{
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 3000 );
+    constexpr std::chrono::milliseconds warm_up = std::chrono::milliseconds( 1000 );
+
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_BGRA, 640, 480 };
+    const mock_source::stream depth_stream = { OBFormat::OB_FORMAT_Y16, 320, 288 };
+
+    device_manager manager;
+    for( uint32_t i = 0; i < devices; i++ ){
+        if( i < failing_devices ){
+            manager.open_source( "failing " + std::to_string( i ), std::make_shared<failing_source>( color_stream, depth_stream, fps, fps ) );
+        }
+        else{
+            manager.open_source( "mock " + std::to_string( i ), std::make_shared<mock_source>( color_stream, depth_stream, mock_source::stream(), fps ) );
+        }
+    }
+    manager.start();
+
+    // Merge Loop (same as multi_device sample)
+    std::vector<double> latencies;
+    latencies.reserve( static_cast<size_t>( devices ) * fps * 4 );
+    uint64_t merged = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point now = start;
+    while( now - start < duration ){
+        constexpr uint32_t timeout = 100;
+        device_frameset merged_frameset;
+        const bool is_merged = manager.wait_for_frameset( merged_frameset, timeout );
+        now = std::chrono::steady_clock::now();
+        if( !is_merged || now - start < warm_up ){
+            continue;
+        }
+
+        const uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() ).count();
+        latencies.push_back( static_cast<double>( timestamp ) - static_cast<double>( merged_frameset.timestamp ) );
+        merged++;
+    }
+    const double elapsed = std::chrono::duration<double>( now - start - warm_up ).count();
+
+    // Check Failed Devices (merged without them)
+    for( uint32_t i = 0; i < devices; i++ ){
+        if( manager.is_failed( i ) != ( i < failing_devices ) ){
+            throw std::runtime_error( "[error] failure of device " + std::to_string( i ) + " was not isolated (" + name + ")!" );
+        }
+    }
+    if( latencies.empty() ){
+        throw std::runtime_error( "[error] no frame set was merged (" + name + ")!" );
+    }
+
+    // Statistics of Merge
+    bench_result result;
+    result.name = name;
+    result.devices = devices;
+    result.failed_devices = failing_devices;
+    result.fps = fps;
+    result.merged_fps = merged / elapsed;
+    result.expected_fps = static_cast<double>( devices - failing_devices ) * fps;
+    result.dropped = manager.num_dropped();
+    result.late = manager.num_late();
+    manager.stop();
+
+    double total = 0.0;
+    for( const double latency : latencies ){
+        total += latency;
+    }
+    result.latency_ms_average = total / latencies.size();
+    std::sort( latencies.begin(), latencies.end() );
+    result.latency_ms_p99 = latencies[latencies.size() * 99 / 100];
+    result.latency_ms_max = latencies.back();
+    return result;
+}
+
+// Run Failure of All Devices (error must be rethrown to main thread)
+void run_all_failed( const uint32_t devices, const uint32_t fps )
+{
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_BGRA, 640, 480 };
+    device_manager manager;
+    for( uint32_t i = 0; i < devices; i++ ){
+        manager.open_source( "failing " + std::to_string( i ), std::make_shared<failing_source>( color_stream, mock_source::stream(), fps, fps / 2 ) );
+    }
+    manager.start();
+
+    const std::chrono::steady_clock::time_point timeout_time = std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+    while( std::chrono::steady_clock::now() < timeout_time ){
+        try{
+            constexpr uint32_t timeout = 100;
+            device_frameset merged_frameset;
+            manager.wait_for_frameset( merged_frameset, timeout );
+        }
+        catch( const std::runtime_error& ){
+            return;
+        }
+    }
+    throw std::runtime_error( "[error] error of acquisition was not rethrown when all devices failed!" );
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"devices\": " << result.devices << ", ";
+        stream << "\"failed_devices\": " << result.failed_devices << ", ";
+        stream << "\"fps\": " << result.fps << ", ";
+        stream << "\"merged_fps\": " << result.merged_fps << ", ";
+        stream << "\"expected_fps\": " << result.expected_fps << ", ";
+        stream << "\"dropped\": " << result.dropped << ", ";
+        stream << "\"late\": " << result.late << ", ";
+        stream << "\"latency_ms_average\": " << result.latency_ms_average << ", ";
+        stream << "\"latency_ms_p99\": " << result.latency_ms_p99 << ", ";
+        stream << "\"latency_ms_max\": " << result.latency_ms_max;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        constexpr uint32_t fps = 30;
+
+        // Sweep over Number of Devices
+        std::vector<bench_result> results;
+        for( const uint32_t devices : { 1, 2, 4, 8, 16 } ){
+            results.push_back( run( "mock_" + std::to_string( devices ), devices, 0, fps ) );
+        }
+
+        // Failure of Device (one of four devices fails after 1 second)
+        results.push_back( run( "mock_4_one_failed", 4, 1, fps ) );
+        run_all_failed( 2, fps );
+
+        for( const bench_result& result : results ){
+            std::cerr << result.name << " : merged " << result.merged_fps << " fps (expected " << result.expected_fps << " fps), dropped " << result.dropped << ", late " << result.late
+                      << ", latency " << result.latency_ms_average << " ms (p99 " << result.latency_ms_p99 << " ms, max " << result.latency_ms_max << " ms)" << std::endl;
+            if( result.merged_fps < result.expected_fps * 0.9 ){
+                std::cerr << "[warning] merge rate of " << result.name << " is below rate of devices!" << std::endl;
+            }
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
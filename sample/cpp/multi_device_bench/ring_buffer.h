@@ -0,0 +1,69 @@
+#ifndef __RING_BUFFER__
+#define __RING_BUFFER__
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// Bounded lock-free ring buffer for single producer and single consumer
+template<typename T>
+class ring_buffer
+{
+private:
+    std::vector<T> buffer;
+    alignas( 64 ) std::atomic<size_t> head = 0; // written by consumer
+    alignas( 64 ) std::atomic<size_t> tail = 0; // written by producer
+
+public:
+    // Constructor
+    explicit ring_buffer( const size_t capacity )
+        : buffer( capacity + 1 )
+    {
+    }
+
+    // Push (Producer Only)
+    // value is not moved from when the buffer is full.
+    bool push( T&& value )
+    {
+        const size_t current = tail.load( std::memory_order_relaxed );
+        const size_t next = ( current + 1 ) % buffer.size();
+        if( next == head.load( std::memory_order_acquire ) ){
+            return false;
+        }
+
+        buffer[current] = std::move( value );
+        tail.store( next, std::memory_order_release );
+        return true;
+    }
+
+    // Pop (Consumer Only)
+    bool pop( T& value )
+    {
+        const size_t current = head.load( std::memory_order_relaxed );
+        if( current == tail.load( std::memory_order_acquire ) ){
+            return false;
+        }
+
+        value = std::move( buffer[current] );
+        buffer[current] = T();
+        head.store( ( current + 1 ) % buffer.size(), std::memory_order_release );
+        return true;
+    }
+
+    // Size
+    size_t size() const
+    {
+        const size_t current_head = head.load( std::memory_order_acquire );
+        const size_t current_tail = tail.load( std::memory_order_acquire );
+        return ( current_tail + buffer.size() - current_head ) % buffer.size();
+    }
+
+    // Capacity
+    size_t capacity() const
+    {
+        return buffer.size() - 1;
+    }
+};
+
+#endif // __RING_BUFFER__
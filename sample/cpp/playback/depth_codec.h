@@ -0,0 +1,283 @@
+#ifndef __DEPTH_CODEC__
+#define __DEPTH_CODEC__
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <opencv2/opencv.hpp>
+
+/*
+ Lossless depth (Y16) codec based on RVL (Run length encoding and Variable Length encoding)
+ A. D. Wilson, "Fast Lossless Depth Image Compression", ISS 2017.
+
+ Runs of invalid (zero) and valid pixels are counted, and each valid pixel is coded as delta to previous valid pixel (zigzag).
+ All values are written with variable length encoding of nibbles (3 bits of data + 1 bit of continuation).
+ Image is split into horizontal bands that are encoded and decoded in parallel independently.
+
+ +--------------------------------------+
+ | header (magic, width, height, bands) |
+ | band size (uint32) x bands           |
+ | band 0 (nibbles packed in uint32)    |
+ | band 1 ...                           |
+ +--------------------------------------+
+*/
+namespace rvl
+{
+    constexpr uint32_t magic = 0x314c5652; // "RVL1"
+
+    // Header
+    struct header
+    {
+        uint32_t magic;
+        uint32_t width;
+        uint32_t height;
+        uint32_t band_count;
+    };
+
+    // Writer of Variable Length Nibbles
+    class nibble_writer
+    {
+    private:
+        uint32_t* output;
+        uint32_t word = 0;
+        int32_t nibbles = 0;
+
+    public:
+        explicit nibble_writer( uint32_t* output )
+            : output( output )
+        {
+        }
+
+        void write( uint32_t value )
+        {
+            do{
+                uint32_t nibble = value & 0x7;
+                value >>= 3;
+                if( value != 0 ){
+                    nibble |= 0x8;
+                }
+                word = ( word << 4 ) | nibble;
+                if( ++nibbles == 8 ){
+                    *output++ = word;
+                    word = 0;
+                    nibbles = 0;
+                }
+            } while( value != 0 );
+        }
+
+        uint32_t* flush()
+        {
+            if( nibbles != 0 ){
+                *output++ = word << ( 4 * ( 8 - nibbles ) );
+                word = 0;
+                nibbles = 0;
+            }
+            return output;
+        }
+    };
+
+    // Reader of Variable Length Nibbles
+    class nibble_reader
+    {
+    private:
+        const uint32_t* input;
+        const uint32_t* end;
+        uint32_t word = 0;
+        int32_t nibbles = 0;
+
+    public:
+        nibble_reader( const uint32_t* input, const uint32_t* end )
+            : input( input ), end( end )
+        {
+        }
+
+        // Read Value (false if data is exhausted)
+        bool read( uint32_t& value )
+        {
+            value = 0;
+            int32_t shift = 0;
+            uint32_t nibble = 0;
+            do{
+                if( nibbles == 0 ){
+                    if( input == end ){
+                        return false;
+                    }
+                    word = *input++;
+                    nibbles = 8;
+                }
+                nibble = word >> 28;
+                word <<= 4;
+                nibbles--;
+                value |= ( nibble & 0x7 ) << shift;
+                shift += 3;
+            } while( ( nibble & 0x8 ) != 0 && shift < 32 );
+            return true;
+        }
+    };
+
+    // Maximum Bytes of Encoded Band
+    // Worst case is alternating invalid and valid pixels (2 run lengths + 6 nibbles of delta per pixel).
+    inline size_t get_max_band_size( const size_t pixels )
+    {
+        return ( pixels * 4 + 16 ) & ~static_cast<size_t>( 3 );
+    }
+
+    // Encode Band
+    inline size_t encode_band( const uint16_t* src, const size_t pixels, uint32_t* dst )
+    {
+        nibble_writer writer( dst );
+        const uint16_t* end = src + pixels;
+        int32_t previous = 0;
+        while( src != end ){
+            // Run of Invalid Pixels
+            const uint16_t* run = src;
+            while( src != end && *src == 0 ){
+                src++;
+            }
+            writer.write( static_cast<uint32_t>( src - run ) );
+
+            // Run of Valid Pixels
+            run = src;
+            while( src != end && *src != 0 ){
+                src++;
+            }
+            writer.write( static_cast<uint32_t>( src - run ) );
+
+            // Delta of Valid Pixels (zigzag)
+            for( const uint16_t* pixel = run; pixel != src; pixel++ ){
+                const int32_t delta = static_cast<int32_t>( *pixel ) - previous;
+                writer.write( ( static_cast<uint32_t>( delta ) << 1 ) ^ static_cast<uint32_t>( delta >> 31 ) );
+                previous = *pixel;
+            }
+        }
+        return static_cast<size_t>( writer.flush() - dst ) * sizeof( uint32_t );
+    }
+
+    // Decode Band (false if data is broken)
+    inline bool decode_band( const uint32_t* src, const size_t src_size, uint16_t* dst, const size_t pixels )
+    {
+        nibble_reader reader( src, src + src_size / sizeof( uint32_t ) );
+        uint16_t* end = dst + pixels;
+        int32_t previous = 0;
+        while( dst != end ){
+            // Run of Invalid Pixels
+            uint32_t zeros = 0;
+            if( !reader.read( zeros ) || zeros > static_cast<size_t>( end - dst ) ){
+                return false;
+            }
+            std::memset( dst, 0, zeros * sizeof( uint16_t ) );
+            dst += zeros;
+
+            // Run of Valid Pixels
+            uint32_t nonzeros = 0;
+            if( !reader.read( nonzeros ) || nonzeros > static_cast<size_t>( end - dst ) ){
+                return false;
+            }
+            for( uint32_t i = 0; i < nonzeros; i++ ){
+                uint32_t value = 0;
+                if( !reader.read( value ) ){
+                    return false;
+                }
+                const int32_t delta = static_cast<int32_t>( value >> 1 ) ^ -static_cast<int32_t>( value & 1 );
+                previous += delta;
+                *dst++ = static_cast<uint16_t>( previous );
+            }
+        }
+        return true;
+    }
+
+    // Encode Depth (CV_16UC1) into caller-owned buffer
+    // dst is reused (capacity is kept), bands are encoded in parallel (band_count is number of bands, 0 is number of threads).
+    inline void encode( const cv::Mat& depth, std::vector<uint8_t>& dst, int32_t band_count = 0 )
+    {
+        assert( depth.type() == CV_16UC1 );
+
+        const cv::Mat src = depth.isContinuous() ? depth : depth.clone();
+        if( band_count <= 0 ){
+            band_count = std::max( cv::getNumThreads(), 1 );
+        }
+        band_count = std::min( band_count, std::max( src.rows, 1 ) );
+
+        // Encode Each Band at Worst Case Offset
+        const size_t table_size = sizeof( header ) + band_count * sizeof( uint32_t );
+        const int32_t rows_per_band = ( src.rows + band_count - 1 ) / band_count;
+        const size_t max_band_size = get_max_band_size( static_cast<size_t>( rows_per_band ) * src.cols );
+        dst.resize( table_size + max_band_size * band_count );
+
+        std::vector<uint32_t> band_sizes( band_count, 0 );
+        cv::parallel_for_( cv::Range( 0, band_count ), [&]( const cv::Range& range ){
+            for( int32_t band = range.start; band < range.end; band++ ){
+                const int32_t begin = std::min( band * rows_per_band, src.rows );
+                const int32_t end = std::min( begin + rows_per_band, src.rows );
+                uint32_t* output = reinterpret_cast<uint32_t*>( dst.data() + table_size + max_band_size * band );
+                band_sizes[band] = static_cast<uint32_t>( encode_band( src.ptr<uint16_t>( begin ), static_cast<size_t>( end - begin ) * src.cols, output ) );
+            }
+        } );
+
+        // Pack Bands
+        size_t offset = table_size;
+        for( int32_t band = 0; band < band_count; band++ ){
+            std::memmove( dst.data() + offset, dst.data() + table_size + max_band_size * band, band_sizes[band] );
+            offset += band_sizes[band];
+        }
+        dst.resize( offset );
+
+        // Write Header
+        const header encoded_header = { magic, static_cast<uint32_t>( src.cols ), static_cast<uint32_t>( src.rows ), static_cast<uint32_t>( band_count ) };
+        std::memcpy( dst.data(), &encoded_header, sizeof( header ) );
+        std::memcpy( dst.data() + sizeof( header ), band_sizes.data(), band_count * sizeof( uint32_t ) );
+    }
+
+    // Decode Depth into caller-owned cv::Mat (CV_16UC1)
+    // src must be aligned to 4 bytes, bands are decoded in parallel.
+    inline void decode( const void* src, const size_t src_size, cv::Mat& dst )
+    {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>( src );
+        if( src_size < sizeof( header ) ){
+            throw std::runtime_error( "[error] broken rvl data!" );
+        }
+
+        header encoded_header;
+        std::memcpy( &encoded_header, data, sizeof( header ) );
+        const size_t table_size = sizeof( header ) + encoded_header.band_count * sizeof( uint32_t );
+        if( encoded_header.magic != magic || encoded_header.band_count == 0 || src_size < table_size ){
+            throw std::runtime_error( "[error] broken rvl data!" );
+        }
+
+        // Get Offsets of Bands
+        const int32_t band_count = static_cast<int32_t>( encoded_header.band_count );
+        const uint32_t* band_sizes = reinterpret_cast<const uint32_t*>( data + sizeof( header ) );
+        std::vector<size_t> band_offsets( band_count + 1, table_size );
+        for( int32_t band = 0; band < band_count; band++ ){
+            band_offsets[band + 1] = band_offsets[band] + band_sizes[band];
+        }
+        if( band_offsets[band_count] > src_size ){
+            throw std::runtime_error( "[error] broken rvl data!" );
+        }
+
+        // Decode Each Band
+        dst.create( encoded_header.height, encoded_header.width, CV_16UC1 );
+        const int32_t rows_per_band = ( dst.rows + band_count - 1 ) / band_count;
+        std::atomic<bool> is_broken = false;
+        cv::parallel_for_( cv::Range( 0, band_count ), [&]( const cv::Range& range ){
+            for( int32_t band = range.start; band < range.end; band++ ){
+                const int32_t begin = std::min( band * rows_per_band, dst.rows );
+                const int32_t end = std::min( begin + rows_per_band, dst.rows );
+                const uint32_t* input = reinterpret_cast<const uint32_t*>( data + band_offsets[band] );
+                if( !decode_band( input, band_sizes[band], dst.ptr<uint16_t>( begin ), static_cast<size_t>( end - begin ) * dst.cols ) ){
+                    is_broken = true;
+                }
+            }
+        } );
+        if( is_broken ){
+            throw std::runtime_error( "[error] broken rvl data!" );
+        }
+    }
+}
+
+#endif // __DEPTH_CODEC__
@@ -0,0 +1,232 @@
+#ifndef __FRAME_PREFETCHER__
+#define __FRAME_PREFETCHER__
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <utility>
+#include <stdexcept>
+
+#include <opencv2/opencv.hpp>
+
+#include "stats.h"
+
+// Decoded frame set in buffer of prefetch pool
+struct prefetched_frameset
+{
+    size_t index = 0;
+    uint64_t timestamp = 0; // [ms]
+    bool is_valid = false;
+    cv::Mat color;
+    cv::Mat depth;
+};
+
+// Read-ahead of frame sets
+// Next frame sets are read and decoded on background thread into pool of buffers, so storage latency spike does not stall display.
+class frame_prefetcher
+{
+public:
+    // Read and Decode Frame Set of Index into Buffer (called on prefetch thread)
+    // Buffer is reused, so decode into existing cv::Mat to avoid allocation.
+    using read_function = std::function<void( const size_t, prefetched_frameset& )>;
+
+private:
+    // Pool
+    read_function read;
+    size_t count; // number of frame sets
+    std::vector<prefetched_frameset> pool;
+    size_t head = 0; // oldest decoded frame set
+    size_t filled = 0; // number of decoded frame sets
+    size_t next_read = 0;
+    size_t next_get = 0;
+    uint64_t generation = 0; // incremented by seek, frame set being decoded for previous generation is discarded
+    std::mutex pool_mutex;
+    std::condition_variable ready;
+    std::condition_variable space;
+
+    // Prefetch
+    std::thread prefetch_thread;
+    bool is_running = false;
+
+    // Statistics
+    uint64_t hits = 0; // frame set was decoded before requested
+    uint64_t misses = 0; // requester had to wait
+    uint64_t seeks = 0;
+    uint64_t failed_frames = 0;
+    latency_stats read_stats;
+    latency_stats stall_stats;
+
+public:
+    // Constructor
+    // count is number of frame sets, depth is number of frame sets read ahead.
+    frame_prefetcher( read_function read, const size_t count, const size_t depth = 8 )
+        : read( read ), count( count ), pool( depth )
+    {
+        if( depth == 0 ){
+            throw std::runtime_error( "[error] depth of prefetcher must be greater than zero!" );
+        }
+
+        // Start Prefetch Thread
+        is_running = true;
+        prefetch_thread = std::thread( [this](){ run(); } );
+    }
+
+    // Destructor
+    ~frame_prefetcher()
+    {
+        stop();
+    }
+
+    frame_prefetcher( const frame_prefetcher& ) = delete;
+    frame_prefetcher& operator=( const frame_prefetcher& ) = delete;
+
+    // Get Frame Set of Index
+    // Buffers of dst are swapped with pool, so dst is reused without allocation. Requesting index other than next one is seek.
+    // Return false if index is out of range, prefetcher is stopped or frame set could not be read.
+    bool get( const size_t index, prefetched_frameset& dst )
+    {
+        std::unique_lock<std::mutex> lock( pool_mutex );
+        if( index >= count || !is_running ){
+            return false;
+        }
+
+        // Seek (discard frame sets read ahead)
+        if( index != next_get ){
+            generation++;
+            filled = 0;
+            next_read = index;
+            seeks++;
+            space.notify_one();
+        }
+        next_get = index + 1;
+
+        // Wait for Frame Set
+        if( filled == 0 ){
+            misses++;
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            ready.wait( lock, [this](){ return filled != 0 || !is_running; } );
+            stall_stats.add( std::chrono::steady_clock::now() - start );
+            if( filled == 0 ){
+                return false; // stopped
+            }
+        }
+        else{
+            hits++;
+        }
+
+        std::swap( dst, pool[head] );
+        head = ( head + 1 ) % pool.size();
+        filled--;
+
+        lock.unlock();
+        space.notify_one();
+        return dst.is_valid;
+    }
+
+    // Stop
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock( pool_mutex );
+            if( !is_running ){
+                return;
+            }
+            is_running = false;
+        }
+        ready.notify_all();
+        space.notify_all();
+
+        if( prefetch_thread.joinable() ){
+            prefetch_thread.join();
+        }
+    }
+
+    // Number of Hits
+    uint64_t hit_count()
+    {
+        std::lock_guard<std::mutex> lock( pool_mutex );
+        return hits;
+    }
+
+    // Number of Misses
+    uint64_t miss_count()
+    {
+        std::lock_guard<std::mutex> lock( pool_mutex );
+        return misses;
+    }
+
+    // To String
+    std::string to_string()
+    {
+        std::lock_guard<std::mutex> lock( pool_mutex );
+        const uint64_t requests = hits + misses;
+
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision( 3 );
+        stream << "hit " << hits << ", miss " << misses << " (hit rate " << ( requests != 0 ? 100.0 * hits / requests : 0.0 ) << " %), ";
+        stream << "seek " << seeks << ", failed " << failed_frames << " frames\n";
+        stream << "read : " << read_stats.to_string() << "\n";
+        stream << "stall : " << stall_stats.to_string();
+        return stream.str();
+    }
+
+private:
+    // Prefetch Loop
+    void run()
+    {
+        while( true ){
+            // Claim Free Buffer
+            size_t index = 0;
+            size_t slot = 0;
+            uint64_t claimed_generation = 0;
+            {
+                std::unique_lock<std::mutex> lock( pool_mutex );
+                space.wait( lock, [this](){ return ( filled < pool.size() && next_read < count ) || !is_running; } );
+                if( !is_running ){
+                    return;
+                }
+
+                index = next_read++;
+                slot = ( head + filled ) % pool.size();
+                claimed_generation = generation;
+            }
+
+            // Read and Decode (buffer is not visible to requester until it is filled)
+            prefetched_frameset& buffer = pool[slot];
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            try{
+                read( index, buffer );
+                buffer.is_valid = true;
+            }
+            catch( ... ){
+                buffer.is_valid = false;
+            }
+            buffer.index = index;
+            const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+            // Publish Frame Set (statistics are read by to_string() under same lock)
+            {
+                std::lock_guard<std::mutex> lock( pool_mutex );
+                read_stats.add( elapsed );
+                if( claimed_generation != generation ){
+                    continue; // seek happened while decoding
+                }
+                if( !buffer.is_valid ){
+                    std::cout << "[warning] failed to read frame set " << index << "!" << std::endl;
+                    failed_frames++;
+                }
+                filled++;
+            }
+            ready.notify_one();
+        }
+    }
+};
+
+#endif // __FRAME_PREFETCHER__
@@ -2,7 +2,10 @@
 #include "util.h"
 
 #include <vector>
+#include <string>
 #include <chrono>
+#include <thread>
+#include <algorithm>
 
 // Constructor
 orbbec::orbbec()
@@ -20,7 +23,11 @@ orbbec::~orbbec()
 // Initialize
 void orbbec::initialize()
 {
-    if( bag_file.empty() ){
+    if( !chunk_file.empty() ){
+        // Initialize Chunk Player
+        initialize_chunk_player();
+    }
+    else if( bag_file.empty() ){
         // Initialize Sensor
         initialize_sensor();
     }
@@ -104,14 +111,59 @@ void orbbec::initialize_player()
     pipeline->start( nullptr );
 }
 
+// Initialize Chunk Player
+void orbbec::initialize_chunk_player()
+{
+    // Open Chunk File (mapped into memory)
+    chunk_player = std::make_unique<chunk_reader>( chunk_file );
+    if( chunk_player->size() == 0 ){
+        throw std::runtime_error( "[error] chunk file has no frames!" );
+    }
+
+    // Start Prefetcher
+    if( use_prefetch ){
+        prefetcher = std::make_unique<frame_prefetcher>( [this]( const size_t index, prefetched_frameset& dst ){ read_chunk_frameset( index, dst ); }, chunk_player->size(), prefetch_depth );
+    }
+
+    // Seek to Start Position (frame index is built when file is opened, so seek is O(log n) by timestamp and O(1) by index)
+    if( seek_timestamp >= 0 ){
+        seek_time( static_cast<uint64_t>( seek_timestamp ) );
+    }
+    else if( seek_index >= 0 ){
+        seek( static_cast<size_t>( seek_index ) );
+    }
+    else{
+        seek( 0 );
+    }
+
+    played_framesets = 0;
+    play_start = std::chrono::steady_clock::now();
+}
+
 // Finalize
 void orbbec::finalize()
 {
+    // Show Statistics of Chunk Player
+    if( chunk_player != nullptr ){
+        const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - play_start ).count();
+        std::cout << "[info] played " << played_framesets << " frame sets in " << elapsed << " sec (" << ( elapsed > 0.0 ? played_framesets / elapsed : 0.0 ) << " fps)" << std::endl;
+    }
+
+    // Stop Prefetcher
+    if( prefetcher != nullptr ){
+        prefetcher->stop();
+        std::cout << "[info] prefetch\n" << prefetcher->to_string() << std::endl;
+    }
+
     // Stop Player
-    player->stop();
+    if( player != nullptr ){
+        player->stop();
+    }
 
     // Stop Pipeline
-    pipeline->stop();
+    if( pipeline != nullptr ){
+        pipeline->stop();
+    }
 }
 
 // Run
@@ -125,15 +177,112 @@ void orbbec::run()
         // Draw
         draw();
 
+        // Headless Player is not bounded by window and key wait
+        if( is_headless ){
+            continue;
+        }
+
         // Show
         show();
 
         // Wait Key
-        constexpr int32_t delay = 10;
+        // Wait is shortened while playing as fast as possible, so main loop is bounded by disk and decode.
+        const int32_t delay = ( chunk_player != nullptr && playback_rate == 0.0 ) ? 1 : 10;
         const int32_t key = cv::waitKey( delay );
         if( key == 'q' ){
             break;
         }
+
+        // Handle Key
+        handle_key( key );
+    }
+}
+
+// Handle Key
+// [ ] : half/double playback rate, 0 : as fast as possible, 1 : realtime
+// j l : seek backward/forward 10 seconds, , . : seek backward/forward 100 frame sets, h : seek to beginning
+inline void orbbec::handle_key( const int32_t key )
+{
+    if( key == -1 ){
+        return;
+    }
+
+    if( chunk_player == nullptr ){
+        if( std::string( "[]01jl,.h" ).find( static_cast<char>( key ) ) != std::string::npos ){
+            std::cout << "[warning] seek and playback rate are supported with chunk file only!" << std::endl;
+        }
+        return;
+    }
+
+    constexpr uint64_t seek_step_time = 10000; // [ms]
+    constexpr size_t seek_step_index = 100;
+    const size_t current_index = std::min( chunk_index, chunk_player->size() - 1 );
+    const uint64_t current_timestamp = chunk_player->timestamp( current_index );
+    switch( key ){
+        case '[':
+            set_playback_rate( playback_rate == 0.0 ? 1.0 : playback_rate * 0.5 );
+            break;
+        case ']':
+            set_playback_rate( playback_rate == 0.0 ? 1.0 : playback_rate * 2.0 );
+            break;
+        case '0':
+            set_playback_rate( 0.0 );
+            break;
+        case '1':
+            set_playback_rate( 1.0 );
+            break;
+        case 'j':
+            seek_time( current_timestamp > seek_step_time ? current_timestamp - seek_step_time : 0 );
+            break;
+        case 'l':
+            seek_time( current_timestamp + seek_step_time );
+            break;
+        case ',':
+            seek( current_index > seek_step_index ? current_index - seek_step_index : 0 );
+            break;
+        case '.':
+            seek( current_index + seek_step_index );
+            break;
+        case 'h':
+            seek( 0 );
+            break;
+        default:
+            break;
+    }
+}
+
+// Seek Chunk Player by Frame Set Index
+inline void orbbec::seek( const size_t index )
+{
+    if( index >= chunk_player->size() ){
+        std::cout << "[warning] seek position is out of range!" << std::endl;
+        return;
+    }
+
+    // Restart Timing from Frame Set
+    chunk_index = index;
+    chunk_start_timestamp = chunk_player->timestamp( chunk_index );
+    chunk_start = std::chrono::steady_clock::now();
+}
+
+// Seek Chunk Player by Timestamp
+// Seek to first frame set at or after timestamp.
+inline void orbbec::seek_time( const uint64_t timestamp )
+{
+    seek( chunk_player->find( timestamp ) );
+}
+
+// Set Playback Rate
+inline void orbbec::set_playback_rate( const double rate )
+{
+    constexpr double min_rate = 1.0 / 16.0;
+    constexpr double max_rate = 16.0;
+    playback_rate = ( rate == 0.0 ) ? 0.0 : std::clamp( rate, min_rate, max_rate );
+    std::cout << "[info] playback rate " << ( playback_rate == 0.0 ? std::string( "as fast as possible" ) : cv::format( "x%.3f", playback_rate ) ) << std::endl;
+
+    // Restart Timing from Current Frame Set
+    if( chunk_player != nullptr && chunk_index < chunk_player->size() ){
+        seek( chunk_index );
     }
 }
 
@@ -153,11 +302,123 @@ void orbbec::update()
 // Update Frame
 inline void orbbec::update_frame()
 {
+    if( chunk_player != nullptr ){
+        // Update Chunk Frame
+        update_chunk_frame();
+        return;
+    }
+
     // Get Frame Set
     constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
     frameset = pipeline->waitForFrames( timeout );
 }
 
+// Update Chunk Frame
+inline void orbbec::update_chunk_frame()
+{
+    color_chunk = nullptr;
+    depth_chunk = nullptr;
+    is_prefetched = false;
+
+    if( chunk_index >= chunk_player->size() ){
+        is_run = false;
+        return;
+    }
+
+    // Wait until Timing of Frame Set from Start (scaled by playback rate)
+    if( playback_rate > 0.0 ){
+        const uint64_t elapsed = chunk_player->timestamp( chunk_index ) - chunk_start_timestamp;
+        const std::chrono::duration<double, std::milli> wait = std::chrono::duration<double, std::milli>( elapsed / playback_rate );
+        std::this_thread::sleep_until( chunk_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>( wait ) );
+    }
+
+    // Get Decoded Frame Set from Prefetcher
+    if( prefetcher != nullptr ){
+        is_prefetched = prefetcher->get( chunk_index++, prefetched );
+        if( !is_prefetched ){
+            return;
+        }
+        played_framesets++;
+
+        // Get Depth Range
+        if( !prefetched.depth.empty() && std::get<1>( depth_range ) == 0.0 ){
+            depth_range = get_depth_range( prefetched.depth.cols, prefetched.depth.rows );
+        }
+        return;
+    }
+
+    // Read Frame Set (frames refer to mapped file)
+    if( read_delay != 0 ){
+        std::this_thread::sleep_for( std::chrono::milliseconds( read_delay ) );
+    }
+    chunk_player->read( chunk_index++, chunk_frames );
+    played_framesets++;
+    for( const chunk::frame& frame : chunk_frames ){
+        switch( frame.header->frame_type ){
+            case OBFrameType::OB_FRAME_COLOR:
+                color_chunk = &frame;
+                break;
+            case OBFrameType::OB_FRAME_DEPTH:
+                depth_chunk = &frame;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Get Depth Range
+    if( depth_chunk != nullptr && std::get<1>( depth_range ) == 0.0 ){
+        depth_range = get_depth_range( depth_chunk->header->width, depth_chunk->header->height );
+    }
+}
+
+// Read Chunk Frame Set (prefetch thread)
+inline void orbbec::read_chunk_frameset( const size_t index, prefetched_frameset& dst )
+{
+    if( read_delay != 0 ){
+        std::this_thread::sleep_for( std::chrono::milliseconds( read_delay ) );
+    }
+
+    // Read Frame Set and Decode into Buffers of Pool
+    chunk_player->read( index, prefetch_frames );
+    dst.timestamp = chunk_player->timestamp( index );
+    bool has_color = false;
+    bool has_depth = false;
+    for( const chunk::frame& frame : prefetch_frames ){
+        switch( frame.header->frame_type ){
+            case OBFrameType::OB_FRAME_COLOR:
+                decode_chunk_frame( frame, dst.color );
+                has_color = true;
+                break;
+            case OBFrameType::OB_FRAME_DEPTH:
+                decode_chunk_frame( frame, dst.depth );
+                has_depth = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Release Stale Frame (frame set does not have all streams)
+    if( !has_color ){
+        dst.color.release();
+    }
+    if( !has_depth ){
+        dst.depth.release();
+    }
+}
+
+// Decode Chunk Frame
+inline void orbbec::decode_chunk_frame( const chunk::frame& frame, cv::Mat& dst )
+{
+    const chunk::frame_header* header = frame.header;
+    if( header->compression == static_cast<uint32_t>( chunk::compression::rvl ) ){
+        rvl::decode( frame.data, header->data_size, dst );
+        return;
+    }
+    ob::get_mat( static_cast<OBFrameType>( header->frame_type ), static_cast<OBFormat>( header->format ), header->width, header->height, frame.data, static_cast<uint32_t>( header->data_size ), dst );
+}
+
 // Update Color
 inline void orbbec::update_color()
 {
@@ -193,23 +454,73 @@ void orbbec::draw()
 // Draw Color
 inline void orbbec::draw_color()
 {
+    if( is_prefetched ){
+        // Take Decoded cv::Mat from Prefetcher (previous one goes back to pool)
+        // Frame set without color frame is empty, so stale color is not shown with new frame set.
+        cv::swap( color, prefetched.color );
+        return;
+    }
+
+    if( color_chunk != nullptr ){
+        // Get cv::Mat from Chunk Frame
+        decode_chunk_frame( *color_chunk, color );
+        return;
+    }
+
+    if( chunk_player != nullptr ){
+        // Frame set was read without color frame
+        if( prefetcher == nullptr ){
+            color.release();
+        }
+        return;
+    }
+
     if( color_frame == nullptr ){
+        // Frame set was received without color frame
+        if( frameset != nullptr ){
+            color.release();
+        }
         return;
     }
 
     // Get cv::Mat from ob::VideoFrame
-    color = ob::get_mat( color_frame );
+    ob::get_mat( color_frame, color );
 }
 
 // Draw Depth
 inline void orbbec::draw_depth()
 {
+    if( is_prefetched ){
+        // Take Decoded cv::Mat from Prefetcher (previous one goes back to pool)
+        // Frame set without depth frame is empty, so stale depth is not shown with new frame set.
+        cv::swap( depth, prefetched.depth );
+        return;
+    }
+
+    if( depth_chunk != nullptr ){
+        // Get cv::Mat from Chunk Frame
+        decode_chunk_frame( *depth_chunk, depth );
+        return;
+    }
+
+    if( chunk_player != nullptr ){
+        // Frame set was read without depth frame
+        if( prefetcher == nullptr ){
+            depth.release();
+        }
+        return;
+    }
+
     if( depth_frame == nullptr ){
+        // Frame set was received without depth frame
+        if( frameset != nullptr ){
+            depth.release();
+        }
         return;
     }
 
     // Get cv::Mat from ob::VideoFrame
-    depth = ob::get_mat( depth_frame );
+    ob::get_mat( depth_frame, depth );
 }
 
 // Show
@@ -231,7 +542,7 @@ inline void orbbec::show_color()
 
     // Show Image
     const cv::String window_name = ( player == nullptr ) ? cv::format( "color (orbbec %d)", device_index )
-                                                         : cv::format( "color (orbbec %s)", playback->getDeviceInfo()->serialNumber() );
+                                                         : cv::format( "color (orbbec %s)", player->getDeviceInfo()->serialNumber() );
     cv::imshow( window_name, color );
 }
 
@@ -243,21 +554,27 @@ inline void orbbec::show_depth()
     }
 
     // Scaling Depth
-    const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
-    depth.convertTo( depth, CV_8U, -255.0 / max_range, 255.0 );
+    if( depth_lut.empty() ){
+        const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
+        depth_lut = ob::create_depth_lut( max_range );
+    }
+    ob::visualize_depth( depth, depth_lut, depth_scaled );
 
     // Show Image
     const cv::String window_name = ( player == nullptr ) ? cv::format( "depth (orbbec %d)", device_index )
-                                                         : cv::format( "depth (orbbec %s)", playback->getDeviceInfo()->serialNumber() );
-    cv::imshow( window_name, depth );
+                                                         : cv::format( "depth (orbbec %s)", player->getDeviceInfo()->serialNumber() );
+    cv::imshow( window_name, depth_scaled );
 }
 
 // Get Depth Range
 inline std::tuple<double, double> orbbec::get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile )
 {
-    const uint16_t width = depth_stream_profile->width();
-    const uint16_t height = depth_stream_profile->height();
+    return get_depth_range( depth_stream_profile->width(), depth_stream_profile->height() );
+}
 
+// Get Depth Range
+inline std::tuple<double, double> orbbec::get_depth_range( const uint32_t width, const uint32_t height )
+{
     if( width == 320 && height == 288 ){
         return std::make_tuple( 500.0, 5460.0 );
     }
@@ -271,5 +588,7 @@ inline std::tuple<double, double> orbbec::get_depth_range( std::shared_ptr<ob::V
         return std::make_tuple( 250.0, 2210.0 );
     }
 
-    throw std::runtime_error( "[error] unknown depth format!" );
+    // Unknown resolution (e.g. recorded by other device) falls back to widest range
+    std::cout << "[warning] unknown depth resolution " << width << "x" << height << ", use default depth range!" << std::endl;
+    return std::make_tuple( 500.0, 5460.0 );
 }
@@ -1,9 +1,14 @@
 #ifndef __ORBBEC__
 #define __ORBBEC__
 
+#include <chrono>
+
 #include <libobsensor/ObSensor.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "chunk_file.h"
+#include "frame_prefetcher.h"
+
 class orbbec
 {
 private:
@@ -26,13 +31,42 @@ private:
     std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile = nullptr;
     std::shared_ptr<ob::DepthFrame> depth_frame = nullptr;
     cv::Mat depth;
+    cv::Mat depth_scaled;
     std::tuple<double, double> depth_range = std::make_tuple<double, double>( 0.0, 0.0 );
+    cv::Mat depth_lut;
 
     // Player
     std::string bag_file = "../data.bag";
     std::shared_ptr<ob::Playback> player = nullptr;
     bool is_run = true;
 
+    // Chunk Player
+    std::string chunk_file = ""; // play memory-mappable chunk file (e.g. "../data.chunk") instead of bag file if specified
+    std::unique_ptr<chunk_reader> chunk_player = nullptr;
+    std::vector<chunk::frame> chunk_frames;
+    const chunk::frame* color_chunk = nullptr;
+    const chunk::frame* depth_chunk = nullptr;
+    size_t chunk_index = 0;
+    std::chrono::steady_clock::time_point chunk_start; // time when frame set at chunk_start_timestamp should be shown
+    uint64_t chunk_start_timestamp = 0;
+
+    // Playback Control (chunk player)
+    double playback_rate = 1.0; // speed relative to realtime (e.g. 2.0 is twice as fast), 0.0 is as fast as possible (ignore timing)
+    int64_t seek_timestamp = -1; // seek to timestamp [ms] of recording at start if specified
+    int64_t seek_index = -1; // seek to frame set index at start if specified
+    uint64_t played_framesets = 0;
+    std::chrono::steady_clock::time_point play_start;
+    bool is_headless = false; // play without windows (no imshow and waitKey), e.g. to measure throughput of disk and decode at playback rate 0
+
+    // Prefetch (chunk player)
+    bool use_prefetch = true; // read and decode next frame sets on background thread
+    size_t prefetch_depth = 8; // number of frame sets read ahead
+    uint32_t read_delay = 0; // [ms] simulate slow storage for read of each frame set
+    std::unique_ptr<frame_prefetcher> prefetcher = nullptr;
+    std::vector<chunk::frame> prefetch_frames; // used on prefetch thread
+    prefetched_frameset prefetched;
+    bool is_prefetched = false;
+
 public:
     // Constructor
     orbbec();
@@ -62,12 +96,36 @@ private:
     // Initialize Player
     void initialize_player();
 
+    // Initialize Chunk Player
+    void initialize_chunk_player();
+
     // Finalize
     void finalize();
 
+    // Handle Key
+    void handle_key( const int32_t key );
+
+    // Seek Chunk Player by Frame Set Index
+    void seek( const size_t index );
+
+    // Seek Chunk Player by Timestamp
+    void seek_time( const uint64_t timestamp );
+
+    // Set Playback Rate
+    void set_playback_rate( const double rate );
+
     // Update Frame
     void update_frame();
 
+    // Update Chunk Frame
+    void update_chunk_frame();
+
+    // Read Chunk Frame Set (prefetch thread)
+    void read_chunk_frameset( const size_t index, prefetched_frameset& dst );
+
+    // Decode Chunk Frame
+    void decode_chunk_frame( const chunk::frame& frame, cv::Mat& dst );
+
     // Update Color
     void update_color();
 
@@ -88,6 +146,7 @@ private:
 
     // Get Depth Range
     std::tuple<double, double> get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile );
+    std::tuple<double, double> get_depth_range( const uint32_t width, const uint32_t height );
 };
 
 #endif // __ORBBEC__
@@ -82,7 +82,12 @@ inline void orbbec::initialize_sensor()
     const OBCameraParam camera_parameter = pipeline->getCameraParam();
     pointcloud_filter->setCameraParam( camera_parameter );
     pointcloud_filter->setCreatePointFormat( format );
-    pointcloud_filter->setColorDataNormalization( true );
+    pointcloud_filter->setColorDataNormalization( false ); // 0-255 (point_cloud_buffer stores colors as uint8)
+
+    // Create Point Cloud Generator (depth is aligned to color unless point format)
+    if( use_generator ){
+        generator = std::make_unique<point_cloud_generator>( camera_parameter, format != OBFormat::OB_FORMAT_POINT );
+    }
 }
 
 // Initialize Point Cloud
@@ -155,8 +160,22 @@ inline void orbbec::update_pointclod()
         return;
     }
 
+    if( generator != nullptr ){
+        // Generate Points into SoA Buffers
+        const std::shared_ptr<ob::DepthFrame> depth_frame = frameset->depthFrame();
+        points.resize( static_cast<size_t>( depth_frame->width() ) * depth_frame->height() );
+        generator->generate( depth_frame, points.x(), points.y(), points.z() );
+        return;
+    }
+
     // Create Point Cloud from Frame Set
-    pointcloud_frame = pointcloud_filter->process( frameset );
+    const std::shared_ptr<ob::Frame> pointcloud_frame = pointcloud_filter->process( frameset );
+    if( pointcloud_frame == nullptr ){
+        return;
+    }
+
+    // Assign Point Cloud Frame (no copy)
+    points.assign( pointcloud_frame, format );
 }
 
 // Draw
@@ -169,40 +188,13 @@ void orbbec::draw()
 // Draw Point Cloud
 inline void orbbec::draw_pointcloud()
 {
-    if( pointcloud_frame == nullptr ){
+    if( !points.is_modified() ){
         return;
     }
 
-    // Create Point Cloud for Open3D
-    if( format == OBFormat::OB_FORMAT_RGB_POINT ){
-        const int32_t num_points = pointcloud_frame->dataSize() / sizeof( OBColorPoint );
-        OBColorPoint* data = reinterpret_cast<OBColorPoint*>( pointcloud_frame->data() );
-
-        std::vector<Eigen::Vector3d> points = std::vector<Eigen::Vector3d>( num_points );
-        std::vector<Eigen::Vector3d> colors = std::vector<Eigen::Vector3d>( num_points );
-
-        #pragma omp parallel for
-        for( int32_t i = 0; i < num_points; i++ ){
-            points[i] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z);
-            colors[i] = Eigen::Vector3d( data[i].r, data[i].g, data[i].b );
-        }
-
-        pointcloud->points_ = points;
-        pointcloud->colors_ = colors;
-    }
-    else{
-        const int32_t num_points = pointcloud_frame->dataSize() / sizeof( OBPoint );
-        OBPoint* data = reinterpret_cast<OBPoint*>( pointcloud_frame->data() );
-
-        std::vector<Eigen::Vector3d> points = std::vector<Eigen::Vector3d>( num_points );
-
-        #pragma omp parallel for
-        for( int32_t i = 0; i < num_points; i++ ){
-            points[i] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
-        }
-
-        pointcloud->points_ = points;
-    }
+    // Create Point Cloud for Open3D (in place, drop invalid points)
+    points.convert_to( *pointcloud );
+    is_drawn = true;
 }
 
 // Show
@@ -215,7 +207,7 @@ void orbbec::show()
 // Show Point Cloud
 inline void orbbec::show_pointcloud()
 {
-    if( pointcloud_frame == nullptr ){
+    if( points.size() == 0 ){
         return;
     }
 
@@ -225,7 +217,11 @@ inline void orbbec::show_pointcloud()
         is_added = true;
     }
 
-    visualizer.UpdateGeometry();
+    // Update Geometry only if Point Cloud is Converted
+    if( is_drawn ){
+        visualizer.UpdateGeometry();
+        is_drawn = false;
+    }
     visualizer.PollEvents();
     visualizer.UpdateRender();
 }
@@ -4,6 +4,9 @@
 #include <libobsensor/ObSensor.hpp>
 #include <open3d/Open3D.h>
 
+#include "point_cloud_generator.h"
+#include "point_cloud_buffer.h"
+
 class orbbec
 {
 private:
@@ -26,9 +29,15 @@ private:
     // Point Cloud
     OBFormat format = OBFormat::OB_FORMAT_RGB_POINT;
     std::shared_ptr<ob::PointCloudFilter> pointcloud_filter;
-    std::shared_ptr<ob::Frame> pointcloud_frame = nullptr;
+    point_cloud_buffer points; // float32 SoA (converted into pointcloud only when points are updated)
     std::shared_ptr<open3d::geometry::PointCloud> pointcloud = nullptr;
+    bool is_drawn = false;
     open3d::visualization::VisualizerWithKeyCallback visualizer;
+
+    // Point Cloud Generator
+    bool use_generator = false; // true: generate points by unprojection table instead of ob::PointCloudFilter (points only)
+    std::unique_ptr<point_cloud_generator> generator = nullptr;
+
     bool is_run = true;
 
 public:
@@ -0,0 +1,218 @@
+#ifndef __POINT_CLOUD_BUFFER__
+#define __POINT_CLOUD_BUFFER__
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include <libobsensor/ObSensor.hpp>
+#include <Eigen/Core>
+
+#include "point_compactor.h"
+
+/*
+ Point cloud with float32 SoA positions and uint8 RGB colors
+
+ Frame of point cloud filter (OB_FORMAT_POINT or OB_FORMAT_RGB_POINT) is referenced without copy,
+ and unpacked into SoA only when positions or colors are accessed.
+ Conversion into Open3D point cloud (double precision) is deferred until viewer needs it, and runs once for new points.
+ Colors of frame must not be normalized (0-255, ob::PointCloudFilter::setColorDataNormalization( false )).
+
+ point_cloud_buffer buffer;
+ buffer.assign( pointcloud_filter->process( frameset ), OBFormat::OB_FORMAT_RGB_POINT ); // no copy
+ if( buffer.is_modified() ){
+     buffer.convert_to( *pointcloud ); // open3d::geometry::PointCloud (invalid points are dropped)
+ }
+
+ buffer.resize( width * height ); // write positions directly (e.g. point_cloud_generator)
+ generator.generate( depth_frame, buffer.x(), buffer.y(), buffer.z() );
+*/
+class point_cloud_buffer
+{
+private:
+    // Source Frame (referenced, not copied)
+    std::shared_ptr<ob::Frame> frame = nullptr;
+
+    // Points
+    size_t count = 0;
+    bool has_color = false;
+    std::vector<float> xs; // [mm]
+    std::vector<float> ys;
+    std::vector<float> zs;
+    std::vector<uint8_t> rs;
+    std::vector<uint8_t> gs;
+    std::vector<uint8_t> bs;
+    bool is_unpacked = true; // true: SoA holds current points, false: only frame holds current points
+    bool modified = false; // true: not converted since points were assigned
+
+    // Conversion
+    point_compactor compactor;
+
+public:
+    // Assign Frame of Point Cloud Filter (no copy)
+    void assign( std::shared_ptr<ob::Frame> frame, const OBFormat format )
+    {
+        if( format != OBFormat::OB_FORMAT_POINT && format != OBFormat::OB_FORMAT_RGB_POINT ){
+            throw std::runtime_error( "[error] unsupported point format!" );
+        }
+
+        this->frame = frame;
+        has_color = ( format == OBFormat::OB_FORMAT_RGB_POINT );
+        count = frame->dataSize() / ( has_color ? sizeof( OBColorPoint ) : sizeof( OBPoint ) );
+        is_unpacked = false;
+        modified = true;
+    }
+
+    // Resize SoA to Write Points Directly
+    void resize( const size_t count, const bool has_color = false )
+    {
+        frame = nullptr;
+        this->count = count;
+        this->has_color = has_color;
+        reserve();
+        is_unpacked = true;
+        modified = true;
+    }
+
+    // Number of Points (including invalid points of zero depth)
+    size_t size() const
+    {
+        return count;
+    }
+
+    // Has Colors
+    bool has_colors() const
+    {
+        return has_color;
+    }
+
+    // Is Modified (new points are not converted yet)
+    bool is_modified() const
+    {
+        return modified;
+    }
+
+    // Memory Footprint of Points [bytes]
+    size_t memory_bytes() const
+    {
+        return count * ( 3 * sizeof( float ) + ( has_color ? 3 * sizeof( uint8_t ) : 0 ) );
+    }
+
+    // Positions [mm] (unpacked from frame on first access)
+    float* x() { unpack(); return xs.data(); }
+    float* y() { unpack(); return ys.data(); }
+    float* z() { unpack(); return zs.data(); }
+
+    // Colors (nullptr if points have no color)
+    uint8_t* r() { unpack(); return has_color ? rs.data() : nullptr; }
+    uint8_t* g() { unpack(); return has_color ? gs.data() : nullptr; }
+    uint8_t* b() { unpack(); return has_color ? bs.data() : nullptr; }
+
+    // Convert into Open3D Point Cloud (points_ and colors_, invalid points are dropped)
+    // Returns number of valid points. Buffers of point cloud are reused, and resized only if number of points is changed.
+    template<typename PointCloud>
+    size_t convert_to( PointCloud& pointcloud )
+    {
+        modified = false;
+
+        const int32_t num_points = static_cast<int32_t>( count );
+        const auto resize_points = [&]( const size_t valid_count ){
+            if( pointcloud.points_.size() != valid_count ){
+                pointcloud.points_.resize( valid_count );
+            }
+            const size_t color_count = has_color ? valid_count : 0;
+            if( pointcloud.colors_.size() != color_count ){
+                pointcloud.colors_.resize( color_count );
+            }
+        };
+
+        // Convert from Frame without Unpacking
+        if( !is_unpacked ){
+            if( has_color ){
+                const OBColorPoint* data = reinterpret_cast<const OBColorPoint*>( frame->data() );
+                return compactor.compact( num_points,
+                    [&]( const int32_t i ){ return data[i].z != 0.0f; },
+                    resize_points,
+                    [&]( const int32_t i, const int32_t j ){
+                        pointcloud.points_[j] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
+                        pointcloud.colors_[j] = Eigen::Vector3d( data[i].r, data[i].g, data[i].b ) / 255.0;
+                    } );
+            }
+
+            const OBPoint* data = reinterpret_cast<const OBPoint*>( frame->data() );
+            return compactor.compact( num_points,
+                [&]( const int32_t i ){ return data[i].z != 0.0f; },
+                resize_points,
+                [&]( const int32_t i, const int32_t j ){ pointcloud.points_[j] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z ); } );
+        }
+
+        // Convert from SoA
+        return compactor.compact( num_points,
+            [&]( const int32_t i ){ return zs[i] != 0.0f; },
+            resize_points,
+            [&]( const int32_t i, const int32_t j ){
+                pointcloud.points_[j] = Eigen::Vector3d( xs[i], ys[i], zs[i] );
+                if( has_color ){
+                    pointcloud.colors_[j] = Eigen::Vector3d( rs[i], gs[i], bs[i] ) / 255.0;
+                }
+            } );
+    }
+
+private:
+    // Reserve SoA for Number of Points
+    void reserve()
+    {
+        xs.resize( count );
+        ys.resize( count );
+        zs.resize( count );
+        rs.resize( has_color ? count : 0 );
+        gs.resize( has_color ? count : 0 );
+        bs.resize( has_color ? count : 0 );
+    }
+
+    // Unpack Points of Frame into SoA
+    void unpack()
+    {
+        if( is_unpacked ){
+            return;
+        }
+
+        reserve();
+        const int32_t num_points = static_cast<int32_t>( count );
+        if( has_color ){
+            const OBColorPoint* data = reinterpret_cast<const OBColorPoint*>( frame->data() );
+
+            #pragma omp parallel for
+            for( int32_t i = 0; i < num_points; i++ ){
+                xs[i] = data[i].x;
+                ys[i] = data[i].y;
+                zs[i] = data[i].z;
+                rs[i] = to_uint8( data[i].r );
+                gs[i] = to_uint8( data[i].g );
+                bs[i] = to_uint8( data[i].b );
+            }
+        }
+        else{
+            const OBPoint* data = reinterpret_cast<const OBPoint*>( frame->data() );
+
+            #pragma omp parallel for
+            for( int32_t i = 0; i < num_points; i++ ){
+                xs[i] = data[i].x;
+                ys[i] = data[i].y;
+                zs[i] = data[i].z;
+            }
+        }
+
+        is_unpacked = true;
+    }
+
+    // Convert Color (0.0-255.0) to uint8
+    static uint8_t to_uint8( const float value )
+    {
+        return static_cast<uint8_t>( std::min( std::max( value, 0.0f ), 255.0f ) + 0.5f );
+    }
+};
+
+#endif // __POINT_CLOUD_BUFFER__
@@ -0,0 +1,117 @@
+#ifndef __POINT_CLOUD_GENERATOR__
+#define __POINT_CLOUD_GENERATOR__
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+#include <libobsensor/ObSensor.hpp>
+
+/*
+ Point cloud generator with precomputed unprojection table
+
+ Ray (x/z, y/z) of each pixel is computed once for camera intrinsic and depth resolution,
+ so each frame costs one multiply per coordinate. Points are written into caller-provided SoA buffers (x, y, z).
+
+ point_cloud_generator generator( pipeline->getCameraParam(), true ); // depth is aligned to color (D2C)
+ std::vector<float> x( width * height ), y( width * height ), z( width * height );
+ generator.generate( depth_frame, x.data(), y.data(), z.data() );
+*/
+class point_cloud_generator
+{
+private:
+    // Intrinsic
+    OBCameraIntrinsic intrinsic;
+
+    // Ray Table
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> ray_x;
+    std::vector<float> ray_y;
+
+public:
+    // Constructor
+    // Intrinsic of color camera is used if depth is aligned to color (D2C), otherwise intrinsic of depth camera.
+    point_cloud_generator( const OBCameraParam& camera_parameter, const bool is_aligned )
+        : point_cloud_generator( is_aligned ? camera_parameter.rgbIntrinsic : camera_parameter.depthIntrinsic )
+    {
+    }
+
+    // Constructor
+    explicit point_cloud_generator( const OBCameraIntrinsic& intrinsic )
+        : intrinsic( intrinsic )
+    {
+        if( intrinsic.fx <= 0.0f || intrinsic.fy <= 0.0f ){
+            throw std::runtime_error( "[error] invalid camera intrinsic!" );
+        }
+    }
+
+    // Generate Points from Depth Frame
+    // x, y and z must have width * height elements. Point of invalid depth is (0, 0, 0). Unit is millimeter.
+    void generate( std::shared_ptr<ob::DepthFrame> depth_frame, float* x, float* y, float* z )
+    {
+        generate( reinterpret_cast<const uint16_t*>( depth_frame->data() ), depth_frame->width(), depth_frame->height(), depth_frame->getValueScale(), x, y, z );
+    }
+
+    // Generate Points from Depth (Y16)
+    // depth_scale is millimeter per unit of depth.
+    void generate( const uint16_t* depth, const uint32_t width, const uint32_t height, const float depth_scale, float* x, float* y, float* z )
+    {
+        update_ray_table( width, height );
+
+        #pragma omp parallel for
+        for( int32_t v = 0; v < static_cast<int32_t>( height ); v++ ){
+            const size_t offset = static_cast<size_t>( v ) * width;
+            const uint16_t* src = depth + offset;
+            const float* rx = ray_x.data() + offset;
+            const float* ry = ray_y.data() + offset;
+            float* px = x + offset;
+            float* py = y + offset;
+            float* pz = z + offset;
+
+            #pragma omp simd
+            for( int32_t u = 0; u < static_cast<int32_t>( width ); u++ ){
+                const float d = src[u] * depth_scale;
+                px[u] = d * rx[u];
+                py[u] = d * ry[u];
+                pz[u] = d;
+            }
+        }
+    }
+
+private:
+    // Update Ray Table for Resolution
+    void update_ray_table( const uint32_t width, const uint32_t height )
+    {
+        if( this->width == width && this->height == height ){
+            return;
+        }
+
+        // Scale Intrinsic to Resolution (e.g. intrinsic of full resolution for binned depth mode)
+        float fx = intrinsic.fx, fy = intrinsic.fy, cx = intrinsic.cx, cy = intrinsic.cy;
+        if( intrinsic.width > 0 && intrinsic.height > 0 && ( static_cast<uint32_t>( intrinsic.width ) != width || static_cast<uint32_t>( intrinsic.height ) != height ) ){
+            const float sx = static_cast<float>( width ) / intrinsic.width;
+            const float sy = static_cast<float>( height ) / intrinsic.height;
+            fx *= sx;
+            fy *= sy;
+            cx = ( cx + 0.5f ) * sx - 0.5f;
+            cy = ( cy + 0.5f ) * sy - 0.5f;
+        }
+
+        ray_x.resize( static_cast<size_t>( width ) * height );
+        ray_y.resize( static_cast<size_t>( width ) * height );
+        for( uint32_t v = 0; v < height; v++ ){
+            for( uint32_t u = 0; u < width; u++ ){
+                const size_t i = static_cast<size_t>( v ) * width + u;
+                ray_x[i] = ( u - cx ) / fx;
+                ray_y[i] = ( v - cy ) / fy;
+            }
+        }
+
+        this->width = width;
+        this->height = height;
+    }
+};
+
+#endif // __POINT_CLOUD_GENERATOR__
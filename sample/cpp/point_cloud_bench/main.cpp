@@ -0,0 +1,446 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include <Eigen/Core>
+
+#include "point_cloud_generator.h"
+#include "point_compactor.h"
+#include "point_cloud_buffer.h"
+
+// Heap Allocation Counter (operator new)
+std::atomic<uint64_t> heap_allocations = 0;
+
+void* operator new( std::size_t size )
+{
+    heap_allocations.fetch_add( 1, std::memory_order_relaxed );
+    void* pointer = std::malloc( size != 0 ? size : 1 );
+    if( pointer == nullptr ){
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete( void* pointer, std::size_t size ) noexcept
+{
+    std::free( pointer );
+}
+
+// Depth Mode
+struct depth_mode
+{
+    std::string name;
+    OBCameraIntrinsic intrinsic;
+};
+
+// Benchmark Result
+struct bench_result
+{
+    std::string name;
+    uint32_t width;
+    uint32_t height;
+    double filter_ms; // ob::PointCloudFilter::process
+    double filter_copy_ms; // ob::PointCloudFilter::process and copy into SoA (same as sample)
+    double generator_ms; // point_cloud_generator::generate into SoA
+    double max_error_mm; // difference between filter and generator (-1 if number of points does not match)
+};
+
+// Draw Benchmark Result (conversion of OBColorPoint into points_/colors_ of Open3D)
+struct draw_result
+{
+    std::string name;
+    uint32_t width;
+    uint32_t height;
+    size_t valid_points;
+    double copy_ms; // allocate vectors, convert, and copy-assign (previous draw_pointcloud)
+    double copy_allocations; // per frame
+    double in_place_ms; // convert in place into persistent vectors and drop invalid points
+    double in_place_allocations; // per frame
+};
+
+// Container Benchmark Result (1024x1024)
+struct container_result
+{
+    std::string name;
+    size_t bytes; // memory footprint of points
+    double ms; // cost to create points from frame of OB_FORMAT_RGB_POINT
+};
+
+// Destination of Conversion (same members as open3d::geometry::PointCloud)
+struct eigen_pointcloud
+{
+    std::vector<Eigen::Vector3d> points_;
+    std::vector<Eigen::Vector3d> colors_;
+};
+
+// Measure Average Time of Function [ms]
+template<typename Function>
+double measure( Function function )
+{
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 500 );
+    function(); // warm up (ray table, buffers)
+
+    uint64_t iterations = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = start;
+    while( end - start < duration ){
+        function();
+        iterations++;
+        end = std::chrono::steady_clock::now();
+    }
+    return std::chrono::duration<double, std::milli>( end - start ).count() / iterations;
+}
+
+// Create Frame Set of Synthetic Depth (slanted plane from 500 mm to 4000 mm with invalid pixels)
+std::shared_ptr<ob::FrameSet> create_frameset( const uint32_t width, const uint32_t height )
+{
+    std::shared_ptr<ob::Frame> frame = ob::FrameHelper::createFrame( OBFrameType::OB_FRAME_DEPTH, OBFormat::OB_FORMAT_Y16, width, height, width * 2 );
+    uint16_t* data = reinterpret_cast<uint16_t*>( frame->data() );
+    for( uint32_t v = 0; v < height; v++ ){
+        for( uint32_t u = 0; u < width; u++ ){
+            const bool is_invalid = ( ( u * 7 + v * 13 ) % 10 ) == 0;
+            data[v * width + u] = is_invalid ? 0 : static_cast<uint16_t>( 500 + 3500 * ( u + v ) / ( width + height ) );
+        }
+    }
+
+    std::shared_ptr<ob::FrameSet> frameset = ob::FrameHelper::createFrameSet();
+    ob::FrameHelper::pushFrame( frameset, OBFrameType::OB_FRAME_DEPTH, frame );
+    return frameset;
+}
+
+// Run Benchmark of Depth Mode
+bench_result run( const depth_mode& mode )
+{
+    const uint32_t width = mode.intrinsic.width;
+    const uint32_t height = mode.intrinsic.height;
+    const size_t num_points = static_cast<size_t>( width ) * height;
+    const std::shared_ptr<ob::FrameSet> frameset = create_frameset( width, height );
+    const std::shared_ptr<ob::DepthFrame> depth_frame = frameset->depthFrame();
+
+    // Camera Parameter (depth is not aligned, no distortion)
+    OBCameraParam camera_parameter = {};
+    camera_parameter.depthIntrinsic = mode.intrinsic;
+    camera_parameter.rgbIntrinsic = mode.intrinsic;
+    camera_parameter.transform.rot[0] = camera_parameter.transform.rot[4] = camera_parameter.transform.rot[8] = 1.0f;
+
+    ob::PointCloudFilter pointcloud_filter;
+    pointcloud_filter.setCameraParam( camera_parameter );
+    pointcloud_filter.setCreatePointFormat( OBFormat::OB_FORMAT_POINT );
+
+    point_cloud_generator generator( camera_parameter, false );
+    std::vector<float> x( num_points ), y( num_points ), z( num_points );
+
+    bench_result result;
+    result.name = mode.name;
+    result.width = width;
+    result.height = height;
+
+    // Validate
+    const std::shared_ptr<ob::Frame> pointcloud_frame = pointcloud_filter.process( frameset );
+    generator.generate( depth_frame, x.data(), y.data(), z.data() );
+    result.max_error_mm = -1.0;
+    if( pointcloud_frame != nullptr && pointcloud_frame->dataSize() / sizeof( OBPoint ) == num_points ){
+        const OBPoint* points = reinterpret_cast<const OBPoint*>( pointcloud_frame->data() );
+        result.max_error_mm = 0.0;
+        for( size_t i = 0; i < num_points; i++ ){
+            const double error = std::max( { std::abs( points[i].x - x[i] ), std::abs( points[i].y - y[i] ), std::abs( points[i].z - z[i] ) } );
+            result.max_error_mm = std::max( result.max_error_mm, error );
+        }
+    }
+
+    // Measure
+    result.filter_ms = measure( [&](){
+        pointcloud_filter.process( frameset );
+    } );
+    result.filter_copy_ms = measure( [&](){
+        const std::shared_ptr<ob::Frame> frame = pointcloud_filter.process( frameset );
+        const OBPoint* points = reinterpret_cast<const OBPoint*>( frame->data() );
+        const int32_t count = static_cast<int32_t>( std::min( frame->dataSize() / sizeof( OBPoint ), num_points ) );
+
+        #pragma omp parallel for
+        for( int32_t i = 0; i < count; i++ ){
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+            z[i] = points[i].z;
+        }
+    } );
+    result.generator_ms = measure( [&](){
+        generator.generate( depth_frame, x.data(), y.data(), z.data() );
+    } );
+
+    return result;
+}
+
+// Measure Average Heap Allocations of Function
+template<typename Function>
+double measure_allocations( Function function )
+{
+    constexpr uint64_t iterations = 16;
+    function(); // warm up (buffers)
+
+    const uint64_t start = heap_allocations.load();
+    for( uint64_t i = 0; i < iterations; i++ ){
+        function();
+    }
+    return static_cast<double>( heap_allocations.load() - start ) / iterations;
+}
+
+// Run Draw Benchmark of Depth Mode
+draw_result run_draw( const depth_mode& mode )
+{
+    const uint32_t width = mode.intrinsic.width;
+    const uint32_t height = mode.intrinsic.height;
+    const int32_t num_points = static_cast<int32_t>( width * height );
+
+    // Synthetic Colored Points (same invalid pixels as synthetic depth)
+    const std::shared_ptr<ob::FrameSet> frameset = create_frameset( width, height );
+    point_cloud_generator generator( mode.intrinsic );
+    std::vector<float> x( num_points ), y( num_points ), z( num_points );
+    generator.generate( frameset->depthFrame(), x.data(), y.data(), z.data() );
+
+    std::vector<OBColorPoint> data( num_points );
+    for( int32_t i = 0; i < num_points; i++ ){
+        data[i] = { x[i], y[i], z[i], static_cast<float>( i % 256 ), static_cast<float>( ( i / 256 ) % 256 ), 128.0f };
+    }
+
+    // Previous draw_pointcloud
+    eigen_pointcloud copy_pointcloud;
+    const auto convert_copy = [&](){
+        std::vector<Eigen::Vector3d> points = std::vector<Eigen::Vector3d>( num_points );
+        std::vector<Eigen::Vector3d> colors = std::vector<Eigen::Vector3d>( num_points );
+
+        #pragma omp parallel for
+        for( int32_t i = 0; i < num_points; i++ ){
+            points[i] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
+            colors[i] = Eigen::Vector3d( data[i].r, data[i].g, data[i].b );
+        }
+
+        copy_pointcloud.points_ = points;
+        copy_pointcloud.colors_ = colors;
+    };
+
+    // Current draw_pointcloud
+    eigen_pointcloud in_place_pointcloud;
+    point_compactor compactor;
+    const auto convert_in_place = [&](){
+        compactor.compact( num_points,
+            [&]( const int32_t i ){ return data[i].z != 0.0f; },
+            [&]( const size_t count ){
+                if( in_place_pointcloud.points_.size() != count ){
+                    in_place_pointcloud.points_.resize( count );
+                    in_place_pointcloud.colors_.resize( count );
+                }
+            },
+            [&]( const int32_t i, const int32_t j ){
+                in_place_pointcloud.points_[j] = Eigen::Vector3d( data[i].x, data[i].y, data[i].z );
+                in_place_pointcloud.colors_[j] = Eigen::Vector3d( data[i].r, data[i].g, data[i].b );
+            } );
+    };
+
+    // Validate (in place result must be valid points of previous result in same order)
+    convert_copy();
+    convert_in_place();
+    size_t j = 0;
+    for( int32_t i = 0; i < num_points; i++ ){
+        if( copy_pointcloud.points_[i].z() == 0.0 ){
+            continue;
+        }
+        if( j >= in_place_pointcloud.points_.size() || copy_pointcloud.points_[i] != in_place_pointcloud.points_[j] || copy_pointcloud.colors_[i] != in_place_pointcloud.colors_[j] ){
+            throw std::runtime_error( "[error] points of in place conversion differ from previous conversion! (" + mode.name + ")" );
+        }
+        j++;
+    }
+    if( j != in_place_pointcloud.points_.size() ){
+        throw std::runtime_error( "[error] number of points of in place conversion is wrong! (" + mode.name + ")" );
+    }
+
+    draw_result result;
+    result.name = mode.name;
+    result.width = width;
+    result.height = height;
+    result.valid_points = j;
+    result.copy_ms = measure( convert_copy );
+    result.copy_allocations = measure_allocations( convert_copy );
+    result.in_place_ms = measure( convert_in_place );
+    result.in_place_allocations = measure_allocations( convert_in_place );
+    return result;
+}
+
+// Run Container Benchmark
+std::vector<container_result> run_container( const depth_mode& mode )
+{
+    const uint32_t width = mode.intrinsic.width;
+    const uint32_t height = mode.intrinsic.height;
+    const int32_t num_points = static_cast<int32_t>( width * height );
+
+    // Frame of Synthetic Colored Points (colors are not normalized)
+    const std::shared_ptr<ob::FrameSet> frameset = create_frameset( width, height );
+    point_cloud_generator generator( mode.intrinsic );
+    std::vector<float> x( num_points ), y( num_points ), z( num_points );
+    generator.generate( frameset->depthFrame(), x.data(), y.data(), z.data() );
+
+    const std::shared_ptr<ob::Frame> frame = ob::FrameHelper::createFrame( OBFrameType::OB_FRAME_POINTS, OBFormat::OB_FORMAT_RGB_POINT, width, height, width * sizeof( OBColorPoint ) );
+    OBColorPoint* data = reinterpret_cast<OBColorPoint*>( frame->data() );
+    for( int32_t i = 0; i < num_points; i++ ){
+        data[i] = { x[i], y[i], z[i], static_cast<float>( i % 256 ), static_cast<float>( ( i / 256 ) % 256 ), 128.0f };
+    }
+
+    // Open3D Point Cloud from Frame (current draw_pointcloud)
+    point_cloud_buffer frame_points;
+    eigen_pointcloud frame_pointcloud;
+    frame_points.assign( frame, OBFormat::OB_FORMAT_RGB_POINT );
+    const size_t valid_points = frame_points.convert_to( frame_pointcloud );
+
+    // SoA from Frame, and Open3D Point Cloud from SoA (lazy conversion)
+    point_cloud_buffer soa_points;
+    eigen_pointcloud soa_pointcloud;
+    soa_points.assign( frame, OBFormat::OB_FORMAT_RGB_POINT );
+    soa_points.x();
+    soa_points.convert_to( soa_pointcloud );
+
+    // Validate
+    if( frame_pointcloud.points_ != soa_pointcloud.points_ || frame_pointcloud.colors_ != soa_pointcloud.colors_ ){
+        throw std::runtime_error( "[error] points converted through SoA differ from points converted from frame!" );
+    }
+    for( int32_t i = 0; i < num_points; i += 997 ){
+        if( soa_points.z()[i] != data[i].z || soa_points.r()[i] != static_cast<uint8_t>( data[i].r ) ){
+            throw std::runtime_error( "[error] points of SoA differ from frame!" );
+        }
+    }
+
+    const size_t open3d_bytes = valid_points * 2 * sizeof( Eigen::Vector3d );
+    std::vector<container_result> results;
+    results.push_back( { "frame_assign", num_points * sizeof( OBColorPoint ), measure( [&](){
+        frame_points.assign( frame, OBFormat::OB_FORMAT_RGB_POINT );
+    } ) } );
+    results.push_back( { "open3d_from_frame", open3d_bytes, measure( [&](){
+        frame_points.assign( frame, OBFormat::OB_FORMAT_RGB_POINT );
+        frame_points.convert_to( frame_pointcloud );
+    } ) } );
+    results.push_back( { "soa_from_frame", soa_points.memory_bytes(), measure( [&](){
+        soa_points.assign( frame, OBFormat::OB_FORMAT_RGB_POINT );
+        soa_points.x();
+    } ) } );
+    results.push_back( { "open3d_from_soa", open3d_bytes, measure( [&](){
+        soa_points.convert_to( soa_pointcloud );
+    } ) } );
+    return results;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results, const std::vector<draw_result>& draw_results, const std::vector<container_result>& container_results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"width\": " << result.width << ", ";
+        stream << "\"height\": " << result.height << ", ";
+        stream << "\"filter_ms\": " << result.filter_ms << ", ";
+        stream << "\"filter_copy_ms\": " << result.filter_copy_ms << ", ";
+        stream << "\"generator_ms\": " << result.generator_ms << ", ";
+        stream << "\"max_error_mm\": " << result.max_error_mm;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ],\n";
+    stream << "  \"draw\": [\n";
+    for( size_t i = 0; i < draw_results.size(); i++ ){
+        const draw_result& result = draw_results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"width\": " << result.width << ", ";
+        stream << "\"height\": " << result.height << ", ";
+        stream << "\"valid_points\": " << result.valid_points << ", ";
+        stream << "\"copy_ms\": " << result.copy_ms << ", ";
+        stream << "\"copy_allocations\": " << result.copy_allocations << ", ";
+        stream << "\"in_place_ms\": " << result.in_place_ms << ", ";
+        stream << "\"in_place_allocations\": " << result.in_place_allocations;
+        stream << " }" << ( i + 1 < draw_results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ],\n";
+    stream << "  \"container\": [\n";
+    for( size_t i = 0; i < container_results.size(); i++ ){
+        const container_result& result = container_results[i];
+        stream << "    { ";
+        stream << "\"name\": \"" << result.name << "\", ";
+        stream << "\"bytes\": " << result.bytes << ", ";
+        stream << "\"ms\": " << result.ms;
+        stream << " }" << ( i + 1 < container_results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        // Depth Modes (typical intrinsics of NFOV/WFOV, binned and unbinned)
+        const std::vector<depth_mode> modes = {
+            { "nfov_binned",   { 252.0f, 252.0f, 160.0f, 144.0f,  320,  288 } },
+            { "nfov_unbinned", { 504.0f, 504.0f, 320.0f, 288.0f,  640,  576 } },
+            { "wfov_binned",   { 252.0f, 252.0f, 256.0f, 256.0f,  512,  512 } },
+            { "wfov_unbinned", { 504.0f, 504.0f, 512.0f, 512.0f, 1024, 1024 } }
+        };
+
+        std::vector<bench_result> results;
+        for( const depth_mode& mode : modes ){
+            results.push_back( run( mode ) );
+            const bench_result& result = results.back();
+            std::cerr << result.name << " : filter " << result.filter_ms << " ms, filter + copy " << result.filter_copy_ms << " ms, generator " << result.generator_ms << " ms (max error " << result.max_error_mm << " mm)" << std::endl;
+            if( result.max_error_mm > 1.0 ){
+                std::cerr << "[warning] points of generator differ from ob::PointCloudFilter! (" << result.name << ")" << std::endl;
+            }
+        }
+
+        std::vector<draw_result> draw_results;
+        for( const depth_mode& mode : modes ){
+            draw_results.push_back( run_draw( mode ) );
+            const draw_result& result = draw_results.back();
+            std::cerr << result.name << " : draw copy " << result.copy_ms << " ms (" << result.copy_allocations << " allocations), in place " << result.in_place_ms << " ms (" << result.in_place_allocations << " allocations), " << result.valid_points << " points" << std::endl;
+        }
+
+        // Container at 1024x1024 (wfov_unbinned)
+        const std::vector<container_result> container_results = run_container( modes.back() );
+        for( const container_result& result : container_results ){
+            std::cerr << "container " << result.name << " : " << result.bytes / ( 1024.0 * 1024.0 ) << " MB, " << result.ms << " ms" << std::endl;
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results, draw_results, container_results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    catch( const ob::Error& error ){
+        std::cerr << "[error] " << error.getMessage() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,521 @@
+#ifndef __CHUNK_FILE__
+#define __CHUNK_FILE__
+
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "depth_codec.h"
+
+/*
+ Chunk File Format (native byte order)
+
+ The file can be mapped into memory and each frame is read in place without SDK.
+ Payloads are aligned to page, and frame header (fixed size) is placed right before payload.
+ Index of frame sets is written at the end when file is closed (it is rebuilt by scanning frame headers if file was not closed).
+ Depth (Y16) can be compressed losslessly with RVL, then data_size of frame header is size of compressed payload.
+
+ +-------------------------------+ 0
+ | file header (64 bytes)        |
+ +-------------------------------+
+ | padding                       |
+ | frame header (64 bytes)       |
+ +-------------------------------+ <- aligned to page
+ | payload                       |
+ +-------------------------------+
+ | ... (frames of frame sets)    |
+ | padding                       |
+ +-------------------------------+ <- index offset (aligned to index entry)
+ | index entry (24 bytes) x N    |
+ +-------------------------------+
+*/
+namespace chunk
+{
+    constexpr char file_magic[8] = { 'O', 'B', 'C', 'H', 'U', 'N', 'K', '\0' };
+    constexpr uint32_t file_version = 1;
+    constexpr uint32_t frame_magic = 0x454d5246; // "FRME"
+
+    // Compression of Payload
+    enum class compression : uint32_t
+    {
+        none = 0,
+        rvl = 1 // lossless depth codec (depth_codec.h)
+    };
+
+    // File Header
+    struct file_header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t alignment;        // alignment of payloads
+        uint64_t index_offset;     // 0 if file was not closed
+        uint64_t frameset_count;
+        uint8_t reserved[32];
+    };
+    static_assert( sizeof( file_header ) == 64, "size of file header must be 64 bytes" );
+
+    // Frame Header
+    struct frame_header
+    {
+        uint32_t magic;
+        uint32_t frame_type;       // OBFrameType
+        uint32_t format;           // OBFormat
+        uint32_t width;
+        uint32_t height;
+        uint32_t compression;      // chunk::compression
+        uint64_t timestamp;        // device timestamp [ms]
+        uint64_t system_timestamp; // [ms]
+        uint64_t data_size;        // bytes of payload
+        uint64_t raw_size;         // bytes of uncompressed data
+        uint32_t frameset_index;
+        uint32_t reserved;
+    };
+    static_assert( sizeof( frame_header ) == 64, "size of frame header must be 64 bytes" );
+
+    // Index Entry of Frame Set
+    struct index_entry
+    {
+        uint64_t timestamp;        // device timestamp of first frame [ms]
+        uint64_t offset;           // offset of first frame header
+        uint32_t frame_count;
+        uint32_t reserved;
+    };
+    static_assert( sizeof( index_entry ) == 24, "size of index entry must be 24 bytes" );
+
+    // Frame (view of mapped file)
+    struct frame
+    {
+        const frame_header* header = nullptr;
+        const uint8_t* data = nullptr;
+    };
+
+    // Align Offset
+    inline uint64_t align( const uint64_t offset, const uint64_t alignment )
+    {
+        return ( offset + alignment - 1 ) & ~( alignment - 1 );
+    }
+}
+
+// Writer of chunk file
+class chunk_writer
+{
+private:
+    std::FILE* file = nullptr;
+    uint64_t offset = 0;
+    uint32_t alignment;
+    chunk::compression depth_compression;
+    std::vector<chunk::index_entry> index;
+    std::vector<uint8_t> padding;
+    std::vector<uint8_t> encoded;
+
+public:
+    // Constructor
+    // alignment must be power of two and not less than frame header (default is page size).
+    explicit chunk_writer( const std::string& file_name, const chunk::compression depth_compression = chunk::compression::none, const uint32_t alignment = 4096 )
+        : alignment( alignment ), depth_compression( depth_compression )
+    {
+        if( alignment < sizeof( chunk::frame_header ) || ( alignment & ( alignment - 1 ) ) != 0 ){
+            throw std::runtime_error( "[error] invalid alignment of chunk file!" );
+        }
+
+        file = std::fopen( file_name.c_str(), "wb" );
+        if( file == nullptr ){
+            throw std::runtime_error( "[error] failed to open chunk file!" );
+        }
+        padding.resize( alignment, 0 );
+
+        // Write File Header (index is written when file is closed)
+        const chunk::file_header header = create_file_header();
+        write_bytes( &header, sizeof( header ) );
+    }
+
+    // Destructor
+    ~chunk_writer()
+    {
+        try{
+            close();
+        }
+        catch( ... ){
+            std::cout << "[warning] failed to close chunk file!" << std::endl;
+        }
+    }
+
+    chunk_writer( const chunk_writer& ) = delete;
+    chunk_writer& operator=( const chunk_writer& ) = delete;
+
+    // Write Frame Set (color, depth and infrared)
+    void write( std::shared_ptr<ob::FrameSet> frameset )
+    {
+        chunk::index_entry entry = {};
+        const uint32_t frameset_index = static_cast<uint32_t>( index.size() );
+        write_frame( frameset->colorFrame(), frameset_index, entry );
+        write_frame( frameset->depthFrame(), frameset_index, entry );
+        write_frame( frameset->irFrame(), frameset_index, entry );
+
+        if( entry.frame_count != 0 ){
+            index.push_back( entry );
+        }
+    }
+
+    // Close
+    // Write index and fill index offset in file header.
+    void close()
+    {
+        if( file == nullptr ){
+            return;
+        }
+
+        // Pad so that index entries are aligned in mapped file
+        const uint64_t index_offset = chunk::align( offset, alignof( chunk::index_entry ) );
+        write_bytes( padding.data(), index_offset - offset );
+
+        chunk::file_header header = create_file_header();
+        header.index_offset = index_offset;
+        header.frameset_count = index.size();
+        write_bytes( index.data(), index.size() * sizeof( chunk::index_entry ) );
+
+        std::fseek( file, 0, SEEK_SET );
+        std::fwrite( &header, sizeof( header ), 1, file );
+        std::fclose( file );
+        file = nullptr;
+    }
+
+    // Number of Frame Sets
+    size_t size() const
+    {
+        return index.size();
+    }
+
+    // Bytes of File
+    uint64_t bytes() const
+    {
+        return offset;
+    }
+
+private:
+    // Write Frame
+    void write_frame( std::shared_ptr<ob::VideoFrame> frame, const uint32_t frameset_index, chunk::index_entry& entry )
+    {
+        if( frame == nullptr ){
+            return;
+        }
+
+        // Pad so that payload starts at aligned offset right after frame header
+        const uint64_t header_offset = chunk::align( offset + sizeof( chunk::frame_header ), alignment ) - sizeof( chunk::frame_header );
+        write_bytes( padding.data(), header_offset - offset );
+
+        // Compress Depth (bands are encoded in parallel)
+        const void* data = frame->data();
+        uint64_t data_size = frame->dataSize();
+        chunk::compression compression = chunk::compression::none;
+        if( depth_compression == chunk::compression::rvl && frame->type() == OBFrameType::OB_FRAME_DEPTH && frame->format() == OBFormat::OB_FORMAT_Y16 ){
+            rvl::encode( cv::Mat( frame->height(), frame->width(), CV_16UC1, frame->data() ), encoded );
+            data = encoded.data();
+            data_size = encoded.size();
+            compression = chunk::compression::rvl;
+        }
+
+        chunk::frame_header header = {};
+        header.magic = chunk::frame_magic;
+        header.frame_type = static_cast<uint32_t>( frame->type() );
+        header.format = static_cast<uint32_t>( frame->format() );
+        header.width = frame->width();
+        header.height = frame->height();
+        header.compression = static_cast<uint32_t>( compression );
+        header.timestamp = frame->timeStamp();
+        header.system_timestamp = frame->systemTimeStamp();
+        header.data_size = data_size;
+        header.raw_size = frame->dataSize();
+        header.frameset_index = frameset_index;
+
+        if( entry.frame_count == 0 ){
+            entry.timestamp = header.timestamp;
+            entry.offset = header_offset;
+        }
+        entry.frame_count++;
+
+        write_bytes( &header, sizeof( header ) );
+        write_bytes( data, data_size );
+    }
+
+    // Write Bytes
+    void write_bytes( const void* data, const uint64_t size )
+    {
+        if( size == 0 ){
+            return;
+        }
+        if( std::fwrite( data, 1, size, file ) != size ){
+            throw std::runtime_error( "[error] failed to write chunk file!" );
+        }
+        offset += size;
+    }
+
+    // Create File Header
+    chunk::file_header create_file_header() const
+    {
+        chunk::file_header header = {};
+        std::memcpy( header.magic, chunk::file_magic, sizeof( header.magic ) );
+        header.version = chunk::file_version;
+        header.alignment = alignment;
+        return header;
+    }
+};
+
+// Reader of chunk file
+// File is mapped into memory, frames are returned as views of mapped memory without copy.
+class chunk_reader
+{
+private:
+    const uint8_t* mapped = nullptr;
+    uint64_t mapped_size = 0;
+    #if defined( _WIN32 )
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping_handle = nullptr;
+    #else
+    int32_t file_descriptor = -1;
+    #endif
+
+    const chunk::file_header* header = nullptr;
+    const chunk::index_entry* index = nullptr;
+    size_t index_count = 0;
+    std::vector<chunk::index_entry> entries; // index copied out of mapped file, or rebuilt
+
+public:
+    // Constructor
+    explicit chunk_reader( const std::string& file_name )
+    {
+        // Map File
+        map( file_name );
+
+        // Check File Header
+        if( mapped_size < sizeof( chunk::file_header ) ){
+            unmap();
+            throw std::runtime_error( "[error] invalid chunk file!" );
+        }
+        header = reinterpret_cast<const chunk::file_header*>( mapped );
+        if( std::memcmp( header->magic, chunk::file_magic, sizeof( header->magic ) ) != 0 || header->version != chunk::file_version ){
+            unmap();
+            throw std::runtime_error( "[error] invalid chunk file!" );
+        }
+        if( header->alignment < sizeof( chunk::frame_header ) || ( header->alignment & ( header->alignment - 1 ) ) != 0 ){
+            unmap();
+            throw std::runtime_error( "[error] invalid alignment of chunk file!" );
+        }
+
+        // Get Index (rebuild from frame headers if file was not closed)
+        // Index is copied instead of read in place, because index of older files is not aligned.
+        // Bounds are checked by subtraction, so broken offset or count can not overflow.
+        if( header->index_offset != 0 && header->index_offset <= mapped_size && header->frameset_count <= ( mapped_size - header->index_offset ) / sizeof( chunk::index_entry ) ){
+            entries.resize( header->frameset_count );
+            std::memcpy( entries.data(), mapped + header->index_offset, entries.size() * sizeof( chunk::index_entry ) );
+            index = entries.data();
+            index_count = entries.size();
+        }
+        else{
+            std::cout << "[warning] index of chunk file was not found, rebuild index from frame headers." << std::endl;
+            rebuild_index();
+        }
+    }
+
+    // Destructor
+    ~chunk_reader()
+    {
+        unmap();
+    }
+
+    chunk_reader( const chunk_reader& ) = delete;
+    chunk_reader& operator=( const chunk_reader& ) = delete;
+
+    // Number of Frame Sets
+    size_t size() const
+    {
+        return index_count;
+    }
+
+    // Timestamp of Frame Set [ms]
+    uint64_t timestamp( const size_t frameset_index ) const
+    {
+        if( frameset_index >= index_count ){
+            throw std::runtime_error( "[error] frame set index is out of range!" );
+        }
+        return index[frameset_index].timestamp;
+    }
+
+    // Read Frame Set by Index (O(1))
+    // frames is reused, and frames refer to mapped memory that is valid while reader is alive.
+    void read( const size_t frameset_index, std::vector<chunk::frame>& frames ) const
+    {
+        if( frameset_index >= index_count ){
+            throw std::runtime_error( "[error] frame set index is out of range!" );
+        }
+
+        frames.clear();
+        const chunk::index_entry& entry = index[frameset_index];
+        uint64_t offset = entry.offset;
+        for( uint32_t i = 0; i < entry.frame_count; i++ ){
+            const chunk::frame frame = read_frame( offset );
+            if( frame.header == nullptr ){
+                throw std::runtime_error( "[error] broken frame in chunk file!" );
+            }
+            frames.push_back( frame );
+
+            // Next frame header is placed right before next aligned payload
+            offset = chunk::align( offset + sizeof( chunk::frame_header ) + frame.header->data_size + sizeof( chunk::frame_header ), header->alignment ) - sizeof( chunk::frame_header );
+        }
+    }
+
+    // Find Frame Set by Timestamp (O(log n))
+    // Return index of first frame set at or after timestamp (size() if not found).
+    size_t find( const uint64_t timestamp ) const
+    {
+        const chunk::index_entry* found = std::lower_bound( index, index + index_count, timestamp, []( const chunk::index_entry& entry, const uint64_t value ){
+            return entry.timestamp < value;
+        } );
+        return static_cast<size_t>( found - index );
+    }
+
+private:
+    // Read Frame at Offset of Frame Header (nullptr if invalid)
+    chunk::frame read_frame( const uint64_t offset ) const
+    {
+        chunk::frame frame;
+        if( offset > mapped_size || sizeof( chunk::frame_header ) > mapped_size - offset ){
+            return frame;
+        }
+
+        const chunk::frame_header* frame_header = reinterpret_cast<const chunk::frame_header*>( mapped + offset );
+        if( frame_header->magic != chunk::frame_magic || frame_header->data_size > mapped_size - offset - sizeof( chunk::frame_header ) ){
+            return frame;
+        }
+
+        frame.header = frame_header;
+        frame.data = mapped + offset + sizeof( chunk::frame_header );
+        return frame;
+    }
+
+    // Rebuild Index by Scanning Frame Headers
+    void rebuild_index()
+    {
+        entries.clear();
+        uint32_t frameset_index = 0;
+        uint64_t offset = chunk::align( sizeof( chunk::file_header ) + sizeof( chunk::frame_header ), header->alignment ) - sizeof( chunk::frame_header );
+        while( true ){
+            const chunk::frame frame = read_frame( offset );
+            if( frame.header == nullptr ){
+                break;
+            }
+
+            if( entries.empty() || frame.header->frameset_index != frameset_index ){
+                chunk::index_entry entry = {};
+                entry.timestamp = frame.header->timestamp;
+                entry.offset = offset;
+                entries.push_back( entry );
+                frameset_index = frame.header->frameset_index;
+            }
+            entries.back().frame_count++;
+
+            offset = chunk::align( offset + sizeof( chunk::frame_header ) + frame.header->data_size + sizeof( chunk::frame_header ), header->alignment ) - sizeof( chunk::frame_header );
+        }
+
+        index = entries.data();
+        index_count = entries.size();
+    }
+
+    // Map File into Memory
+    void map( const std::string& file_name )
+    {
+        #if defined( _WIN32 )
+        file_handle = CreateFileA( file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if( file_handle == INVALID_HANDLE_VALUE ){
+            throw std::runtime_error( "[error] failed to open chunk file!" );
+        }
+
+        LARGE_INTEGER file_size;
+        GetFileSizeEx( file_handle, &file_size );
+        mapped_size = static_cast<uint64_t>( file_size.QuadPart );
+
+        mapping_handle = CreateFileMappingA( file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        if( mapping_handle == nullptr ){
+            unmap();
+            throw std::runtime_error( "[error] failed to map chunk file!" );
+        }
+
+        mapped = reinterpret_cast<const uint8_t*>( MapViewOfFile( mapping_handle, FILE_MAP_READ, 0, 0, 0 ) );
+        if( mapped == nullptr ){
+            unmap();
+            throw std::runtime_error( "[error] failed to map chunk file!" );
+        }
+        #else
+        file_descriptor = open( file_name.c_str(), O_RDONLY );
+        if( file_descriptor == -1 ){
+            throw std::runtime_error( "[error] failed to open chunk file!" );
+        }
+
+        struct stat file_stat;
+        fstat( file_descriptor, &file_stat );
+        mapped_size = static_cast<uint64_t>( file_stat.st_size );
+        if( mapped_size == 0 ){
+            unmap();
+            throw std::runtime_error( "[error] invalid chunk file!" );
+        }
+
+        void* address = mmap( nullptr, mapped_size, PROT_READ, MAP_SHARED, file_descriptor, 0 );
+        if( address == MAP_FAILED ){
+            unmap();
+            throw std::runtime_error( "[error] failed to map chunk file!" );
+        }
+        mapped = reinterpret_cast<const uint8_t*>( address );
+        #endif
+    }
+
+    // Unmap File
+    void unmap()
+    {
+        #if defined( _WIN32 )
+        if( mapped != nullptr ){
+            UnmapViewOfFile( mapped );
+        }
+        if( mapping_handle != nullptr ){
+            CloseHandle( mapping_handle );
+            mapping_handle = nullptr;
+        }
+        if( file_handle != INVALID_HANDLE_VALUE ){
+            CloseHandle( file_handle );
+            file_handle = INVALID_HANDLE_VALUE;
+        }
+        #else
+        if( mapped != nullptr ){
+            munmap( const_cast<uint8_t*>( mapped ), mapped_size );
+        }
+        if( file_descriptor != -1 ){
+            ::close( file_descriptor );
+            file_descriptor = -1;
+        }
+        #endif
+        mapped = nullptr;
+        mapped_size = 0;
+    }
+};
+
+#endif // __CHUNK_FILE__
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <chrono>
+#include <iostream>
 
 // Constructor
 orbbec::orbbec()
@@ -20,8 +21,14 @@ orbbec::~orbbec()
 // Initialize
 void orbbec::initialize()
 {
-    // Initialize Sensor
-    initialize_sensor();
+    if( use_mock ){
+        // Initialize Mock
+        initialize_mock();
+    }
+    else{
+        // Initialize Sensor
+        initialize_sensor();
+    }
 
     // Initialize Recorder
     initialize_recorder();
@@ -75,26 +82,80 @@ inline void orbbec::initialize_sensor()
     // Get Depth Range
     depth_range = get_depth_range( depth_stream_profile );
 
-    // Start Pipeline
-    pipeline->start( config );
+    // Start Frame Source
+    source = std::make_shared<pipeline_source>( pipeline, config );
+    source->start();
+}
+
+// Initialize Mock
+void orbbec::initialize_mock()
+{
+    // Create Mock Source
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_YUYV, 1280, 720 };
+    const mock_source::stream depth_stream = { OBFormat::OB_FORMAT_Y16, 320, 288 };
+    source = std::make_shared<mock_source>( color_stream, depth_stream, mock_source::stream(), mock_fps );
+
+    // Get Depth Range
+    depth_range = get_depth_range( depth_stream.width, depth_stream.height );
+
+    // Start Frame Source
+    source->start();
 }
 
 // Initialize Recorder
 void orbbec::initialize_recorder()
 {
     // Start Record
-    recorder = std::make_shared<ob::Recorder>( pipeline->getDevice() );
-    recorder->start( bag_file.c_str() );
+    if( !use_mock && !bag_file.empty() ){
+        recorder = std::make_shared<ob::Recorder>( pipeline->getDevice() );
+        recorder->start( bag_file.c_str() );
+    }
+
+    // Start Chunk Record
+    if( !chunk_file.empty() ){
+        chunk_recorder = std::make_unique<chunk_writer>( chunk_file, chunk_compression );
+    }
+
+    // Start Writer Thread
+    writer = std::make_unique<record_writer>( [&]( const std::vector<std::shared_ptr<ob::FrameSet>>& batch ){
+        if( write_delay != 0 ){
+            std::this_thread::sleep_for( std::chrono::milliseconds( write_delay ) );
+        }
+
+        for( const std::shared_ptr<ob::FrameSet>& frameset : batch ){
+            if( recorder != nullptr ){
+                recorder->write( frameset );
+            }
+            if( chunk_recorder != nullptr ){
+                chunk_recorder->write( frameset );
+            }
+        }
+    }, writer_capacity, writer_batch_size, writer_policy );
+
+    capture_start = std::chrono::steady_clock::now();
 }
 
 // Finalize
 void orbbec::finalize()
 {
+    // Stop Writer Thread (write remaining frame sets)
+    writer->stop();
+
     // Stop Record
-    recorder->stop();
+    if( recorder != nullptr ){
+        recorder->stop();
+    }
+
+    // Stop Chunk Record (write index)
+    if( chunk_recorder != nullptr ){
+        chunk_recorder->close();
+    }
+
+    // Stop Frame Source
+    source->stop();
 
-    // Stop Pipeline
-    pipeline->stop();
+    // Show Statistics
+    show_statistics();
 }
 
 // Run
@@ -141,7 +202,7 @@ inline void orbbec::update_frame()
 {
     // Get Frame Set
     constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
-    frameset = pipeline->waitForFrames( timeout );
+    frameset = source->wait_for_frames( timeout );
 }
 
 // Update Color
@@ -173,8 +234,9 @@ void orbbec::write_frame()
         return;
     }
 
-    // Write Frame
-    recorder->write( frameset );
+    // Hand Frame Set to Writer Thread
+    captured_frames++;
+    writer->push( frameset );
 }
 
 // Draw
@@ -195,7 +257,7 @@ inline void orbbec::draw_color()
     }
 
     // Get cv::Mat from ob::VideoFrame
-    color = ob::get_mat( color_frame );
+    ob::get_mat( color_frame, color );
 }
 
 // Draw Depth
@@ -206,7 +268,7 @@ inline void orbbec::draw_depth()
     }
 
     // Get cv::Mat from ob::VideoFrame
-    depth = ob::get_mat( depth_frame );
+    ob::get_mat( depth_frame, depth );
 }
 
 // Show
@@ -239,20 +301,26 @@ inline void orbbec::show_depth()
     }
 
     // Scaling Depth
-    const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
-    depth.convertTo( depth, CV_8U, -255.0 / max_range, 255.0 );
+    if( depth_lut.empty() ){
+        const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
+        depth_lut = ob::create_depth_lut( max_range );
+    }
+    ob::visualize_depth( depth, depth_lut, depth_scaled );
 
     // Show Image
     const cv::String window_name = cv::format( "depth (orbbec %d)", device_index );
-    cv::imshow( window_name, depth );
+    cv::imshow( window_name, depth_scaled );
 }
 
 // Get Depth Range
 inline std::tuple<double, double> orbbec::get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile )
 {
-    const uint16_t width = depth_stream_profile->width();
-    const uint16_t height = depth_stream_profile->height();
+    return get_depth_range( depth_stream_profile->width(), depth_stream_profile->height() );
+}
 
+// Get Depth Range
+inline std::tuple<double, double> orbbec::get_depth_range( const uint32_t width, const uint32_t height )
+{
     if( width == 320 && height == 288 ){
         return std::make_tuple( 500.0, 5460.0 );
     }
@@ -268,3 +336,17 @@ inline std::tuple<double, double> orbbec::get_depth_range( std::shared_ptr<ob::V
 
     throw std::runtime_error( "[error] unknown depth format!" );
 }
+
+// Show Statistics
+void orbbec::show_statistics()
+{
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - capture_start ).count();
+    std::cout << "[info] captured " << captured_frames << " frames (" << ( elapsed > 0.0 ? captured_frames / elapsed : 0.0 ) << " fps)" << std::endl;
+    std::cout << "[info] " << writer->to_string() << std::endl;
+    if( writer->num_dropped() > 0 ){
+        std::cout << "[warning] " << writer->num_dropped() << " frame sets were dropped, recording is incomplete!" << std::endl;
+    }
+    if( chunk_recorder != nullptr ){
+        std::cout << "[info] chunk : " << chunk_recorder->size() << " frame sets, " << chunk_recorder->bytes() / ( 1024.0 * 1024.0 ) << " MB" << std::endl;
+    }
+}
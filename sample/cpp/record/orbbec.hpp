@@ -1,9 +1,16 @@
 #ifndef __ORBBEC__
 #define __ORBBEC__
 
+#include <chrono>
+
 #include <libobsensor/ObSensor.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "stats.h"
+#include "frame_source.h"
+#include "record_writer.h"
+#include "chunk_file.h"
+
 class orbbec
 {
 private:
@@ -16,6 +23,11 @@ private:
     std::shared_ptr<ob::Device > device = nullptr;
     std::shared_ptr<ob::Config> config = nullptr;
     std::shared_ptr<ob::FrameSet> frameset = nullptr;
+    std::shared_ptr<frame_source> source = nullptr;
+
+    // Mock
+    bool use_mock = false; // true: synthetic frames without device (frame sets are not written to bag file)
+    uint32_t mock_fps = 30;
 
     // Color
     std::shared_ptr<ob::VideoStreamProfile> color_stream_profile = nullptr;
@@ -26,12 +38,28 @@ private:
     std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile = nullptr;
     std::shared_ptr<ob::DepthFrame> depth_frame = nullptr;
     cv::Mat depth;
+    cv::Mat depth_scaled;
     std::tuple<double, double> depth_range = std::make_tuple<double, double>( 0.0, 0.0 );
+    cv::Mat depth_lut;
 
     // Recorder
     std::string bag_file = "data.bag";
     std::shared_ptr<ob::Recorder> recorder = nullptr;
 
+    // Chunk Recorder
+    std::string chunk_file = ""; // also write memory-mappable chunk file (e.g. "data.chunk") if specified
+    std::unique_ptr<chunk_writer> chunk_recorder = nullptr;
+    chunk::compression chunk_compression = chunk::compression::rvl; // lossless depth compression
+
+    // Writer
+    std::unique_ptr<record_writer> writer = nullptr;
+    record_writer::backpressure writer_policy = record_writer::backpressure::block; // drop_oldest/drop_newest keep capture rate but lose frame sets
+    size_t writer_capacity = 64; // frame sets
+    size_t writer_batch_size = 8; // frame sets
+    uint32_t write_delay = 0; // [ms] simulate slow disk by delaying each batch
+    uint64_t captured_frames = 0;
+    std::chrono::steady_clock::time_point capture_start;
+
 public:
     // Constructor
     orbbec();
@@ -58,6 +86,9 @@ private:
     // Initialize Sensor
     void initialize_sensor();
 
+    // Initialize Mock
+    void initialize_mock();
+
     // Initialize Recorder
     void initialize_recorder();
 
@@ -90,6 +121,10 @@ private:
 
     // Get Depth Range
     std::tuple<double, double> get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile );
+    std::tuple<double, double> get_depth_range( const uint32_t width, const uint32_t height );
+
+    // Show Statistics
+    void show_statistics();
 };
 
 #endif // __ORBBEC__
@@ -0,0 +1,261 @@
+#ifndef __RECORD_WRITER__
+#define __RECORD_WRITER__
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <stdexcept>
+
+#include <libobsensor/ObSensor.hpp>
+
+#include "stats.h"
+
+// Asynchronous writer of frame sets
+// Frame sets are handed to writer thread through bounded queue, so disk stall does not block capture loop.
+class record_writer
+{
+public:
+    // Write Batch of Frame Sets (called on writer thread)
+    using write_function = std::function<void( const std::vector<std::shared_ptr<ob::FrameSet>>& )>;
+
+    // Behavior when queue is full
+    enum class backpressure
+    {
+        block,       // wait until writer catches up (no frame is lost, capture may stall)
+        drop_oldest, // discard oldest queued frame set
+        drop_newest  // discard frame set being pushed
+    };
+
+private:
+    // Queue
+    write_function write;
+    std::deque<std::shared_ptr<ob::FrameSet>> queue;
+    size_t capacity;
+    size_t batch_size;
+    backpressure policy;
+    std::mutex queue_mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+    // Writer
+    std::thread writer_thread;
+    bool is_running = false;
+
+    // Statistics
+    std::atomic<uint64_t> pushed_frames = 0;
+    std::atomic<uint64_t> written_frames = 0;
+    std::atomic<uint64_t> dropped_frames = 0;
+    std::atomic<uint64_t> failed_frames = 0;
+    std::atomic<uint64_t> written_bytes = 0;
+    std::atomic<uint64_t> written_batches = 0;
+    std::atomic<size_t> max_depth = 0;
+    latency_stats write_stats; // per batch
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+    // Constructor
+    // capacity is number of frame sets waiting for write, batch_size is maximum number of frame sets written at once.
+    record_writer( write_function write, const size_t capacity = 64, const size_t batch_size = 8, const backpressure policy = backpressure::block )
+        : write( write ), capacity( capacity ), batch_size( batch_size ), policy( policy )
+    {
+        if( capacity == 0 || batch_size == 0 ){
+            throw std::runtime_error( "[error] capacity and batch size of writer must be greater than zero!" );
+        }
+
+        // Start Writer Thread
+        is_running = true;
+        start_time = std::chrono::steady_clock::now();
+        writer_thread = std::thread( [this](){ run(); } );
+    }
+
+    // Destructor
+    ~record_writer()
+    {
+        stop();
+    }
+
+    record_writer( const record_writer& ) = delete;
+    record_writer& operator=( const record_writer& ) = delete;
+
+    // Push Frame Set (Capture Thread)
+    // Return false if frame set was dropped.
+    bool push( std::shared_ptr<ob::FrameSet> frameset )
+    {
+        std::unique_lock<std::mutex> lock( queue_mutex );
+        pushed_frames++;
+
+        if( queue.size() >= capacity ){
+            switch( policy ){
+                case backpressure::block:
+                    not_full.wait( lock, [this](){ return queue.size() < capacity || !is_running; } );
+                    break;
+                case backpressure::drop_oldest:
+                    queue.pop_front();
+                    drop();
+                    break;
+                case backpressure::drop_newest:
+                    drop();
+                    return false;
+            }
+        }
+
+        if( !is_running ){
+            drop();
+            return false;
+        }
+
+        queue.push_back( frameset );
+        if( queue.size() > max_depth ){
+            max_depth = queue.size();
+        }
+
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Stop
+    // Frame sets remaining in queue are written before writer thread exits.
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock( queue_mutex );
+            if( !is_running ){
+                return;
+            }
+            is_running = false;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+
+        if( writer_thread.joinable() ){
+            writer_thread.join();
+        }
+    }
+
+    // Number of Frame Sets
+    uint64_t num_pushed() const
+    {
+        return pushed_frames.load();
+    }
+
+    uint64_t num_written() const
+    {
+        return written_frames.load();
+    }
+
+    uint64_t num_dropped() const
+    {
+        return dropped_frames.load();
+    }
+
+    uint64_t num_failed() const
+    {
+        return failed_frames.load();
+    }
+
+    // Queue Depth
+    size_t depth()
+    {
+        std::lock_guard<std::mutex> lock( queue_mutex );
+        return queue.size();
+    }
+
+    // To String
+    std::string to_string()
+    {
+        const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+        const double bytes_per_second = elapsed > 0.0 ? written_bytes / elapsed : 0.0;
+
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision( 3 );
+        stream << "pushed " << pushed_frames << " frames, written " << written_frames << " frames in " << written_batches << " batches, ";
+        stream << "dropped " << dropped_frames << " frames, failed " << failed_frames << " frames\n";
+        stream << "queue depth " << depth() << " (max " << max_depth << "), " << bytes_per_second / ( 1024.0 * 1024.0 ) << " MB/s\n";
+        stream << "write : " << write_stats.to_string();
+        return stream.str();
+    }
+
+private:
+    // Count Dropped Frame Set
+    // Dropped frame sets are missing from recording, so warn at first drop and every doubling of count.
+    void drop()
+    {
+        const uint64_t dropped = ++dropped_frames;
+        if( ( dropped & ( dropped - 1 ) ) == 0 ){
+            std::cout << "[warning] writer can not keep up, dropped " << dropped << " frame sets from recording!" << std::endl;
+        }
+    }
+
+    // Writer Loop
+    void run()
+    {
+        std::vector<std::shared_ptr<ob::FrameSet>> batch;
+        batch.reserve( batch_size );
+
+        while( true ){
+            // Pop Batch of Frame Sets
+            {
+                std::unique_lock<std::mutex> lock( queue_mutex );
+                not_empty.wait( lock, [this](){ return !queue.empty() || !is_running; } );
+                if( queue.empty() ){
+                    return; // stopped and drained
+                }
+
+                while( !queue.empty() && batch.size() < batch_size ){
+                    batch.push_back( std::move( queue.front() ) );
+                    queue.pop_front();
+                }
+            }
+            not_full.notify_all();
+
+            // Write Batch
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            try{
+                write( batch );
+            }
+            catch( ... ){
+                std::cout << "[warning] failed to write " << batch.size() << " frame sets!" << std::endl;
+                failed_frames += batch.size();
+                batch.clear();
+                continue;
+            }
+            write_stats.add( std::chrono::steady_clock::now() - start );
+
+            for( const std::shared_ptr<ob::FrameSet>& frameset : batch ){
+                written_bytes += get_data_size( frameset );
+            }
+            written_frames += batch.size();
+            written_batches++;
+            batch.clear();
+        }
+    }
+
+    // Get Data Size of Frame Set
+    static uint64_t get_data_size( std::shared_ptr<ob::FrameSet> frameset )
+    {
+        uint64_t data_size = 0;
+        if( std::shared_ptr<ob::ColorFrame> color_frame = frameset->colorFrame() ){
+            data_size += color_frame->dataSize();
+        }
+        if( std::shared_ptr<ob::DepthFrame> depth_frame = frameset->depthFrame() ){
+            data_size += depth_frame->dataSize();
+        }
+        if( std::shared_ptr<ob::IRFrame> ir_frame = frameset->irFrame() ){
+            data_size += ir_frame->dataSize();
+        }
+        return data_size;
+    }
+};
+
+#endif // __RECORD_WRITER__
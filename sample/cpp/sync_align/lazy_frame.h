@@ -0,0 +1,97 @@
+#ifndef __LAZY_FRAME__
+#define __LAZY_FRAME__
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <cstdint>
+#include <functional>
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+/*
+ Frame handle with conversion memoized per frame
+
+ Raw frame is kept as handle, and converted to cv::Mat the first time a consumer asks for it.
+ Frames that no consumer asks for (e.g. not displayed) are never converted. Buffer of cv::Mat is reused for next frames.
+ get() is thread-safe, so concurrent consumers convert frame once.
+
+ lazy_frame color_view( []( std::shared_ptr<ob::VideoFrame> frame, cv::Mat& mat ){ ob::get_mat( frame, mat ); } );
+ color_view.assign( frameset->colorFrame() ); // no conversion
+ const cv::Mat& color = color_view.get(); // converted on first call for this frame
+*/
+class lazy_frame
+{
+public:
+    using converter = std::function<void( std::shared_ptr<ob::VideoFrame>, cv::Mat& )>;
+
+private:
+    converter convert;
+    std::mutex mutex;
+    std::shared_ptr<ob::VideoFrame> frame = nullptr;
+    cv::Mat mat;
+    bool is_converted = false;
+
+    // Statistics
+    uint64_t assigned_frames = 0;
+    uint64_t converted_frames = 0;
+
+public:
+    // Constructor
+    explicit lazy_frame( converter convert = nullptr )
+        : convert( convert )
+    {
+    }
+
+    // Set Converter
+    void set_converter( converter convert )
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        this->convert = convert;
+    }
+
+    // Assign Frame (not converted until get() is called)
+    // If frame is nullptr, get() keeps returning last converted image.
+    void assign( std::shared_ptr<ob::VideoFrame> frame )
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        this->frame = frame;
+        is_converted = false;
+        if( frame != nullptr ){
+            assigned_frames++;
+        }
+    }
+
+    // Get Frame Handle (e.g. for size without conversion)
+    std::shared_ptr<ob::VideoFrame> get_frame()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        return frame;
+    }
+
+    // Get Converted Image (converted on first call for each frame)
+    // Returned image is valid until next frame is assigned and converted.
+    const cv::Mat& get()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        if( !is_converted && frame != nullptr ){
+            convert( frame, mat );
+            is_converted = true;
+            converted_frames++;
+        }
+        return mat;
+    }
+
+    // To String
+    std::string to_string()
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        std::ostringstream stream;
+        stream << "converted " << converted_frames << " of " << assigned_frames << " frames";
+        return stream.str();
+    }
+};
+
+#endif // __LAZY_FRAME__
@@ -3,6 +3,17 @@
 
 #include <vector>
 #include <chrono>
+#include <iostream>
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
 
 // Constructor
 orbbec::orbbec()
@@ -20,8 +31,29 @@ orbbec::~orbbec()
 // Initialize
 void orbbec::initialize()
 {
-    // Initialize Sensor
-    initialize_sensor();
+    if( use_mock ){
+        // Initialize Mock
+        initialize_mock();
+    }
+    else{
+        // Initialize Sensor
+        initialize_sensor();
+    }
+
+    // Set Converters of Frames (frames are converted on demand)
+    const lazy_frame::converter convert = []( std::shared_ptr<ob::VideoFrame> frame, cv::Mat& mat ){ ob::get_mat( frame, mat ); };
+    color_view.set_converter( convert );
+    depth_view.set_converter( convert );
+    cpu_start = get_cpu_time();
+
+    // Initialize Acquisition
+    initialize_acquisition();
+
+    // Initialize Align
+    initialize_align();
+
+    // Initialize Task Graph
+    initialize_task_graph();
 }
 
 // Initialize Sensor
@@ -66,21 +98,120 @@ inline void orbbec::initialize_sensor()
     config->enableStream( color_stream_profile );
     config->enableStream( depth_stream_profile );
 
-    // Set Align Mode
-    config->setAlignMode( OBAlignMode::ALIGN_D2C_HW_MODE );
+    // Set Align Mode (disabled if depth and color are aligned by software)
+    config->setAlignMode( alignment == align_mode::hardware ? OBAlignMode::ALIGN_D2C_HW_MODE : OBAlignMode::ALIGN_DISABLE );
 
     // Get Depth Range
     depth_range = get_depth_range( depth_stream_profile );
 
-    // Start Pipeline
-    pipeline->start( config );
+    // Create Frame Source
+    source = std::make_shared<pipeline_source>( pipeline, config );
+}
+
+// Initialize Mock
+void orbbec::initialize_mock()
+{
+    // Create Mock Source (depth is aligned to color, or depth of 640x576 mode if aligned by software)
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_BGRA, 1280, 720 };
+    const mock_source::stream depth_stream = ( alignment == align_mode::hardware ) ? mock_source::stream{ OBFormat::OB_FORMAT_Y16, 1280, 720 }
+                                                                                   : mock_source::stream{ OBFormat::OB_FORMAT_Y16, 640, 576 };
+    source = std::make_shared<mock_source>( color_stream, depth_stream, mock_source::stream(), mock_fps );
+
+    // Get Depth Range (320x288 depth mode)
+    depth_range = get_depth_range( 320, 288 );
+}
+
+// Initialize Acquisition
+void orbbec::initialize_acquisition()
+{
+    // Start Frame Source
+    is_acquire = true;
+    if( use_callback ){
+        // Frame sets are pushed to queue directly on source thread without polling
+        source->start( [&]( std::shared_ptr<ob::FrameSet> acquired_frameset ){
+            push_frame( acquired_frameset );
+        } );
+        return;
+    }
+    source->start();
+
+    // Start Acquisition Thread
+    acquisition_thread = std::thread( [&](){
+        // Errors are forwarded to main thread (exception must not escape thread)
+        try{
+            while( is_acquire ){
+                acquire_frame();
+            }
+        }
+        catch( const ob::Error& error ){
+            acquisition_error = std::make_exception_ptr( std::runtime_error( std::string( "[error] " ) + error.getMessage() ) );
+            is_failed.store( true, std::memory_order_release );
+        }
+        catch( ... ){
+            acquisition_error = std::current_exception();
+            is_failed.store( true, std::memory_order_release );
+        }
+    } );
+}
+
+// Initialize Align
+void orbbec::initialize_align()
+{
+    if( alignment == align_mode::hardware ){
+        return;
+    }
+
+    if( pipeline != nullptr ){
+        // Create Aligner from Camera Parameters of Current Stream Profiles (available after pipeline started)
+        aligner = std::make_unique<software_align>( pipeline->getCameraParam() );
+        return;
+    }
+
+    // Create Aligner from Typical Camera Parameters for Mock (640x576 depth, 1280x720 color, 32 mm baseline)
+    const software_align::intrinsic depth_intrinsic = { 504.0f, 504.0f, 320.0f, 288.0f, 640, 576 };
+    const software_align::intrinsic color_intrinsic = { 690.0f, 690.0f, 640.0f, 360.0f, 1280, 720 };
+    constexpr float rotation[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+    constexpr float translation[3] = { -32.0f, 0.0f, 0.0f };
+    aligner = std::make_unique<software_align>( depth_intrinsic, color_intrinsic, rotation, translation );
+}
+
+// Initialize Task Graph
+void orbbec::initialize_task_graph()
+{
+    if( !use_task_graph ){
+        return;
+    }
+
+    // Create Task Graph (calling thread also executes stages)
+    constexpr uint32_t num_workers = 2;
+    graph = std::make_unique<task_graph>( num_workers );
+
+    // Add Draw Stages with Resources that They Read and Write
+    graph->add( "color", {}, { "color" }, [&](){ draw_color(); } );
+    graph->add( "depth", {}, { "depth" }, [&](){ draw_depth(); } );
+    if( alignment == align_mode::software_d2c ){
+        graph->add( "align", { "depth" }, { "aligned" }, [&](){ draw_align(); } ); // size of color is taken from frame
+    }
+    if( alignment == align_mode::software_c2d ){
+        graph->add( "align", { "color", "depth" }, { "aligned" }, [&](){ draw_align(); } );
+    }
+    graph->add( "depth_scaled", { alignment == align_mode::software_d2c ? "aligned" : "depth" }, { "depth_scaled" }, [&](){ draw_depth_scaled(); } );
 }
 
 // Finalize
 void orbbec::finalize()
 {
-    // Stop Pipeline
-    pipeline->stop();
+    // Stop Acquisition Thread
+    is_acquire = false;
+    if( acquisition_thread.joinable() ){
+        acquisition_thread.join();
+    }
+
+    // Stop Frame Source
+    source->stop();
+
+    // Show Statistics
+    show_statistics();
 }
 
 // Run
@@ -91,11 +222,22 @@ void orbbec::run()
         // Update
         update();
 
-        // Draw
-        draw();
-
-        // Show
-        show();
+        // Skip Draw and Show until Show Interval Elapsed (frames in between are never converted)
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if( frameset != nullptr && now - show_time >= show_interval ){
+            show_time = now;
+            shown_frames++;
+
+            // Draw
+            const std::chrono::steady_clock::time_point draw_start = std::chrono::steady_clock::now();
+            draw();
+            draw_stats.add( std::chrono::steady_clock::now() - draw_start );
+
+            // Show
+            const std::chrono::steady_clock::time_point show_start = std::chrono::steady_clock::now();
+            show();
+            show_stats.add( std::chrono::steady_clock::now() - show_start );
+        }
 
         // Wait Key
         constexpr int32_t delay = 10;
@@ -119,12 +261,83 @@ void orbbec::update()
     update_depth();
 }
 
+// Acquire Frame
+inline void orbbec::acquire_frame()
+{
+    // Get Frame Set
+    constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
+    std::shared_ptr<ob::FrameSet> acquired_frameset = source->wait_for_frames( timeout );
+    if( acquired_frameset == nullptr ){
+        return;
+    }
+
+    // Push Frame
+    push_frame( acquired_frameset );
+}
+
+// Push Frame
+inline void orbbec::push_frame( std::shared_ptr<ob::FrameSet> acquired_frameset )
+{
+    acquired_frames++;
+
+    // Stamp Frame Set with Time It was Produced (system timestamp of frame [ms]), so latency includes delivery by SDK
+    std::shared_ptr<ob::Frame> frame = acquired_frameset->depthFrame();
+    if( frame == nullptr ){
+        frame = acquired_frameset->colorFrame();
+    }
+    const std::chrono::system_clock::time_point timestamp = ( frame != nullptr ) ? std::chrono::system_clock::time_point( std::chrono::milliseconds( frame->systemTimeStamp() ) ) : std::chrono::system_clock::now();
+    frame_packet packet = { acquired_frameset, timestamp };
+
+    if( policy == frame_policy::latest ){
+        // Publish Frame Set (replaces frame set that is not taken yet, so newest frame set always survives)
+        latest_frame.write_buffer() = std::move( packet );
+        latest_frame.publish();
+
+        // Release Superseded Frame Set (consumer clears frame set it has taken)
+        frame_packet& superseded = latest_frame.write_buffer();
+        if( superseded.frameset != nullptr ){
+            skipped_frames++;
+        }
+        superseded = frame_packet();
+        return;
+    }
+
+    // Push Frame Set to Queue (wait until queue has space)
+    while( !frame_queue.push( std::move( packet ) ) ){
+        if( !is_acquire ){
+            dropped_frames++;
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
 // Update Frame
 inline void orbbec::update_frame()
 {
+    // Rethrow Error of Acquisition Thread
+    if( is_failed.load( std::memory_order_acquire ) ){
+        std::rethrow_exception( acquisition_error );
+    }
+
     // Get Frame Set
-    constexpr int32_t timeout = std::chrono::milliseconds( 100 ).count();
-    frameset = pipeline->waitForFrames( timeout );
+    frame_packet packet;
+    if( policy == frame_policy::latest ){
+        // Take Latest Frame Set
+        if( latest_frame.update() ){
+            packet = std::move( latest_frame.read_buffer() );
+            latest_frame.read_buffer() = frame_packet();
+        }
+    }
+    else{
+        // Process All Frames in Order
+        frame_queue.pop( packet );
+    }
+    frameset = packet.frameset;
+
+    if( frameset != nullptr ){
+        queue_stats.add( std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::system_clock::now() - packet.timestamp ) );
+    }
 }
 
 // Update Color
@@ -134,8 +347,9 @@ inline void orbbec::update_color()
         return;
     }
 
-    // Get Color Frame
+    // Get Color Frame (not converted until consumer needs it)
     color_frame = frameset->colorFrame();
+    color_view.assign( color_frame );
 }
 
 // Update Depth
@@ -145,40 +359,102 @@ inline void orbbec::update_depth()
         return;
     }
 
-    // Get Depth Frame
+    // Get Depth Frame (not converted until consumer needs it)
     depth_frame = frameset->depthFrame();
+    depth_view.assign( depth_frame );
 }
 
 // Draw
 void orbbec::draw()
 {
+    if( graph != nullptr ){
+        // Draw Stages Concurrently
+        graph->run();
+        critical_path_stats.add( graph->critical_path() );
+        return;
+    }
+
     // Draw Color
     draw_color();
 
     // Draw Depth
     draw_depth();
+
+    // Draw Align
+    draw_align();
+
+    // Draw Depth Scaled
+    draw_depth_scaled();
 }
 
 // Draw Color
 inline void orbbec::draw_color()
 {
-    if( color_frame == nullptr ){
+    // Convert Color Only if Shown (also consumed by color to depth alignment only if shown)
+    if( color_frame == nullptr || !is_show_color ){
         return;
     }
 
-    // Get cv::Mat from ob::VideoFrame
-    color = ob::get_mat( color_frame );
+    // Get cv::Mat from ob::VideoFrame (memoized)
+    color_view.get();
 }
 
 // Draw Depth
 inline void orbbec::draw_depth()
 {
-    if( depth_frame == nullptr ){
+    // Convert Depth Only if Shown or Aligned
+    const bool is_consumed = is_show_depth || ( alignment == align_mode::software_c2d && is_show_color );
+    if( depth_frame == nullptr || !is_consumed ){
+        return;
+    }
+
+    // Get cv::Mat from ob::VideoFrame (memoized)
+    depth_view.get();
+}
+
+// Draw Align
+inline void orbbec::draw_align()
+{
+    if( aligner == nullptr || depth_frame == nullptr || color_frame == nullptr ){
+        return;
+    }
+
+    // Align Only if Aligned Image is Shown
+    const bool is_consumed = ( alignment == align_mode::software_d2c ) ? is_show_depth : is_show_color;
+    if( !is_consumed ){
+        return;
+    }
+
+    // Align by Software
+    const std::chrono::steady_clock::time_point align_start = std::chrono::steady_clock::now();
+    if( alignment == align_mode::software_d2c ){
+        // Color is not converted (only size of color is needed)
+        aligner->align_depth_to_color( depth_view.get(), cv::Size( color_frame->width(), color_frame->height() ), aligned );
+    }
+    else{
+        aligner->align_color_to_depth( depth_view.get(), color_view.get(), aligned );
+    }
+    align_stats.add( std::chrono::steady_clock::now() - align_start );
+}
+
+// Draw Depth Scaled
+inline void orbbec::draw_depth_scaled()
+{
+    if( !is_show_depth ){
+        return;
+    }
+
+    const cv::Mat& depth = get_depth();
+    if( depth.empty() ){
         return;
     }
 
-    // Get cv::Mat from ob::VideoFrame
-    depth = ob::get_mat( depth_frame );
+    // Scaling Depth
+    if( depth_lut.empty() ){
+        const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
+        depth_lut = ob::create_depth_lut( max_range );
+    }
+    ob::visualize_depth( depth, depth_lut, depth_scaled );
 }
 
 // Show
@@ -194,6 +470,12 @@ void orbbec::show()
 // Show Color
 inline void orbbec::show_color()
 {
+    if( !is_show_color ){
+        return;
+    }
+
+    // Get Color (converted here if not converted yet)
+    const cv::Mat& color = get_color();
     if( color.empty() ){
         return;
     }
@@ -206,25 +488,42 @@ inline void orbbec::show_color()
 // Show Depth
 inline void orbbec::show_depth()
 {
-    if( depth.empty() ){
+    if( !is_show_depth || depth_scaled.empty() ){
         return;
     }
 
-    // Scaling Depth
-    const double max_range = std::get<1>( depth_range ) != 0.0 ? std::get<1>( depth_range ) : 5460.0;
-    depth.convertTo( depth, CV_8U, -255.0 / max_range, 255.0 );
-
     // Show Image
     const cv::String window_name = cv::format( "depth (orbbec %d)", device_index );
-    cv::imshow( window_name, depth );
+    cv::imshow( window_name, depth_scaled );
+}
+
+// Get Color
+inline const cv::Mat& orbbec::get_color()
+{
+    if( alignment == align_mode::software_c2d ){
+        return aligned;
+    }
+    return color_view.get();
+}
+
+// Get Depth
+inline const cv::Mat& orbbec::get_depth()
+{
+    if( alignment == align_mode::software_d2c ){
+        return aligned;
+    }
+    return depth_view.get();
 }
 
 // Get Depth Range
 inline std::tuple<double, double> orbbec::get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile )
 {
-    const uint16_t width = depth_stream_profile->width();
-    const uint16_t height = depth_stream_profile->height();
+    return get_depth_range( depth_stream_profile->width(), depth_stream_profile->height() );
+}
 
+// Get Depth Range
+inline std::tuple<double, double> orbbec::get_depth_range( const uint32_t width, const uint32_t height )
+{
     if( width == 320 && height == 288 ){
         return std::make_tuple( 500.0, 5460.0 );
     }
@@ -240,3 +539,55 @@ inline std::tuple<double, double> orbbec::get_depth_range( std::shared_ptr<ob::V
 
     throw std::runtime_error( "[error] unknown depth format!" );
 }
+
+// Show Statistics
+void orbbec::show_statistics()
+{
+    std::cout << "[info] acquired " << acquired_frames << " frames, dropped " << dropped_frames << " frames, skipped " << skipped_frames << " frames" << std::endl;
+    std::cout << "[info] queue : " << queue_stats.to_string() << std::endl;
+    std::cout << "[info] draw  : " << draw_stats.to_string() << std::endl;
+    if( graph != nullptr ){
+        std::cout << "[info] critical path : " << critical_path_stats.to_string() << std::endl;
+        std::cout << "[info] last frame : " << graph->to_string() << std::endl;
+    }
+    if( aligner != nullptr ){
+        std::cout << "[info] align : " << align_stats.to_string() << std::endl;
+    }
+    std::cout << "[info] show  : " << show_stats.to_string() << std::endl;
+
+    // Conversions (frames that are not shown are not converted)
+    std::cout << "[info] shown " << shown_frames << " frames" << std::endl;
+    std::cout << "[info] color : " << color_view.to_string() << std::endl;
+    std::cout << "[info] depth : " << depth_view.to_string() << std::endl;
+
+    // CPU Time of Process (all threads)
+    const double cpu_time = get_cpu_time() - cpu_start;
+    if( acquired_frames != 0 ){
+        std::cout << "[info] cpu   : " << cpu_time / acquired_frames << " ms per acquired frame" << std::endl;
+    }
+}
+
+// Get CPU Time of Process [ms] (all threads)
+// std::clock() is not used, because it returns wall-clock time on MSVC.
+inline double orbbec::get_cpu_time()
+{
+    #if defined( _WIN32 )
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if( GetProcessTimes( GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time ) == 0 ){
+        return 0.0;
+    }
+    const auto to_ms = []( const FILETIME& time ){
+        return ( ( static_cast<uint64_t>( time.dwHighDateTime ) << 32 ) | time.dwLowDateTime ) / 10000.0; // 100 ns
+    };
+    return to_ms( kernel_time ) + to_ms( user_time );
+    #else
+    rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 ){
+        return 0.0;
+    }
+    const auto to_ms = []( const timeval& time ){
+        return time.tv_sec * 1000.0 + time.tv_usec / 1000.0;
+    };
+    return to_ms( usage.ru_utime ) + to_ms( usage.ru_stime );
+    #endif
+}
@@ -1,9 +1,22 @@
 #ifndef __ORBBEC__
 #define __ORBBEC__
 
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
 #include <libobsensor/ObSensor.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "ring_buffer.h"
+#include "triple_buffer.h"
+#include "stats.h"
+#include "frame_source.h"
+#include "align.h"
+#include "task_graph.h"
+#include "lazy_frame.h"
+
 class orbbec
 {
 private:
@@ -16,17 +29,73 @@ private:
     std::shared_ptr<ob::Device > device = nullptr;
     std::shared_ptr<ob::Config> config = nullptr;
     std::shared_ptr<ob::FrameSet> frameset = nullptr;
+    std::shared_ptr<frame_source> source = nullptr;
+
+    // Mock
+    bool use_mock = false; // true: synthetic frames without device
+    uint32_t mock_fps = 30;
+
+    // Frame Queue
+    struct frame_packet
+    {
+        std::shared_ptr<ob::FrameSet> frameset = nullptr;
+        std::chrono::system_clock::time_point timestamp; // produced (system timestamp of frame)
+    };
+    enum class frame_policy { latest, all }; // latest frame wins, drop nothing
+    frame_policy policy = frame_policy::latest;
+    ring_buffer<frame_packet> frame_queue = ring_buffer<frame_packet>( 4 ); // all
+    triple_buffer<frame_packet> latest_frame; // latest (newest frame set replaces one not taken yet)
+
+    // Acquisition
+    bool use_callback = false; // true: frame sets are delivered by SDK callback, false: polling on acquisition thread
+    std::thread acquisition_thread;
+    std::atomic<bool> is_acquire = false;
+    std::atomic<bool> is_failed = false;
+    std::exception_ptr acquisition_error = nullptr; // thrown on acquisition thread, rethrown on main thread
+    std::atomic<uint64_t> acquired_frames = 0;
+    std::atomic<uint64_t> dropped_frames = 0; // queue full
+    std::atomic<uint64_t> skipped_frames = 0; // superseded by newer frame
+    latency_stats queue_stats; // from frame produced to taken by main loop
+    latency_stats draw_stats;
+    latency_stats show_stats;
+
+    // Task Graph
+    bool use_task_graph = true; // true: independent draw stages run concurrently, false: draw stages run sequentially
+    std::unique_ptr<task_graph> graph = nullptr;
+    latency_stats critical_path_stats;
+
+    // Display
+    bool is_show_color = true; // false: color is not converted unless alignment needs it (headless)
+    bool is_show_depth = true; // false: depth is not converted (headless)
+    std::chrono::milliseconds show_interval = std::chrono::milliseconds( 0 ); // minimum interval of draw and show (0: every frame), frames in between are not converted
+    std::chrono::steady_clock::time_point show_time;
+    uint64_t shown_frames = 0;
+    double cpu_start = 0.0; // cpu time of process [ms]
+
+    // Align
+    enum class align_mode
+    {
+        hardware,     // D2C by device (ALIGN_D2C_HW_MODE)
+        software_d2c, // depth is aligned to color on CPU
+        software_c2d  // color is aligned to depth on CPU
+    };
+    align_mode alignment = align_mode::hardware;
+    std::unique_ptr<software_align> aligner = nullptr;
+    cv::Mat aligned;
+    latency_stats align_stats;
 
     // Color
     std::shared_ptr<ob::VideoStreamProfile> color_stream_profile = nullptr;
     std::shared_ptr<ob::ColorFrame> color_frame = nullptr;
-    cv::Mat color;
+    lazy_frame color_view; // converted on demand
 
     // Depth
     std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile = nullptr;
     std::shared_ptr<ob::DepthFrame> depth_frame = nullptr;
-    cv::Mat depth;
+    lazy_frame depth_view; // converted on demand
+    cv::Mat depth_scaled;
     std::tuple<double, double> depth_range = std::make_tuple<double, double>( 0.0, 0.0 );
+    cv::Mat depth_lut;
 
 public:
     // Constructor
@@ -54,9 +123,27 @@ private:
     // Initialize Sensor
     void initialize_sensor();
 
+    // Initialize Mock
+    void initialize_mock();
+
+    // Initialize Acquisition
+    void initialize_acquisition();
+
+    // Initialize Align
+    void initialize_align();
+
+    // Initialize Task Graph
+    void initialize_task_graph();
+
     // Finalize
     void finalize();
 
+    // Acquire Frame
+    void acquire_frame();
+
+    // Push Frame
+    void push_frame( std::shared_ptr<ob::FrameSet> acquired_frameset );
+
     // Update Frame
     void update_frame();
 
@@ -72,14 +159,33 @@ private:
     // Draw Depth
     void draw_depth();
 
+    // Draw Align
+    void draw_align();
+
+    // Draw Depth Scaled
+    void draw_depth_scaled();
+
     // Show Color
     void show_color();
 
     // Show Depth
     void show_depth();
 
+    // Get Color (aligned if color is aligned to depth)
+    const cv::Mat& get_color();
+
+    // Get Depth (aligned if depth is aligned to color)
+    const cv::Mat& get_depth();
+
     // Get Depth Range
     std::tuple<double, double> get_depth_range( std::shared_ptr<ob::VideoStreamProfile> depth_stream_profile );
+    std::tuple<double, double> get_depth_range( const uint32_t width, const uint32_t height );
+
+    // Show Statistics
+    void show_statistics();
+
+    // Get CPU Time of Process [ms] (all threads)
+    double get_cpu_time();
 };
 
 #endif // __ORBBEC__
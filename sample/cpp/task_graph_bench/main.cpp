@@ -0,0 +1,234 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include "util.h"
+#include "frame_source.h"
+#include "align.h"
+#include "task_graph.h"
+
+// Draw Stages of sync_align on Synthetic Frames
+// Stages are same as orbbec::draw() of sync_align (color, depth, align, depth_scaled).
+
+// Align Mode
+enum class align_mode { hardware, software_d2c, software_c2d };
+
+// Benchmark Result
+struct bench_result
+{
+    align_mode alignment;
+    bool use_task_graph;
+    uint32_t workers;
+    uint64_t frames;
+    double ms_per_frame; // wall time of draw
+    double critical_path_ms; // longest chain of dependent stages (same as ms_per_frame if sequential)
+    double stage_total_ms; // sum of time of stages
+};
+
+// Stage
+struct stage
+{
+    std::string name;
+    std::vector<std::string> inputs;
+    std::vector<std::string> outputs;
+    std::function<void()> function;
+};
+
+// To String
+std::string to_string( const align_mode alignment )
+{
+    switch( alignment ){
+        case align_mode::hardware:
+            return "hardware";
+        case align_mode::software_d2c:
+            return "software_d2c";
+        case align_mode::software_c2d:
+            return "software_c2d";
+        default:
+            return "unknown";
+    }
+}
+
+// Create Frame Sets (color 1280x720 BGRA, depth aligned to color or 640x576 if aligned by software)
+std::vector<std::shared_ptr<ob::FrameSet>> create_framesets( const align_mode alignment )
+{
+    const mock_source::stream color_stream = { OBFormat::OB_FORMAT_BGRA, 1280, 720 };
+    const mock_source::stream depth_stream = ( alignment == align_mode::hardware ) ? mock_source::stream{ OBFormat::OB_FORMAT_Y16, 1280, 720 }
+                                                                                   : mock_source::stream{ OBFormat::OB_FORMAT_Y16, 640, 576 };
+    constexpr uint32_t fps = 1000000; // no pacing
+    mock_source source = mock_source( color_stream, depth_stream, mock_source::stream(), fps );
+    source.start();
+
+    std::vector<std::shared_ptr<ob::FrameSet>> framesets;
+    while( framesets.size() < 8 ){
+        constexpr uint32_t timeout = 100;
+        std::shared_ptr<ob::FrameSet> frameset = source.wait_for_frames( timeout );
+        if( frameset != nullptr && frameset->colorFrame() != nullptr && frameset->depthFrame() != nullptr ){
+            framesets.push_back( frameset );
+        }
+    }
+
+    source.stop();
+    return framesets;
+}
+
+// Run Benchmark
+bench_result run( const align_mode alignment, const bool use_task_graph, const uint32_t workers )
+{
+    const std::vector<std::shared_ptr<ob::FrameSet>> framesets = create_framesets( alignment );
+
+    // Aligner from Typical Camera Parameters (same as mock of sync_align)
+    std::unique_ptr<software_align> aligner = nullptr;
+    if( alignment != align_mode::hardware ){
+        const software_align::intrinsic depth_intrinsic = { 504.0f, 504.0f, 320.0f, 288.0f, 640, 576 };
+        const software_align::intrinsic color_intrinsic = { 690.0f, 690.0f, 640.0f, 360.0f, 1280, 720 };
+        constexpr float rotation[9] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+        constexpr float translation[3] = { -32.0f, 0.0f, 0.0f };
+        aligner = std::make_unique<software_align>( depth_intrinsic, color_intrinsic, rotation, translation );
+    }
+
+    // State of Frame
+    std::shared_ptr<ob::ColorFrame> color_frame = nullptr;
+    std::shared_ptr<ob::DepthFrame> depth_frame = nullptr;
+    cv::Mat color, depth, aligned, depth_scaled;
+    const cv::Mat depth_lut = ob::create_depth_lut( 3860.0 );
+
+    // Stages
+    std::vector<stage> stages;
+    stages.push_back( { "color", {}, { "color" }, [&](){ ob::get_mat( color_frame, color ); } } );
+    stages.push_back( { "depth", {}, { "depth" }, [&](){ ob::get_mat( depth_frame, depth ); } } );
+    if( alignment == align_mode::software_d2c ){
+        stages.push_back( { "align", { "color", "depth" }, { "depth" }, [&](){
+            aligner->align_depth_to_color( depth, color.size(), aligned );
+            cv::swap( depth, aligned );
+        } } );
+    }
+    if( alignment == align_mode::software_c2d ){
+        stages.push_back( { "align", { "color", "depth" }, { "color" }, [&](){
+            aligner->align_color_to_depth( depth, color, aligned );
+            cv::swap( color, aligned );
+        } } );
+    }
+    stages.push_back( { "depth_scaled", { "depth" }, { "depth_scaled" }, [&](){ ob::visualize_depth( depth, depth_lut, depth_scaled ); } } );
+
+    std::unique_ptr<task_graph> graph = nullptr;
+    if( use_task_graph ){
+        graph = std::make_unique<task_graph>( workers );
+        for( const stage& added : stages ){
+            graph->add( added.name, added.inputs, added.outputs, added.function );
+        }
+    }
+
+    // Draw Frame
+    std::chrono::steady_clock::duration critical_path = {};
+    std::chrono::steady_clock::duration stage_total = {};
+    const auto draw = [&]( const std::shared_ptr<ob::FrameSet>& frameset ){
+        color_frame = frameset->colorFrame();
+        depth_frame = frameset->depthFrame();
+
+        if( graph != nullptr ){
+            graph->run();
+            critical_path += graph->critical_path();
+            stage_total += graph->total();
+            return;
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( const stage& current : stages ){
+            current.function();
+        }
+        const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+        critical_path += duration;
+        stage_total += duration;
+    };
+
+    // Warm Up
+    for( const std::shared_ptr<ob::FrameSet>& frameset : framesets ){
+        draw( frameset );
+    }
+    critical_path = {};
+    stage_total = {};
+
+    // Measure
+    constexpr std::chrono::milliseconds duration = std::chrono::milliseconds( 1000 );
+    uint64_t frames = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point end = start;
+    while( end - start < duration ){
+        draw( framesets[frames % framesets.size()] );
+        frames++;
+        end = std::chrono::steady_clock::now();
+    }
+
+    bench_result result;
+    result.alignment = alignment;
+    result.use_task_graph = use_task_graph;
+    result.workers = use_task_graph ? workers : 0;
+    result.frames = frames;
+    result.ms_per_frame = std::chrono::duration<double, std::milli>( end - start ).count() / frames;
+    result.critical_path_ms = std::chrono::duration<double, std::milli>( critical_path ).count() / frames;
+    result.stage_total_ms = std::chrono::duration<double, std::milli>( stage_total ).count() / frames;
+    return result;
+}
+
+// To JSON
+std::string to_json( const std::vector<bench_result>& results )
+{
+    std::ostringstream stream;
+    stream << "{\n";
+    stream << "  \"threads\": " << cv::getNumThreads() << ",\n";
+    stream << "  \"results\": [\n";
+    for( size_t i = 0; i < results.size(); i++ ){
+        const bench_result& result = results[i];
+        stream << "    { ";
+        stream << "\"alignment\": \"" << to_string( result.alignment ) << "\", ";
+        stream << "\"mode\": \"" << ( result.use_task_graph ? "task_graph" : "sequential" ) << "\", ";
+        stream << "\"workers\": " << result.workers << ", ";
+        stream << "\"frames\": " << result.frames << ", ";
+        stream << "\"ms_per_frame\": " << result.ms_per_frame << ", ";
+        stream << "\"critical_path_ms\": " << result.critical_path_ms << ", ";
+        stream << "\"stage_total_ms\": " << result.stage_total_ms;
+        stream << " }" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+    return stream.str();
+}
+
+int main( int argc, char* argv[] )
+{
+    try{
+        // Run Benchmark (sequential, and task graph with 1 and 2 workers in addition to calling thread)
+        std::vector<bench_result> results;
+        for( const align_mode alignment : { align_mode::hardware, align_mode::software_d2c, align_mode::software_c2d } ){
+            results.push_back( run( alignment, false, 0 ) );
+            results.push_back( run( alignment, true, 1 ) );
+            results.push_back( run( alignment, true, 2 ) );
+        }
+
+        for( const bench_result& result : results ){
+            std::cerr << to_string( result.alignment ) << " " << ( result.use_task_graph ? "task_graph (" + std::to_string( result.workers ) + " workers)" : "sequential" )
+                      << " : " << result.ms_per_frame << " ms/frame, critical path " << result.critical_path_ms << " ms, stages " << result.stage_total_ms << " ms" << std::endl;
+        }
+
+        // Output JSON (stdout, or file if specified)
+        const std::string json = to_json( results );
+        if( argc > 1 ){
+            std::ofstream file( argv[1] );
+            file << json;
+        }
+        else{
+            std::cout << json;
+        }
+    }
+    catch( const std::runtime_error& error ){
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
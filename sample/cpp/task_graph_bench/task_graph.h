@@ -0,0 +1,247 @@
+#ifndef __TASK_GRAPH__
+#define __TASK_GRAPH__
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+
+/*
+ Per-frame task graph executed on persistent worker pool
+
+ Stages declare resources that they read (inputs) and write (outputs).
+ Stage depends on every earlier stage that writes its inputs or reads/writes its outputs,
+ so independent stages (e.g. color conversion and depth visualization) run concurrently while order of conflicting stages is kept.
+ Calling thread of run() also executes stages while it waits.
+
+ task_graph graph( 2 ); // 2 workers
+ graph.add( "color", {}, { "color" }, [&](){ ob::get_mat( color_frame, color ); } );
+ graph.add( "depth", {}, { "depth" }, [&](){ ob::get_mat( depth_frame, depth ); } );
+ graph.add( "depth_scaled", { "depth" }, { "depth_scaled" }, [&](){ ob::visualize_depth( depth, lut, depth_scaled ); } );
+ graph.run(); // every frame
+ std::cout << graph.to_string() << std::endl; // critical path and time of stages of last run
+*/
+class task_graph
+{
+private:
+    // Stage
+    struct stage
+    {
+        std::string name;
+        std::vector<std::string> inputs;
+        std::vector<std::string> outputs;
+        std::function<void()> function;
+        std::vector<size_t> dependents;
+        size_t dependencies = 0;
+
+        // State of Run
+        size_t remaining = 0;
+        bool failed = false; // stage threw, or stage that it depends on failed
+        std::chrono::steady_clock::duration duration = {};
+        std::chrono::steady_clock::duration path = {}; // longest path of stages that ends with this stage
+    };
+    std::vector<stage> stages;
+
+    // Workers
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable condition; // stage became ready, run finished, or stop
+    std::deque<size_t> ready;
+    size_t completed = 0;
+    bool is_stop = false;
+    std::exception_ptr exception = nullptr;
+
+    // Result of Last Run
+    std::chrono::steady_clock::duration critical = {};
+
+public:
+    // Constructor
+    explicit task_graph( const uint32_t num_workers )
+    {
+        for( uint32_t i = 0; i < num_workers; i++ ){
+            workers.emplace_back( [&](){ work(); } );
+        }
+    }
+
+    // Destructor
+    ~task_graph()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            is_stop = true;
+        }
+        condition.notify_all();
+        for( std::thread& worker : workers ){
+            worker.join();
+        }
+    }
+
+    task_graph( const task_graph& ) = delete;
+    task_graph& operator=( const task_graph& ) = delete;
+
+    // Add Stage
+    // Stages must be added before first run in order of sequential execution.
+    void add( const std::string& name, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, std::function<void()> function )
+    {
+        const auto intersects = []( const std::vector<std::string>& a, const std::vector<std::string>& b ){
+            return std::any_of( a.begin(), a.end(), [&]( const std::string& resource ){
+                return std::find( b.begin(), b.end(), resource ) != b.end();
+            } );
+        };
+
+        stage added;
+        added.name = name;
+        added.inputs = inputs;
+        added.outputs = outputs;
+        added.function = function;
+
+        // Depend on Earlier Stages (read after write, write after read, write after write)
+        const size_t index = stages.size();
+        for( stage& earlier : stages ){
+            if( intersects( earlier.outputs, inputs ) || intersects( earlier.outputs, outputs ) || intersects( earlier.inputs, outputs ) ){
+                earlier.dependents.push_back( index );
+                added.dependencies++;
+            }
+        }
+
+        stages.push_back( added );
+    }
+
+    // Run All Stages (blocks until all stages are completed)
+    // If stage throws, stages that depend on it (directly or indirectly) are skipped, other stages still run, and first exception is rethrown.
+    void run()
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        for( size_t i = 0; i < stages.size(); i++ ){
+            stages[i].remaining = stages[i].dependencies;
+            stages[i].failed = false;
+            stages[i].duration = {};
+            stages[i].path = {};
+            if( stages[i].remaining == 0 ){
+                ready.push_back( i );
+            }
+        }
+        completed = 0;
+        exception = nullptr;
+        condition.notify_all();
+
+        // Execute Stages on Calling Thread while Waiting
+        while( completed < stages.size() ){
+            if( !execute( lock ) ){
+                condition.wait( lock, [&](){ return completed == stages.size() || !ready.empty(); } );
+            }
+        }
+
+        critical = {};
+        for( const stage& completed_stage : stages ){
+            critical = std::max( critical, completed_stage.path );
+        }
+
+        if( exception != nullptr ){
+            std::rethrow_exception( exception );
+        }
+    }
+
+    // Critical Path of Last Run (longest chain of dependent stages, lower bound of time of run)
+    std::chrono::steady_clock::duration critical_path() const
+    {
+        return critical;
+    }
+
+    // Total Time of Stages of Last Run (time of sequential execution)
+    std::chrono::steady_clock::duration total() const
+    {
+        std::chrono::steady_clock::duration sum = {};
+        for( const stage& completed_stage : stages ){
+            sum += completed_stage.duration;
+        }
+        return sum;
+    }
+
+    // To String
+    std::string to_string() const
+    {
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision( 3 );
+        stream << "critical path " << std::chrono::duration<double, std::milli>( critical ).count() << " ms (";
+        for( size_t i = 0; i < stages.size(); i++ ){
+            stream << ( i != 0 ? ", " : "" ) << stages[i].name << " " << std::chrono::duration<double, std::milli>( stages[i].duration ).count() << " ms";
+        }
+        stream << ")";
+        return stream.str();
+    }
+
+private:
+    // Work (worker thread)
+    void work()
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        while( true ){
+            condition.wait( lock, [&](){ return is_stop || !ready.empty(); } );
+            if( is_stop ){
+                return;
+            }
+            execute( lock );
+        }
+    }
+
+    // Execute Ready Stage (false if no stage is ready)
+    bool execute( std::unique_lock<std::mutex>& lock )
+    {
+        if( ready.empty() ){
+            return false;
+        }
+
+        const size_t index = ready.front();
+        ready.pop_front();
+        stage& current = stages[index];
+        const bool is_skip = current.failed;
+
+        // Run Stage without Lock
+        lock.unlock();
+        std::exception_ptr error = nullptr;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if( !is_skip ){
+            try{
+                current.function();
+            }
+            catch( ... ){
+                error = std::current_exception();
+            }
+        }
+        const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+        lock.lock();
+
+        if( error != nullptr ){
+            current.failed = true;
+            if( exception == nullptr ){
+                exception = error;
+            }
+        }
+
+        // Release Dependents (failure is propagated to dependents)
+        current.duration = duration;
+        current.path += duration;
+        for( const size_t dependent : current.dependents ){
+            stages[dependent].failed = stages[dependent].failed || current.failed;
+            stages[dependent].path = std::max( stages[dependent].path, current.path );
+            if( --stages[dependent].remaining == 0 ){
+                ready.push_back( dependent );
+            }
+        }
+        completed++;
+        condition.notify_all();
+        return true;
+    }
+};
+
+#endif // __TASK_GRAPH__
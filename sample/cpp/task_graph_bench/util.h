@@ -0,0 +1,874 @@
+/*
+ This is utility to that provides converter to convert ob::VideoFrame to cv::Mat.
+
+ cv::Mat mat = ob::get_mat( video_frame );
+ cv::Mat view = ob::get_mat( video_frame, false ); // no copy (view keeps frame alive)
+ ob::get_mat( video_frame, mat ); // reuse mat
+ std::unique_ptr<ob::frame_converter> converter = ob::create_converter( video_stream_profile ); // resolve format once per stream
+ converter->convert( video_frame, mat );
+ ob::decode_mjpg( mjpg_frame, mat, 4 ); // 1/4 resolution
+ std::unique_ptr<ob::frame_converter> preview = ob::create_preview_converter( OBFormat::OB_FORMAT_YUYV, 1280, 720, 4 ); // 320x180 BGR in one pass
+ preview->convert( video_frame, mat );
+ ob::visualize_depth( depth, ob::create_depth_lut( max_range ), visualize );
+
+ Copyright (c) 2023 Tsukasa Sugiura <t.sugiura0204@gmail.com>
+ Licensed under the MIT license.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+*/
+
+#ifndef __UTIL__
+#define __UTIL__
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "color_kernel.h"
+
+namespace ob
+{
+    // Get cv::Mat type of the format that can be wrapped without conversion (-1 if conversion is required)
+    int32_t get_mat_type( const OBFrameType frame_type, const OBFormat format )
+    {
+        switch( frame_type )
+        {
+            case OBFrameType::OB_FRAME_COLOR:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_GRAY:
+                        return CV_8UC1;
+                    case OBFormat::OB_FORMAT_BGR:
+                        return CV_8UC3;
+                    default:
+                        return -1;
+                }
+            }
+            case OBFrameType::OB_FRAME_DEPTH:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_Y16:
+                    case OBFormat::OB_FORMAT_Y10:
+                    case OBFormat::OB_FORMAT_Y11:
+                    case OBFormat::OB_FORMAT_Y12:
+                    case OBFormat::OB_FORMAT_Y14:
+                        return CV_16UC1;
+                    case OBFormat::OB_FORMAT_Y8:
+                        return CV_8UC1;
+                    default:
+                        return -1;
+                }
+            }
+            case OBFrameType::OB_FRAME_IR:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_Y16:
+                        return CV_16UC1;
+                    case OBFormat::OB_FORMAT_Y8:
+                        return CV_8UC1;
+                    default:
+                        return -1;
+                }
+            }
+            default:
+            {
+                return -1;
+            }
+        }
+    }
+
+    // Allocator of cv::Mat that wraps frame memory without copy
+    // cv::Mat holds reference of frame, so frame memory stays valid for as long as cv::Mat (or its copies) lives.
+    class frame_allocator : public cv::MatAllocator
+    {
+    private:
+        // Data of cv::Mat that holds frame
+        struct frame_data : public cv::UMatData
+        {
+            std::shared_ptr<ob::Frame> frame;
+
+            frame_data( const cv::MatAllocator* allocator, std::shared_ptr<ob::Frame> frame )
+                : cv::UMatData( allocator ), frame( frame )
+            {
+            }
+        };
+
+    public:
+        // Get Instance
+        static const frame_allocator* instance()
+        {
+            static const frame_allocator allocator;
+            return &allocator;
+        }
+
+        // Wrap Frame Memory into cv::Mat
+        cv::Mat wrap( std::shared_ptr<ob::VideoFrame> frame, const int32_t type ) const
+        {
+            cv::Mat mat = cv::Mat( frame->height(), frame->width(), type, frame->data() );
+
+            frame_data* data = new frame_data( this, frame );
+            data->data = data->origdata = mat.data;
+            data->size = mat.total() * mat.elemSize();
+            data->flags = cv::UMatData::USER_ALLOCATED;
+            data->refcount = 1;
+
+            mat.u = data;
+            mat.allocator = this;
+            return mat;
+        }
+
+        // Is cv::Mat Wrapping Frame Memory
+        bool is_wrapped( const cv::Mat& mat ) const
+        {
+            return mat.u != nullptr && mat.u->currAllocator == this;
+        }
+
+        // Allocate (new buffers, e.g. cv::Mat::create() on wrapped cv::Mat, are allocated by default allocator)
+        cv::UMatData* allocate( int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usage ) const override
+        {
+            return cv::Mat::getDefaultAllocator()->allocate( dims, sizes, type, data, step, flags, usage );
+        }
+
+        bool allocate( cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usage ) const override
+        {
+            return data != nullptr;
+        }
+
+        // Deallocate (release reference of frame)
+        void deallocate( cv::UMatData* data ) const override
+        {
+            delete static_cast<frame_data*>( data );
+        }
+    };
+
+    // Decode MJPG data into caller-owned cv::Mat
+    // scale (1, 2, 4 or 8) decodes at reduced resolution using DCT scaling of JPEG decoder (e.g. for preview).
+    void decode_mjpg( const void* src, const uint32_t src_size, const bool is_color, cv::Mat& dst, const int32_t scale = 1 )
+    {
+        int32_t flags = cv::IMREAD_ANYCOLOR;
+        switch( scale )
+        {
+            case 1:
+                break;
+            case 2:
+                flags = is_color ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2;
+                break;
+            case 4:
+                flags = is_color ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4;
+                break;
+            case 8:
+                flags = is_color ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8;
+                break;
+            default:
+                throw std::runtime_error( "[error] failed to decode mjpg with this scale!" );
+        }
+
+        // Decode directly from frame memory through non-owning header (dst is reused while size and type match)
+        const cv::Mat buffer = cv::Mat( 1, static_cast<int32_t>( src_size ), CV_8UC1, const_cast<void*>( src ) );
+        cv::imdecode( buffer, flags, &dst );
+    }
+
+    // Decode MJPG frame into caller-owned cv::Mat
+    void decode_mjpg( std::shared_ptr<ob::VideoFrame> src, cv::Mat& dst, const int32_t scale = 1 )
+    {
+        assert( src->format() == OBFormat::OB_FORMAT_MJPG );
+        decode_mjpg( src->data(), src->dataSize(), src->type() == OBFrameType::OB_FRAME_COLOR, dst, scale );
+    }
+
+    // Convert frame data to caller-owned cv::Mat (e.g. frame read from file without SDK)
+    // dst is reused while its size and type match, so streaming does not allocate after the first frame.
+    // YUYV, UYVY, NV12, NV21, RGB and BGRA are converted by SIMD kernels of color_kernel.h (bit-exact with cv::cvtColor).
+    void get_mat( const OBFrameType frame_type, const OBFormat format, const int32_t width, const int32_t height, const void* src, const uint32_t src_size, cv::Mat& dst )
+    {
+        assert( src_size != 0 );
+
+        // Do not write into frame memory wrapped by previous frame
+        if( frame_allocator::instance()->is_wrapped( dst ) ){
+            dst.release();
+        }
+
+        void* data = const_cast<void*>( src );
+
+        switch( frame_type )
+        {
+            case OBFrameType::OB_FRAME_COLOR:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_YUYV:
+                    {
+                        color_kernel::convert( color_kernel::format::yuyv, data, width, height, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_YUY2: // not supported by femto mega
+                    {
+                        color_kernel::convert( color_kernel::format::yuyv, data, width, height, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_UYVY: // not supported by femto mega
+                    {
+                        color_kernel::convert( color_kernel::format::uyvy, data, width, height, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_NV12:
+                    {
+                        color_kernel::convert( color_kernel::format::nv12, data, width, height, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_NV21: // not supported by femto mega
+                    {
+                        color_kernel::convert( color_kernel::format::nv21, data, width, height, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_MJPG:
+                    {
+                        decode_mjpg( data, src_size, true, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_H264:
+                    case OBFormat::OB_FORMAT_H265:
+                    {
+                        throw std::runtime_error( "[error] not implemented this format!" );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_GRAY: // not supported by femto mega
+                    {
+                        cv::Mat( height, width, CV_8UC1, data ).copyTo( dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_HEVC:
+                    {
+                        throw std::runtime_error( "[error] not implemented this format!" );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_I420: // not supported by femto mega
+                    {
+                        cv::cvtColor( cv::Mat( height + height / 2, width, CV_8UC1, data ), dst, cv::COLOR_YUV2BGR_I420 );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_RGB:
+                    {
+                        color_kernel::convert( color_kernel::format::rgb, data, width, height, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_BGR: // not supported by femto mega
+                    {
+                        cv::Mat( height, width, CV_8UC3, data ).copyTo( dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_BGRA:
+                    {
+                        color_kernel::convert( color_kernel::format::bgra, data, width, height, dst );
+                        break;
+                    }
+                    default:
+                    {
+                        throw std::runtime_error( "[error] failed to convert this format!" );
+                        break;
+                    }
+                }
+                break;
+            }
+            case OBFrameType::OB_FRAME_DEPTH:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_Y16:
+                    case OBFormat::OB_FORMAT_Y10:
+                    case OBFormat::OB_FORMAT_Y11:
+                    case OBFormat::OB_FORMAT_Y12:
+                    case OBFormat::OB_FORMAT_Y14:
+                    {
+                        cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) ).copyTo( dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_Y8:
+                    {
+                        cv::Mat( height, width, CV_8UC1, data ).copyTo( dst );
+                        break;
+                    }
+                    default:
+                    {
+                        throw std::runtime_error( "[error] failed to convert this format!" );
+                        break;
+                    }
+                }
+                break;
+            }
+            case OBFrameType::OB_FRAME_IR:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_MJPG:
+                    {
+                        // NOTE: this is slower than other formats.
+                        decode_mjpg( data, src_size, false, dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_Y16:
+                    {
+                        cv::Mat( height, width, CV_16UC1, reinterpret_cast<uint16_t*>( data ) ).copyTo( dst );
+                        break;
+                    }
+                    case OBFormat::OB_FORMAT_Y8:
+                    {
+                        cv::Mat( height, width, CV_8UC1, data ).copyTo( dst );
+                        break;
+                    }
+                    default:
+                    {
+                        throw std::runtime_error( "[error] failed to convert this format!" );
+                        break;
+                    }
+                }
+                break;
+            }
+            default:
+            {
+                throw std::runtime_error( "[error] failed to convert this camera type!" );
+                break;
+            }
+        }
+    }
+
+    // Convert ob::VideoFrame to caller-owned cv::Mat
+    void get_mat( std::shared_ptr<ob::VideoFrame> src, cv::Mat& dst )
+    {
+        get_mat( src->type(), src->format(), src->width(), src->height(), src->data(), src->dataSize(), dst );
+    }
+
+    // Convert ob::VideoFrame to cv::Mat
+    // If deep_copy is false, formats that need no conversion (e.g. Y16, Y8, BGR) are returned as a view of the frame memory.
+    // The view keeps frame alive until it is released. Writing into the view modifies the frame.
+    cv::Mat get_mat( std::shared_ptr<ob::VideoFrame> src, bool deep_copy = true )
+    {
+        const int32_t type = get_mat_type( src->type(), src->format() );
+        if( !deep_copy && type != -1 ){
+            return frame_allocator::instance()->wrap( src, type );
+        }
+
+        cv::Mat mat;
+        get_mat( src, mat );
+        return mat;
+    }
+
+    // Converter of frame to cv::Mat for fixed stream (frame type, format and resolution)
+    // Format is dispatched once by create_converter(), so converting each frame is one virtual call without branching on format.
+    class frame_converter
+    {
+    public:
+        // Destructor
+        virtual ~frame_converter() = default;
+
+        // Convert frame data to caller-owned cv::Mat (dst is reused while its size and type match)
+        void convert( const void* src, const uint32_t src_size, cv::Mat& dst ) const
+        {
+            // Do not write into frame memory wrapped by previous frame
+            if( frame_allocator::instance()->is_wrapped( dst ) ){
+                dst.release();
+            }
+
+            convert_data( const_cast<void*>( src ), src_size, dst );
+        }
+
+        // Convert ob::VideoFrame to caller-owned cv::Mat
+        void convert( std::shared_ptr<ob::VideoFrame> src, cv::Mat& dst ) const
+        {
+            convert( src->data(), src->dataSize(), dst );
+        }
+
+    protected:
+        // Convert Data
+        virtual void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const = 0;
+    };
+
+    // Converter of formats that need no conversion (copy)
+    template<int32_t type>
+    class copy_converter : public frame_converter
+    {
+    private:
+        const cv::Size size;
+
+    public:
+        copy_converter( const int32_t width, const int32_t height )
+            : size( width, height )
+        {
+        }
+
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            cv::Mat( size, type, src ).copyTo( dst );
+        }
+    };
+
+    // Converter of formats converted by cv::cvtColor
+    // rows is number of rows of source (e.g. height * 3 / 2 for NV12 and I420).
+    template<int32_t src_type, int32_t code>
+    class color_converter : public frame_converter
+    {
+    private:
+        const cv::Size size;
+
+    public:
+        color_converter( const int32_t width, const int32_t rows )
+            : size( width, rows )
+        {
+        }
+
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            cv::cvtColor( cv::Mat( size, src_type, src ), dst, code );
+        }
+    };
+
+    // Converter of formats converted by color kernels (color_kernel.h)
+    template<color_kernel::format source>
+    class kernel_converter : public frame_converter
+    {
+    private:
+        const cv::Size size;
+
+    public:
+        kernel_converter( const int32_t width, const int32_t height )
+            : size( width, height )
+        {
+        }
+
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            color_kernel::convert( source, src, size.width, size.height, dst );
+        }
+    };
+
+    // Converter of MJPG
+    template<bool is_color>
+    class mjpg_converter : public frame_converter
+    {
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            decode_mjpg( src, src_size, is_color, dst );
+        }
+    };
+
+    // Create converter of frame type, format and resolution
+    std::unique_ptr<frame_converter> create_converter( const OBFrameType frame_type, const OBFormat format, const int32_t width, const int32_t height )
+    {
+        switch( frame_type )
+        {
+            case OBFrameType::OB_FRAME_COLOR:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_YUYV:
+                        return std::make_unique<kernel_converter<color_kernel::format::yuyv>>( width, height );
+                    case OBFormat::OB_FORMAT_YUY2: // not supported by femto mega
+                        return std::make_unique<kernel_converter<color_kernel::format::yuyv>>( width, height );
+                    case OBFormat::OB_FORMAT_UYVY: // not supported by femto mega
+                        return std::make_unique<kernel_converter<color_kernel::format::uyvy>>( width, height );
+                    case OBFormat::OB_FORMAT_NV12:
+                        return std::make_unique<kernel_converter<color_kernel::format::nv12>>( width, height );
+                    case OBFormat::OB_FORMAT_NV21: // not supported by femto mega
+                        return std::make_unique<kernel_converter<color_kernel::format::nv21>>( width, height );
+                    case OBFormat::OB_FORMAT_I420: // not supported by femto mega
+                        return std::make_unique<color_converter<CV_8UC1, cv::COLOR_YUV2BGR_I420>>( width, height + height / 2 );
+                    case OBFormat::OB_FORMAT_MJPG:
+                        return std::make_unique<mjpg_converter<true>>();
+                    case OBFormat::OB_FORMAT_GRAY: // not supported by femto mega
+                        return std::make_unique<copy_converter<CV_8UC1>>( width, height );
+                    case OBFormat::OB_FORMAT_RGB:
+                        return std::make_unique<kernel_converter<color_kernel::format::rgb>>( width, height );
+                    case OBFormat::OB_FORMAT_BGR: // not supported by femto mega
+                        return std::make_unique<copy_converter<CV_8UC3>>( width, height );
+                    case OBFormat::OB_FORMAT_BGRA:
+                        return std::make_unique<kernel_converter<color_kernel::format::bgra>>( width, height );
+                    case OBFormat::OB_FORMAT_H264:
+                    case OBFormat::OB_FORMAT_H265:
+                    case OBFormat::OB_FORMAT_HEVC:
+                        throw std::runtime_error( "[error] not implemented this format!" );
+                    default:
+                        throw std::runtime_error( "[error] failed to convert this format!" );
+                }
+            }
+            case OBFrameType::OB_FRAME_DEPTH:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_Y16:
+                    case OBFormat::OB_FORMAT_Y10:
+                    case OBFormat::OB_FORMAT_Y11:
+                    case OBFormat::OB_FORMAT_Y12:
+                    case OBFormat::OB_FORMAT_Y14:
+                        return std::make_unique<copy_converter<CV_16UC1>>( width, height );
+                    case OBFormat::OB_FORMAT_Y8:
+                        return std::make_unique<copy_converter<CV_8UC1>>( width, height );
+                    default:
+                        throw std::runtime_error( "[error] failed to convert this format!" );
+                }
+            }
+            case OBFrameType::OB_FRAME_IR:
+            {
+                switch( format )
+                {
+                    case OBFormat::OB_FORMAT_MJPG:
+                        return std::make_unique<mjpg_converter<false>>();
+                    case OBFormat::OB_FORMAT_Y16:
+                        return std::make_unique<copy_converter<CV_16UC1>>( width, height );
+                    case OBFormat::OB_FORMAT_Y8:
+                        return std::make_unique<copy_converter<CV_8UC1>>( width, height );
+                    default:
+                        throw std::runtime_error( "[error] failed to convert this format!" );
+                }
+            }
+            default:
+            {
+                throw std::runtime_error( "[error] failed to convert this camera type!" );
+            }
+        }
+    }
+
+    // Create converter of stream profile
+    std::unique_ptr<frame_converter> create_converter( std::shared_ptr<ob::VideoStreamProfile> profile )
+    {
+        switch( profile->type() )
+        {
+            case OBStreamType::OB_STREAM_COLOR:
+                return create_converter( OBFrameType::OB_FRAME_COLOR, profile->format(), profile->width(), profile->height() );
+            case OBStreamType::OB_STREAM_DEPTH:
+                return create_converter( OBFrameType::OB_FRAME_DEPTH, profile->format(), profile->width(), profile->height() );
+            case OBStreamType::OB_STREAM_IR:
+                return create_converter( OBFrameType::OB_FRAME_IR, profile->format(), profile->width(), profile->height() );
+            default:
+                throw std::runtime_error( "[error] failed to convert this stream type!" );
+        }
+    }
+
+    // Converter of color frame to BGR of reduced size in one pass (e.g. preview in small window)
+    // Each target pixel is converted from nearest source pixel (same sampling as cv::resize with cv::INTER_NEAREST),
+    // so BGR of full resolution is never produced. dst is reused while its size matches.
+    class preview_converter : public frame_converter
+    {
+    protected:
+        const cv::Size size;
+        const cv::Size target;
+        std::vector<int32_t> xs; // source column of each target column
+        std::vector<int32_t> ys; // source row of each target row
+
+    public:
+        preview_converter( const int32_t width, const int32_t height, const cv::Size& target )
+            : size( width, height ), target( target )
+        {
+            if( target.width <= 0 || target.height <= 0 || width < target.width || height < target.height ){
+                throw std::runtime_error( "[error] failed to create preview of this size!" );
+            }
+
+            xs.resize( target.width );
+            for( int32_t x = 0; x < target.width; x++ ){
+                xs[x] = static_cast<int32_t>( static_cast<int64_t>( x ) * width / target.width );
+            }
+            ys.resize( target.height );
+            for( int32_t y = 0; y < target.height; y++ ){
+                ys[y] = static_cast<int32_t>( static_cast<int64_t>( y ) * height / target.height );
+            }
+        }
+    };
+
+    // Preview converter that converts each target row independently (rows are converted in parallel)
+    // Rows are run by cv::ParallelLoopBody, so no std::function of lambda is allocated every frame.
+    class row_preview_converter : public preview_converter
+    {
+    private:
+        // Loop Body of Rows
+        class row_body : public cv::ParallelLoopBody
+        {
+        private:
+            const row_preview_converter& converter;
+            const uint8_t* src;
+            cv::Mat& dst;
+
+        public:
+            // Constructor
+            row_body( const row_preview_converter& converter, const uint8_t* src, cv::Mat& dst )
+                : converter( converter ), src( src ), dst( dst )
+            {
+            }
+
+            // Convert Rows
+            void operator()( const cv::Range& range ) const override
+            {
+                for( int32_t y = range.start; y < range.end; y++ ){
+                    converter.convert_row( src, y, dst.ptr<uint8_t>( y ) );
+                }
+            }
+        };
+
+    public:
+        using preview_converter::preview_converter;
+
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            dst.create( target, CV_8UC3 );
+            cv::parallel_for_( cv::Range( 0, target.height ), row_body( *this, static_cast<const uint8_t*>( src ), dst ) );
+        }
+
+        // Convert target row y of frame into BGR
+        virtual void convert_row( const uint8_t* src, const int32_t y, uint8_t* bgr ) const = 0;
+    };
+
+    // Preview converter of packed YUV 4:2:2 (offsets of Y, U and V in macro pixel of 2 pixels)
+    template<int32_t y_offset, int32_t u_offset, int32_t v_offset>
+    class yuv422_preview_converter : public row_preview_converter
+    {
+    public:
+        using row_preview_converter::row_preview_converter;
+
+    protected:
+        void convert_row( const uint8_t* src, const int32_t y, uint8_t* bgr ) const override
+        {
+            const size_t stride = static_cast<size_t>( size.width ) * 2;
+            const uint8_t* row = src + ys[y] * stride;
+            for( int32_t x = 0; x < target.width; x++ ){
+                const uint8_t* pixels = row + ( xs[x] / 2 ) * 4;
+                color_kernel::yuv_to_bgr( pixels[y_offset + ( xs[x] % 2 ) * 2], pixels[u_offset], pixels[v_offset], bgr + x * 3 );
+            }
+        }
+    };
+
+    // Preview converter of semi-planar YUV 4:2:0 (offsets of U and V in interleaved chroma plane)
+    template<int32_t u_offset, int32_t v_offset>
+    class yuv420sp_preview_converter : public row_preview_converter
+    {
+    public:
+        using row_preview_converter::row_preview_converter;
+
+    protected:
+        void convert_row( const uint8_t* src, const int32_t y, uint8_t* bgr ) const override
+        {
+            const size_t stride = static_cast<size_t>( size.width );
+            const uint8_t* luma_row = src + ys[y] * stride;
+            const uint8_t* chroma_row = src + stride * size.height + ( ys[y] / 2 ) * stride;
+            for( int32_t x = 0; x < target.width; x++ ){
+                const uint8_t* uv = chroma_row + ( xs[x] / 2 ) * 2;
+                color_kernel::yuv_to_bgr( luma_row[xs[x]], uv[u_offset], uv[v_offset], bgr + x * 3 );
+            }
+        }
+    };
+
+    // Preview converter of packed RGB formats (RGB, BGR and BGRA)
+    template<int32_t channels, bool is_rgb>
+    class packed_preview_converter : public row_preview_converter
+    {
+    public:
+        using row_preview_converter::row_preview_converter;
+
+    protected:
+        void convert_row( const uint8_t* src, const int32_t y, uint8_t* bgr ) const override
+        {
+            const size_t stride = static_cast<size_t>( size.width ) * channels;
+            const uint8_t* row = src + ys[y] * stride;
+            for( int32_t x = 0; x < target.width; x++ ){
+                const uint8_t* pixel = row + xs[x] * channels;
+                bgr[x * 3 + 0] = pixel[is_rgb ? 2 : 0];
+                bgr[x * 3 + 1] = pixel[1];
+                bgr[x * 3 + 2] = pixel[is_rgb ? 0 : 2];
+            }
+        }
+    };
+
+    // Preview converter of MJPG
+    // Decoded at smallest size of DCT scaling (1/2, 1/4, 1/8) that is not smaller than target, then resized only if size does not match.
+    class mjpg_preview_converter : public preview_converter
+    {
+    private:
+        int32_t scale = 1;
+        mutable cv::Mat decoded;
+
+    public:
+        mjpg_preview_converter( const int32_t width, const int32_t height, const cv::Size& target )
+            : preview_converter( width, height, target )
+        {
+            for( const int32_t reduced : { 2, 4, 8 } ){
+                if( get_reduced_size( reduced ).width >= target.width && get_reduced_size( reduced ).height >= target.height ){
+                    scale = reduced;
+                }
+            }
+        }
+
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            if( get_reduced_size( scale ) == target ){
+                decode_mjpg( src, src_size, true, dst, scale );
+                return;
+            }
+
+            decode_mjpg( src, src_size, true, decoded, scale );
+            cv::resize( decoded, dst, target, 0.0, 0.0, cv::INTER_AREA );
+        }
+
+    private:
+        // Size Decoded by DCT Scaling
+        cv::Size get_reduced_size( const int32_t reduced ) const
+        {
+            return cv::Size( ( size.width + reduced - 1 ) / reduced, ( size.height + reduced - 1 ) / reduced );
+        }
+    };
+
+    // Preview converter of other formats (converted at full resolution, then resized, GRAY is kept 1 channel)
+    class resize_preview_converter : public preview_converter
+    {
+    private:
+        const std::unique_ptr<frame_converter> converter;
+        mutable cv::Mat converted;
+
+    public:
+        resize_preview_converter( const OBFormat format, const int32_t width, const int32_t height, const cv::Size& target )
+            : preview_converter( width, height, target ), converter( create_converter( OBFrameType::OB_FRAME_COLOR, format, width, height ) )
+        {
+        }
+
+    protected:
+        void convert_data( void* src, const uint32_t src_size, cv::Mat& dst ) const override
+        {
+            converter->convert( src, src_size, converted );
+            cv::resize( converted, dst, target, 0.0, 0.0, cv::INTER_NEAREST );
+        }
+    };
+
+    // Create preview converter of color format that converts to BGR of target size
+    std::unique_ptr<frame_converter> create_preview_converter( const OBFormat format, const int32_t width, const int32_t height, const cv::Size& target )
+    {
+        switch( format )
+        {
+            case OBFormat::OB_FORMAT_YUYV:
+            case OBFormat::OB_FORMAT_YUY2: // not supported by femto mega
+                return std::make_unique<yuv422_preview_converter<0, 1, 3>>( width, height, target );
+            case OBFormat::OB_FORMAT_UYVY: // not supported by femto mega
+                return std::make_unique<yuv422_preview_converter<1, 0, 2>>( width, height, target );
+            case OBFormat::OB_FORMAT_NV12:
+                return std::make_unique<yuv420sp_preview_converter<0, 1>>( width, height, target );
+            case OBFormat::OB_FORMAT_NV21: // not supported by femto mega
+                return std::make_unique<yuv420sp_preview_converter<1, 0>>( width, height, target );
+            case OBFormat::OB_FORMAT_MJPG:
+                return std::make_unique<mjpg_preview_converter>( width, height, target );
+            case OBFormat::OB_FORMAT_RGB:
+                return std::make_unique<packed_preview_converter<3, true>>( width, height, target );
+            case OBFormat::OB_FORMAT_BGR: // not supported by femto mega
+                return std::make_unique<packed_preview_converter<3, false>>( width, height, target );
+            case OBFormat::OB_FORMAT_BGRA:
+                return std::make_unique<packed_preview_converter<4, false>>( width, height, target );
+            case OBFormat::OB_FORMAT_I420: // not supported by femto mega
+            case OBFormat::OB_FORMAT_GRAY: // not supported by femto mega
+                return std::make_unique<resize_preview_converter>( format, width, height, target );
+            case OBFormat::OB_FORMAT_H264:
+            case OBFormat::OB_FORMAT_H265:
+            case OBFormat::OB_FORMAT_HEVC:
+                throw std::runtime_error( "[error] not implemented this format!" );
+            default:
+                throw std::runtime_error( "[error] failed to convert this format!" );
+        }
+    }
+
+    // Create preview converter of color format that converts to BGR of 1/scale size (e.g. 2 or 4)
+    std::unique_ptr<frame_converter> create_preview_converter( const OBFormat format, const int32_t width, const int32_t height, const int32_t scale )
+    {
+        if( scale <= 0 ){
+            throw std::runtime_error( "[error] failed to create preview of this scale!" );
+        }
+        return create_preview_converter( format, width, height, cv::Size( width / scale, height / scale ) );
+    }
+
+    // Create look-up table that maps depth (Y16) to 8-bit image for visualization
+    // Invalid depth (0) is mapped to black. If colormap (cv::ColormapTypes) is specified, table is BGR.
+    cv::Mat create_depth_lut( const double max_range, const int32_t colormap = -1 )
+    {
+        cv::Mat lut = cv::Mat( 1, std::numeric_limits<uint16_t>::max() + 1, CV_8UC1 );
+        uint8_t* table = lut.ptr<uint8_t>();
+        table[0] = 0;
+        for( int32_t i = 1; i < lut.cols; i++ ){
+            table[i] = cv::saturate_cast<uint8_t>( i * ( -255.0 / max_range ) + 255.0 );
+        }
+
+        if( colormap < 0 ){
+            return lut;
+        }
+
+        cv::Mat color_lut;
+        cv::applyColorMap( lut, color_lut, colormap );
+        color_lut.at<cv::Vec3b>( 0 ) = cv::Vec3b( 0, 0, 0 );
+        return color_lut;
+    }
+
+    // Look-up of depth rows (loop body is not allocated as std::function of lambda every frame)
+    template<typename T>
+    class depth_lut_body : public cv::ParallelLoopBody
+    {
+    private:
+        const cv::Mat& depth;
+        const T* table;
+        cv::Mat& dst;
+
+    public:
+        // Constructor
+        depth_lut_body( const cv::Mat& depth, const cv::Mat& lut, cv::Mat& dst )
+            : depth( depth ), table( lut.ptr<T>() ), dst( dst )
+        {
+        }
+
+        // Look-Up Rows
+        void operator()( const cv::Range& range ) const override
+        {
+            for( int32_t y = range.start; y < range.end; y++ ){
+                const uint16_t* src = depth.ptr<uint16_t>( y );
+                T* row = dst.ptr<T>( y );
+                for( int32_t x = 0; x < depth.cols; x++ ){
+                    row[x] = table[src[x]];
+                }
+            }
+        }
+    };
+
+    // Visualize depth (Y16) with look-up table into caller-owned cv::Mat
+    void visualize_depth( const cv::Mat& depth, const cv::Mat& lut, cv::Mat& dst )
+    {
+        assert( depth.type() == CV_16UC1 );
+        assert( lut.total() == std::numeric_limits<uint16_t>::max() + 1 );
+
+        dst.create( depth.size(), lut.type() );
+        if( lut.type() == CV_8UC1 ){
+            cv::parallel_for_( cv::Range( 0, depth.rows ), depth_lut_body<uint8_t>( depth, lut, dst ) );
+        }
+        else{
+            cv::parallel_for_( cv::Range( 0, depth.rows ), depth_lut_body<cv::Vec3b>( depth, lut, dst ) );
+        }
+    }
+}
+
+#endif // __UTIL__
\ No newline at end of file